@@ -3,15 +3,42 @@
 
 #include "inverters.h"
 #include "operators.h"
+#include "hsm.h"
+#include "event.h"
+
+/* ******************************** Task Periods *******************************  */
+// Multiples of SCH_TICK_US (1 ms). The stage timeouts (R2D, keep alive, buzzer) are
+// counted in FSM_PERIOD_MS ticks.
+#define FSM_CONTROL_PERIOD_MS  1
+#define FSM_SAFETY_PERIOD_MS   10
+#define FSM_PERIOD_MS          20
+#define FSM_HMI_PERIOD_MS      100
+
+/* ******************************** States *************************************  */
+/**
+ * @brief Vehicle FSM states, index of the state table in FSM.c
+ */
+typedef enum{
+    FSM_ST_ANY = 0,       // Superstate of all stages
+    FSM_ST_STAGE1,        // Initial checks
+    FSM_ST_INV_ACTIVE,    // Superstate of the stages where the inverters are addressed
+    FSM_ST_STAGE2,        // Ready to drive pre-check
+    FSM_ST_STAGE2HALF,    // Inverter activation
+    FSM_ST_STAGE3,        // Superstate of the driving modes
+    FSM_ST_DRIVE,         // Normal driving
+    FSM_ST_LC_ARMED,      // Launch control armed: brake held, zero torque
+    FSM_ST_LC_LAUNCH,     // Launch control ramp, up to the exit speed
+    FSM_NUM_STATES
+}FsmState_t;
 
-#define R2D_TIMEOUT 10
 /* **************************Functions Declarations *****************************  */
 void FSM_Init(void);
 void FSM();
-void FSM_Stage_1(void);
-void FSM_Stage_2(void);
-void FSM_Stage_2half(void);
-void FSM_Stage_3(void);
-void FSM_InAnyStage(void);
+void FSM_DispatchEvents(void);
+uint8_t FSM_InState(FsmState_t state);
+const hsm_t* FSM_GetHsm(void);
+void FSM_TaskControl(void);
+void FSM_TaskSafety(void);
+void FSM_TaskHmi(void);
 void FSM_Error_Handler(void);
 #endif
\ No newline at end of file
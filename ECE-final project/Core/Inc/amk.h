@@ -0,0 +1,66 @@
+#ifndef AMK_H
+#define AMK_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <stddef.h>
+
+// No HAL dependency: one sequencer per inverter, stepped by the inverter control
+// (Core/Src/inverters.c) from the safety task with the decoded AMK status bits.
+
+/* =============================== Defines ======================================= */
+
+// Control word bits (the AMK bits 8..11)
+#define bInverterOn (0x01 << 8)
+#define bDcOn (0x01 << 9)
+#define bEnable (0x01 << 10)
+#define bErrorReset (0x01 << 11)
+
+#define AMK_QUIT_DC_TIMEOUT  50   // DC bus on, no QuitDcOn [ticks]
+#define AMK_ON_TIMEOUT       50   // Enable and InverterOn set, no QuitInverterOn [ticks]
+#define AMK_RESET_TIMEOUT    20   // ErrorReset set, error still present [ticks]
+#define AMK_MAX_RETRIES      3    // Resets and restarts before the inverter is given up
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief AMK startup state enum
+ */
+typedef enum{
+    AMK_ST_OFF = 0,        // Control word 0, waiting for SystemReady
+    AMK_ST_DC_ON,          // DcOn requested, waiting for the DC bus and QuitDcOn
+    AMK_ST_ENABLE,         // Enable and InverterOn requested, waiting for QuitInverterOn
+    AMK_ST_READY,          // Inverter on, the setpoints are applied
+    AMK_ST_ERROR_RESET,    // ErrorReset requested, waiting for the error to clear
+    AMK_ST_FAULT,          // Retries used up, waiting for amk_Reset
+    AMK_NUM_STATES
+}AmkState_t;
+
+/**
+ * @brief AMK status input struct, the bits of the actual values 1 frame
+ */
+typedef struct{
+    uint8_t systemReady;
+    uint8_t error;
+    uint8_t dcOn;            // DC bus energized
+    uint8_t quitDcOn;
+    uint8_t inverterOn;
+    uint8_t quitInverterOn;
+}amk_input_t;
+
+/**
+ * @brief AMK sequencer struct, one per inverter
+ */
+typedef struct{
+    AmkState_t state;
+    uint16_t timer;          // Ticks in the state
+    uint8_t retries;         // Resets and restarts since the last AMK_ST_READY
+    uint16_t controlWord;    // To send, see bInverterOn..bErrorReset
+}amk_t;
+
+/* ========================== Function Declarations ============================ */
+void amk_Init(amk_t* amk);
+void amk_Reset(amk_t* amk);
+uint16_t amk_Step(amk_t* amk, const amk_input_t* in, uint8_t request);
+uint8_t amk_IsReady(const amk_t* amk);
+
+#endif // AMK_H
@@ -0,0 +1,60 @@
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+#include "torque_vectoring.h"
+
+// No HAL dependency, wheel geometry from torque_vectoring.h. Runs in the control task on
+// every tick and in the vehicle model on the host (Tools/vehicle_host.c), the traction
+// control and the torque vectoring take its speed.
+
+/* =============================== Defines ======================================= */
+#define EST_DT           0.001f   // Call period [s]
+#define EST_STATES       2        // Speed, acceleration
+#define EST_MAX_MEAS     3        // Wheel speed, torque acceleration, IMU
+#define EST_MASS         280.0f   // Vehicle with driver [kg]
+#define EST_DRAG         0.8f     // 0.5 rho Cd A [kg/m]
+#define EST_MIN_SPEED    1.0f     // Slip denominator floor [m/s]
+#define EST_AWAY_WEIGHT  100.0f   // Wheel variance per (m/s)^2 the wheel runs ahead of the estimate
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief State estimator gains struct
+ * @note  Runtime tunable (params_t), given on every call. The noises are standard
+ *        deviations, the filter squares them.
+ */
+typedef struct{
+    float32_t jerk;          // Process noise, change of the acceleration [m/s^3]
+    float32_t wheelNoise;    // Wheel speed measurement [m/s]
+    float32_t accelNoise;    // Acceleration from the motor torques [m/s^2]
+    float32_t imuNoise;      // IMU acceleration [m/s^2]
+    float32_t maxAccel;      // Max plausible acceleration [m/s^2], about mu * g
+}est_gains_t;
+
+/**
+ * @brief State estimator input struct
+ */
+typedef struct{
+    float32_t motorSpeed[TV_NUM_WHEELS];    // Motor speeds (inverter actual_speed) [rpm]
+    float32_t torque[TV_NUM_WHEELS];        // Motor torques commanded [Nm]
+    float32_t accel;                        // IMU longitudinal acceleration [m/s^2]
+    uint8_t   accelValid;                   // IMU present and fresh
+    uint8_t   braking;                      // Hydraulic brake pressed
+}est_input_t;
+
+/**
+ * @brief State estimator output struct
+ */
+typedef struct{
+    float32_t speed;                        // Longitudinal speed [m/s]
+    float32_t accel;                        // Longitudinal acceleration [m/s^2]
+    float32_t slip[TV_NUM_WHEELS];          // Slip ratio of each wheel
+    float32_t speedStd;                     // Standard deviation of the speed [m/s]
+}est_output_t;
+
+/* ========================== Function Declarations ============================ */
+void est_Init(void);
+void est_Process(const est_input_t* in, const est_gains_t* gains, est_output_t* out);
+
+#endif // ESTIMATOR_H
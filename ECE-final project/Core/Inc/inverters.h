@@ -1,29 +1,71 @@
 #ifndef INVERTERS_H
 #define INVERTERS_H
 #include "callbacks.h"
+#include "torque_vectoring.h"
+#include "traction_control.h"
+#include "launch_control.h"
+#include "regen.h"
+#include "pedal_map.h"
+#include "power_limit.h"
+#include "thermal.h"
+#include "estimator.h"
+#include "amk.h"
 
 /* =============================== Inverters Defines =============================== */
-#define bInverterOn 0x01
-#define bDcOn 0x01 << 1
-#define bEnable 0x01 << 2
-#define bErrorReset 0x01 << 3
+// 1: the AMK inverters are parameterised for torque control, bytes 2..3 of the setpoints
+// frame are the target torque. 0: speed control, bytes 2..3 are the target velocity and
+// inv_SetSetpoint drives the torque through the limits. Must match the inverter parameters:
+// the inverters are set up for speed control, a torque frame would make a negative (regen
+// or TV) torque a reverse speed setpoint. Switch to 1 only together with the change of the
+// inverter parameters to torque control.
+#ifndef INV_TORQUE_MODE
+#define INV_TORQUE_MODE 0
+#endif
 
 #define BE1_PIN GPIO_PIN_8
 #define BE1_GROUP GPIOB
 #define INV12_CAN Can1
 #define INV34_CAN Can1
-#define MAX_VELOCITY 1000
+#define INV_STANDSTILL_RPM 50 // Motor speed below which the vehicle stands still [rpm]
+#define INV_REGEN_GAS_MAX 5   // Gas below which the brake pedal asks for regen [%]
+#define INV_IMU_TIMEOUT 20    // Control ticks without an IMU frame before the estimator drops it
 
 
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Torque setpoint of one inverter, see inv_SetSetpoint
+ */
+typedef struct{
+    int16_t torque;      // Target torque, negative brakes [0.1% Mn]
+    int16_t posLimit;    // Positive torque limit [0.1% Mn]
+    int16_t negLimit;    // Negative torque limit, 0 or negative [0.1% Mn]
+}inv_setpoint_t;
+
+/**
+ * @brief Word of the setpoints frame
+ */
+typedef struct{
+    uint8_t byte;        // First byte in the frame, little endian
+    uint8_t offset;      // offsetof the field in inverter_setpoints_t
+}inv_word_t;
+
 /* ========================== Function Declarations =============================== */
 
+void inv_Init(void);
 void InvertersInitFC(void);
 void inv_CyclicTransmission(void);
-void inv_SetInvParameters_FC(int16_t posTorqueLimit, int16_t negTorqueLimit);
+void inv_SetInvParameters_FC(uint8_t inv, int16_t posTorqueLimit, int16_t negTorqueLimit);
 void inv_SetZeroTorque(int16_t posTorqueLimit, int16_t negTorqueLimit);
+void inv_SetSetpoint(uint8_t inv, const inv_setpoint_t* sp);
 void inv_DrivingRoutine();
 uint8_t inv_CheckInit();
 uint8_t inv_CheckHV();
+void inv_Sequence(uint8_t request);
+uint8_t inv_ReadyCount(void);
+uint8_t inv_Standstill(void);
+void inv_ThermalUpdate(void);
+void inv_Estimate(void);
 void inv_TurnOnBE1();
 void inv_set_ErrorReset();
 void inv_CheckInvertersError();
@@ -0,0 +1,51 @@
+#ifndef LAUNCH_CONTROL_H
+#define LAUNCH_CONTROL_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+#include "torque_vectoring.h"
+
+// No HAL dependency, wheel geometry from torque_vectoring.h. Started and stopped by the
+// launch states of the vehicle FSM, runs in the control task before the torque allocation
+// and in the vehicle model on the host (Tools/vehicle_host.c).
+
+/* =============================== Defines ======================================= */
+#define LC_DT            0.001f   // Control period [s]
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Launch control gains struct
+ * @note  Runtime tunable (params_t), given on every call.
+ */
+typedef struct{
+    float32_t torqueScale;   // Share of the peak driver torque allowed during the launch (0..1)
+    float32_t slipTarget;    // Slip target of the traction control during the launch
+    float32_t exitSpeed;     // Hand over to normal driving above this speed [m/s]
+}lc_gains_t;
+
+/**
+ * @brief Launch control input struct
+ */
+typedef struct{
+    float32_t motorSpeed[TV_NUM_WHEELS];    // Motor speeds (inverter actual_speed) [rpm]
+}lc_input_t;
+
+/**
+ * @brief Launch control output struct
+ */
+typedef struct{
+    float32_t torqueScale;                  // Share of the peak driver torque allowed (0..1)
+    float32_t slipTarget;                   // Slip target for the traction control
+    float32_t speed;                        // Slowest wheel [m/s]
+    float32_t time;                         // Since the launch [s]
+}lc_output_t;
+
+/* ========================== Function Declarations ============================ */
+void lc_Init(void);
+void lc_Start(void);
+void lc_Stop(void);
+uint8_t lc_IsActive(void);
+uint8_t lc_IsDone(void);
+void lc_Process(const lc_input_t* in, const lc_gains_t* gains, lc_output_t* out);
+
+#endif // LAUNCH_CONTROL_H
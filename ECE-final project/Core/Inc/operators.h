@@ -27,6 +27,10 @@
 #define BUZZER_2_FREQ 5300
 #define BUZZER_STOP_VAL 200
 
+/******Dashboard status frame (VCU_STATUS_ID) *******/
+#define DASH_STATUS_CAN Can1
+#define DASH_THERMAL_WARNING 0x01 // Status bit: a motor is derated below th_warning
+
 
 /* **************************Functions Declarations *****************************  */
 void opr_Stage_Leds(Stage_t stage);
@@ -38,4 +42,6 @@ void opr_KeepAliveCheck();
 void opr_ClearKLList() ;
 void opr_BrakeLight() ;
 void opr_Buzzer();
+void opr_BuzzerStop();
+void opr_DashboardStatus(void);
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef PEDAL_MAP_H
+#define PEDAL_MAP_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+#include "torque_vectoring.h"
+
+// No HAL dependency, wheel geometry from torque_vectoring.h. Runs in the control task
+// before the torque allocation.
+
+/* =============================== Defines ======================================= */
+#define PM_PEDAL_POINTS   11       // Map columns, 0..100 % gas
+#define PM_PEDAL_STEP     10.0f    // [%]
+#define PM_SPEED_POINTS   7        // Map rows, 0..30 m/s
+#define PM_SPEED_STEP     5.0f     // [m/s]
+#define PM_SWITCH_PEDAL   5.0f     // A new mode is taken over below this gas [%]
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Driver mode enum, index of the maps in flash
+ */
+typedef enum{
+    PM_LINEAR = 0,       // Torque proportional to the gas, the former straight line
+    PM_RAIN,             // Progressive and capped, softer at low speed
+    PM_ENDURANCE,        // Progressive, capped, torque falls with speed (about constant power)
+    PM_ACCELERATION,     // Full torque from 80 % gas
+    PM_NUM_MODES
+}PmMode_t;
+
+/* ========================== Function Declarations ============================ */
+void pm_Init(void);
+float32_t pm_Process(PmMode_t mode, float32_t gas, const float32_t motorSpeed[TV_NUM_WHEELS]);
+PmMode_t pm_GetMode(void);
+
+#endif // PEDAL_MAP_H
@@ -0,0 +1,46 @@
+#ifndef POWER_LIMIT_H
+#define POWER_LIMIT_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+#include "torque_vectoring.h"
+
+// No HAL dependency, wheel count from torque_vectoring.h. Runs in the control task after
+// the traction control and in the vehicle model on the host (Tools/vehicle_host.c).
+
+/* =============================== Defines ======================================= */
+#define PL_DT            0.001f   // Control period [s]
+#define PL_EFFICIENCY    0.92f    // Motor and inverter efficiency for the power request, as AMK_EFFICIENCY
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Power limiter gains struct
+ * @note  Runtime tunable (params_t), given on every call.
+ */
+typedef struct{
+    float32_t limit;         // Max electrical power of the four inverters [W]
+    float32_t margin;        // Kept below the limit, covers the efficiency error [W]
+}pl_gains_t;
+
+/**
+ * @brief Power limiter input struct
+ */
+typedef struct{
+    float32_t torque[TV_NUM_WHEELS];        // Requested motor torques [Nm]
+    float32_t motorSpeed[TV_NUM_WHEELS];    // Motor speeds (inverter actual_speed) [rpm]
+}pl_input_t;
+
+/**
+ * @brief Power limiter output struct
+ */
+typedef struct{
+    float32_t torque[TV_NUM_WHEELS];        // Motor torques after the limit [Nm]
+    float32_t request;                      // Electrical power of the requested torques [W]
+    float32_t allowed;                      // Power the request was scaled to [W]
+    float32_t scale;                        // Applied to the driving torques (0..1)
+}pl_output_t;
+
+/* ========================== Function Declarations ============================ */
+void pl_Process(const pl_input_t* in, const pl_gains_t* gains, pl_output_t* out);
+
+#endif // POWER_LIMIT_H
@@ -0,0 +1,58 @@
+#ifndef REGEN_H
+#define REGEN_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+#include "torque_vectoring.h"
+
+// No HAL dependency, wheel geometry from torque_vectoring.h. Runs in the control task while
+// the brake pedal is pressed and in the vehicle model on the host (Tools/vehicle_host.c).
+
+/* =============================== Defines ======================================= */
+#define RG_DT            0.001f   // Control period [s]
+#define RG_MIN_SPEED     1.0f     // No regen below this speed, the hydraulic brake stops the car [m/s]
+#define RG_FADE_SPEED    4.0f     // Full regen above this speed [m/s]
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Regenerative braking gains struct
+ * @note  Runtime tunable (params_t), given on every call. Each limit is a linear taper
+ *        from its start value (full regen) to its max value (no regen).
+ */
+typedef struct{
+    float32_t maxTorque;     // Mean regen torque of the motors at full pedal [Nm]
+    float32_t frontSplit;    // Share of the regen on the front axle, the hydraulic brake balance
+    float32_t pedalStart;    // Brake pedal where the regen starts [%]
+    float32_t pedalFull;     // Brake pedal of full regen [%]
+    float32_t voltStart;     // Pack voltage where the regen starts to derate [V]
+    float32_t voltMax;       // No regen at or above this pack voltage [V]
+    float32_t tempStart;     // Inverter temperature where the regen starts to derate [degC]
+    float32_t tempMax;       // No regen at or above this inverter temperature [degC]
+    float32_t rate;          // Max change of the regen torque of a motor [Nm/s]
+}rg_gains_t;
+
+/**
+ * @brief Regenerative braking input struct
+ */
+typedef struct{
+    float32_t brake;                        // Brake pedal, 0 when the driver does not brake [%]
+    float32_t packVoltage;                  // [V], 0 if not measured (no regen)
+    float32_t temperature[TV_NUM_WHEELS];   // Inverter of each wheel [degC]
+    float32_t motorSpeed[TV_NUM_WHEELS];    // Motor speeds (inverter actual_speed) [rpm]
+}rg_input_t;
+
+/**
+ * @brief Regenerative braking output struct
+ */
+typedef struct{
+    float32_t torque[TV_NUM_WHEELS];        // Regen torque of each motor, 0 or negative [Nm]
+    float32_t request;                      // Total regen from the pedal before the limits [Nm]
+    float32_t speed;                        // Vehicle speed from the wheels [m/s]
+}rg_output_t;
+
+/* ========================== Function Declarations ============================ */
+void rg_Init(void);
+void rg_Reset(void);
+void rg_Process(const rg_input_t* in, const rg_gains_t* gains, rg_output_t* out);
+
+#endif // REGEN_H
@@ -0,0 +1,60 @@
+#ifndef THERMAL_H
+#define THERMAL_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+#include "torque_vectoring.h"
+
+// No HAL dependency, wheel count from torque_vectoring.h. Runs in the safety task, the
+// factors limit the torque allocation of the control task.
+
+/* =============================== Defines ======================================= */
+#define TH_DT            0.01f    // Call period [s]
+#define TH_RATE_TAU      2.0f     // Filter of the temperature rates [s], the AV2 frames are slow
+#define TH_CURVE_POINTS  9        // Points of the derating curves
+#define TH_MAX_STEP      5.0f     // A larger change between two calls is a lost or stale frame [degC]
+#define TH_MAX_REJECTS   50       // Rejected calls in a row before the new value is taken (0.5 s)
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Temperature source enum
+ */
+typedef enum{
+    TH_MOTOR = 0,        // Motor winding
+    TH_PLATE,            // Inverter cold plate
+    TH_IGBT,             // Inverter IGBTs
+    TH_NUM_SOURCES
+}ThSource_t;
+
+/**
+ * @brief Thermal manager gains struct
+ * @note  Runtime tunable (params_t), given on every call.
+ */
+typedef struct{
+    float32_t horizon;       // Temperature prediction [s]
+    float32_t recovery;      // Max rise of a factor [1/s]
+    float32_t warning;       // Warning below this factor
+}th_gains_t;
+
+/**
+ * @brief Thermal manager input struct
+ */
+typedef struct{
+    float32_t temperature[TV_NUM_WHEELS][TH_NUM_SOURCES];   // [degC]
+    uint8_t   valid[TV_NUM_WHEELS];                         // The temperatures of the wheel were received
+}th_input_t;
+
+/**
+ * @brief Thermal manager output struct
+ */
+typedef struct{
+    float32_t factor[TV_NUM_WHEELS];                        // Torque limit factor (0..1)
+    float32_t predicted[TV_NUM_WHEELS][TH_NUM_SOURCES];     // At the horizon [degC]
+    uint8_t   warning;                                      // A factor is below gains->warning
+}th_output_t;
+
+/* ========================== Function Declarations ============================ */
+void th_Init(void);
+void th_Process(const th_input_t* in, const th_gains_t* gains, th_output_t* out);
+
+#endif // THERMAL_H
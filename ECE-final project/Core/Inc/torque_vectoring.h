@@ -0,0 +1,82 @@
+#ifndef TORQUE_VECTORING_H
+#define TORQUE_VECTORING_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+
+// No HAL dependency: runs in the control task on the target and in the vehicle model on
+// the host (Tools/vehicle_host.c).
+
+/* =============================== Defines ======================================= */
+#define TV_NUM_WHEELS  4
+
+// Wheel of each inverter (index in vcu_node->inverters and INV_Setpoints_msgs)
+#define TV_FL  0
+#define TV_FR  1
+#define TV_RL  2
+#define TV_RR  3
+
+// Vehicle defaults, used when tv_Init gets NULL
+#define TV_WHEEL_RADIUS      0.228f   // [m]
+#define TV_GEAR_RATIO        13.1f    // Motor turns per wheel turn
+#define TV_TRACK_WIDTH       1.20f    // [m]
+#define TV_WHEELBASE         1.53f    // [m]
+#define TV_UNDERSTEER_GRAD   0.0f     // [rad s^2/m], 0 for the neutral steer reference
+#define TV_MAX_STEER_ANGLE   0.42f    // Road wheel angle at full steering input [rad]
+#define TV_MOTOR_MN          9.8f     // AMK nominal torque Mn [Nm], unit of the setpoints
+#define TV_MAX_MOTOR_TORQUE  21.0f    // Peak motor torque [Nm]
+#define TV_MIN_SPEED         2.0f     // No yaw moment below this speed [m/s]
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Vehicle geometry struct
+ */
+typedef struct{
+    float32_t wheelRadius;
+    float32_t gearRatio;
+    float32_t trackWidth;
+    float32_t wheelbase;
+    float32_t understeerGrad;
+    float32_t maxSteerAngle;
+    float32_t maxMotorTorque;
+    float32_t minSpeed;
+}tv_vehicle_t;
+
+/**
+ * @brief Torque vectoring gains struct
+ * @note  Runtime tunable (params_t), given on every call.
+ */
+typedef struct{
+    float32_t frontSplit;    // Share of the driver torque on the front axle (0..1)
+    float32_t yawFF;         // Yaw moment per rad/s of reference yaw rate [Nm s]
+    float32_t yawKp;         // Yaw moment per rad/s of yaw rate error [Nm s]
+}tv_gains_t;
+
+/**
+ * @brief Torque vectoring input struct
+ */
+typedef struct{
+    float32_t driverTorque;                 // Total motor torque request, sum of the 4 motors [Nm]
+    float32_t steering;                     // Steering input, -1 (full right) .. 1 (full left)
+    float32_t motorSpeed[TV_NUM_WHEELS];    // Motor speeds (inverter actual_speed) [rpm]
+    float32_t torqueLimit[TV_NUM_WHEELS];   // Peak torque of each motor, thermal derating [Nm]
+    float32_t speed;                        // Vehicle speed of the state estimator [m/s]
+    uint8_t   speedValid;                   // 1: speed is used, 0: the mean of the wheels
+}tv_input_t;
+
+/**
+ * @brief Torque vectoring output struct
+ */
+typedef struct{
+    float32_t torque[TV_NUM_WHEELS];        // Motor torque setpoints [Nm]
+    float32_t speed;                        // Vehicle speed from the wheels [m/s]
+    float32_t yawRateRef;                   // [rad/s], positive to the left
+    float32_t yawRate;                      // From the wheel speed difference [rad/s]
+    float32_t yawMoment;                    // Requested at the wheels [Nm]
+}tv_output_t;
+
+/* ========================== Function Declarations ============================ */
+void tv_Init(const tv_vehicle_t* vehicle);
+void tv_Process(const tv_input_t* in, const tv_gains_t* gains, tv_output_t* out);
+
+#endif // TORQUE_VECTORING_H
@@ -0,0 +1,53 @@
+#ifndef TRACTION_CONTROL_H
+#define TRACTION_CONTROL_H
+/* =============================== Includes ======================================= */
+#include "arm_math.h"
+#include "torque_vectoring.h"
+
+// No HAL dependency, wheel geometry from torque_vectoring.h. Runs in the control task
+// after the torque allocation and in the vehicle model on the host (Tools/vehicle_host.c).
+
+/* =============================== Defines ======================================= */
+#define TC_DT             0.001f   // Control period [s]
+#define TC_MIN_SPEED      1.0f     // Slip denominator floor [m/s], slip is meaningless at standstill
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Traction control gains struct
+ * @note  Runtime tunable (params_t), given on every call. The PID acts on the slip above
+ *        the target and outputs the torque cut of the wheel.
+ */
+typedef struct{
+    float32_t slipTarget;    // Slip ratio allowed before cutting torque
+    float32_t kp;            // [Nm per unit slip]
+    float32_t ki;            // [Nm per unit slip and s]
+    float32_t kd;            // [Nm s per unit slip]
+    float32_t accelLimit;    // Max plausible vehicle acceleration [m/s^2], about mu * g
+}tc_gains_t;
+
+/**
+ * @brief Traction control input struct
+ */
+typedef struct{
+    float32_t torque[TV_NUM_WHEELS];        // Requested motor torques [Nm]
+    float32_t motorSpeed[TV_NUM_WHEELS];    // Motor speeds (inverter actual_speed) [rpm]
+    float32_t speed;                        // Vehicle speed of the state estimator [m/s]
+    uint8_t   speedValid;                   // 1: speed is the reference, 0: from the wheels
+}tc_input_t;
+
+/**
+ * @brief Traction control output struct
+ */
+typedef struct{
+    float32_t torque[TV_NUM_WHEELS];        // Motor torques after the cut [Nm]
+    float32_t slip[TV_NUM_WHEELS];          // Slip ratio of each wheel
+    float32_t speed;                        // Vehicle speed reference [m/s]
+}tc_output_t;
+
+/* ========================== Function Declarations ============================ */
+void tc_Init(void);
+void tc_Reset(void);
+void tc_Process(const tc_input_t* in, const tc_gains_t* gains, tc_output_t* out);
+
+#endif // TRACTION_CONTROL_H
@@ -5,180 +5,500 @@
 /* =============================== Global Variables =============================== */
 
 static database_t* pMainDB = NULL;
-static Stage_t* FSM_Stage = NULL; // Initial stage set to Stage1
+static Stage_t* FSM_Stage = NULL; // Mirrors the active leaf state for the LEDs and the CAN status
 uint8_t Sensors_Ok = 0; // Variable to check if sensors are OK
 uint8_t Communication_Ok = 0; // Variable to check if communication is OK
 uint8_t* BuzzerCounter =NULL;
-static uint8_t *R2D_Pressed = 0; // Variable to check if R2D is pressed
-static uint8_t *R2D_counter = 0;
+static uint8_t *R2D_Pressed = NULL; // Variable to check if R2D is pressed
+static uint16_t R2D_Counter = 0; // FSM ticks since R2D was pressed without brake or HV
 uint8_t Brake_Pedal_Pressed = 0; // Variable to check if brake pedal is pressed
 uint8_t HV_DETECTED = 0; // Variable to check if High Voltage is detected
 uint8_t Inverters_OK = 0 ; // Variable to check if Inverters are well initialized
+static hsm_t VehicleFsm;
+
+/* ========================== State Actions ============================ */
+
+static void FSM_AnyStageRun(void);
+static void FSM_Stage1Entry(void);
+static void FSM_Stage2Entry(void);
+static void FSM_Stage2Run(void);
+static void FSM_Stage2halfEntry(void);
+static void FSM_Stage2halfRun(void);
+static void FSM_Stage3Entry(void);
+static void FSM_Stage3Run(void);
+static void FSM_Stage3Exit(void);
+static void FSM_LaunchArmedEntry(void);
+static void FSM_LaunchEntry(void);
+static void FSM_LaunchExit(void);
+static uint8_t FSM_GuardStartupOk(void);
+static uint8_t FSM_GuardR2DAccepted(void);
+static uint8_t FSM_GuardInvertersReady(void);
+static uint8_t FSM_GuardLaunchArm(void);
+static uint8_t FSM_GuardLaunchGas(void);
+static uint8_t FSM_GuardLaunchOver(void);
+static uint8_t FSM_GuardInverterLost(void);
+static void FSM_HvLost(void);
+static void FSM_InvLost(void);
+static void FSM_ThermalWarning(void);
+static void FSM_Trace(uint8_t from, uint8_t to);
+
+/**
+ * @brief Vehicle state table
+ * @note  Indexed by FsmState_t, see "FSM States.pdf". FSM_ST_INV_ACTIVE groups the stages
+ *        where the inverters are addressed, FSM_ST_STAGE3 the driving modes: normal driving
+ *        and the two launch control states.
+ */
+static const hsm_state_t FSM_States[FSM_NUM_STATES] = {
+    [FSM_ST_ANY]        = {"any",        HSM_NO_STATE,      NULL,                 FSM_AnyStageRun,   NULL},
+    [FSM_ST_STAGE1]     = {"stage1",     FSM_ST_ANY,        FSM_Stage1Entry,      NULL,              NULL},
+    [FSM_ST_INV_ACTIVE] = {"inv_active", FSM_ST_ANY,        NULL,                 NULL,              NULL},
+    [FSM_ST_STAGE2]     = {"stage2",     FSM_ST_INV_ACTIVE, FSM_Stage2Entry,      FSM_Stage2Run,     NULL},
+    [FSM_ST_STAGE2HALF] = {"stage2half", FSM_ST_INV_ACTIVE, FSM_Stage2halfEntry,  FSM_Stage2halfRun, NULL},
+    [FSM_ST_STAGE3]     = {"stage3",     FSM_ST_INV_ACTIVE, FSM_Stage3Entry,      FSM_Stage3Run,     FSM_Stage3Exit},
+    [FSM_ST_DRIVE]      = {"drive",      FSM_ST_STAGE3,     NULL,                 NULL,              NULL},
+    [FSM_ST_LC_ARMED]   = {"lc_armed",   FSM_ST_STAGE3,     FSM_LaunchArmedEntry, NULL,              NULL},
+    [FSM_ST_LC_LAUNCH]  = {"lc_launch",  FSM_ST_STAGE3,     FSM_LaunchEntry,      NULL,              FSM_LaunchExit},
+};
+
+/**
+ * @brief Vehicle transition table
+ * @note  The event transitions are taken by FSM_DispatchEvents right after the decoders
+ *        posted them, the HSM_EV_TICK ones are only checked on the FSM_PERIOD_MS tick:
+ *        the Stage 1 checks, the inverter loss, the end of the R2D window and the end of
+ *        the launch. The error transitions back to Stage 1 are forced by FSM_Error_Handler, which also
+ *        catches a high voltage loss whose EV_HV_LOST was missed. An inverter that leaves
+ *        AMK_ST_READY in Stage 3 takes the vehicle back to Stage 2 with zero torque, the
+ *        driver has to give R2D again once its sequencer switched it back on (the tick
+ *        transition catches a missed EV_INV_LOST). Stage 2.5 only goes on to DRIVE when
+ *        all sequencers are ready, EV_INV_READY comes from inv_Sequence. In Stage 3 an
+ *        R2D press with the brake held at standstill arms the launch control, releasing the
+ *        brake launches with full gas and cancels without, a second R2D press cancels too.
+ *        EV_THERMAL_WARNING is an internal transition of every state, it sends the
+ *        dashboard status at once.
+ */
+static const hsm_transition_t FSM_Transitions[] = {
+    {FSM_ST_STAGE3,     FSM_ST_STAGE1,     EV_HV_LOST,         NULL,                     FSM_HvLost},
+    {FSM_ST_STAGE3,     FSM_ST_STAGE2,     EV_INV_LOST,        NULL,                     FSM_InvLost},
+    {FSM_ST_STAGE3,     FSM_ST_STAGE2,     HSM_EV_TICK,        FSM_GuardInverterLost,    FSM_InvLost},
+    {FSM_ST_STAGE1,     FSM_ST_STAGE2,     HSM_EV_TICK,        FSM_GuardStartupOk,       NULL},
+    {FSM_ST_STAGE2,     FSM_ST_STAGE2HALF, EV_R2D_PRESSED,     FSM_GuardR2DAccepted,     NULL},
+    {FSM_ST_STAGE2,     FSM_ST_STAGE2HALF, HSM_EV_TICK,        FSM_GuardR2DAccepted,     NULL},
+    {FSM_ST_STAGE2HALF, FSM_ST_DRIVE,      EV_INV_READY,       FSM_GuardInvertersReady,  NULL},
+    {FSM_ST_DRIVE,      FSM_ST_LC_ARMED,   EV_R2D_PRESSED,     FSM_GuardLaunchArm,       NULL},
+    {FSM_ST_LC_ARMED,   FSM_ST_DRIVE,      EV_R2D_PRESSED,     NULL,                     NULL},
+    {FSM_ST_LC_ARMED,   FSM_ST_LC_LAUNCH,  EV_BRAKE_RELEASED,  FSM_GuardLaunchGas,       NULL},
+    {FSM_ST_LC_ARMED,   FSM_ST_DRIVE,      EV_BRAKE_RELEASED,  NULL,                     NULL},
+    {FSM_ST_LC_LAUNCH,  FSM_ST_DRIVE,      HSM_EV_TICK,        FSM_GuardLaunchOver,      NULL},
+    {FSM_ST_ANY,        HSM_NO_STATE,      EV_THERMAL_WARNING, NULL,                     FSM_ThermalWarning},
+};
+
+/**
+ * @brief Scheduler task table
+ * @note  Tasks due on the same tick run in this order, the offsets keep the slow tasks
+ *        off the ticks of each other.
+ */
+static const sch_task_t FSM_Tasks[] = {
+    {"control", FSM_TaskControl, FSM_CONTROL_PERIOD_MS, 0},
+    {"safety",  FSM_TaskSafety,  FSM_SAFETY_PERIOD_MS,  1},
+    {"fsm",     FSM,             FSM_PERIOD_MS,         2},
+    {"hmi",     FSM_TaskHmi,     FSM_HMI_PERIOD_MS,     3},
+};
 
 /* ========================== Function Definitions ============================ */
 
 /**
  * @brief  Initializes the Finite State Machine (FSM).
  * @note   This function initializes the FSM by getting a pointer to the main
- *         database, setting the initial stage to Stage1, and initializing
- *         the operators module and buzzer counter.
+ *         database, initializing the operators module and buzzer counter, entering
+ *         Stage 1 and registering the tasks.
  */
 void FSM_Init(void)
 {
     pMainDB = db_GetDBPointer();
     FSM_Stage = &pMainDB->vcu_node->fsm_stage;
     opr_Init();
-    (*FSM_Stage) = Stage1; // Set initial stage to Stage1
+    inv_Init();
     BuzzerCounter =  &pMainDB->vcu_node->counters.buzzer_counter;
+    R2D_Pressed = &pMainDB->dashboard_node->R2D;
+    ev_Init();
+    VehicleFsm.trace = FSM_Trace;
+    hsm_Init(&VehicleFsm, FSM_States, FSM_NUM_STATES,
+             FSM_Transitions, sizeof(FSM_Transitions) / sizeof(FSM_Transitions[0]),
+             FSM_ST_STAGE1, HAL_GetTick);
+    sch_Init(FSM_Tasks, sizeof(FSM_Tasks) / sizeof(FSM_Tasks[0]));
 }
 
 
 /**
- * @brief  Executes the current stage of the Finite State Machine.
- * @note   This function acts as a router, calling the appropriate function
- *         based on the current value of the FSM_Stage variable.
+ * @brief  Runs one step of the vehicle state machine.
+ * @note   Runs as the FSM_PERIOD_MS task, the stage timeouts are counted in its ticks.
  */
 void FSM()
 {
-    switch(*FSM_Stage) {
-        case Stage1:
-            FSM_Stage_1();
-            break;
-        case Stage2:
-            FSM_Stage_2();
-            break;
-        case Stage2half:
-            FSM_Stage_2half();
-            break;
-        case Stage3:
-            FSM_Stage_3();
-            break;
-        default:
-            break;
-    }
+    PROF_BEGIN(PRF_TASK_FSM);
+    hsm_Run(&VehicleFsm);
+    PROF_END(PRF_TASK_FSM);
 }
 
 /**
- * @brief  Handles the logic for Stage 1: Initial Checks.
- * @note   In this stage, the system checks for sensor calibration and communication
- *         status. If both are nominal, it transitions to Stage 2. It also performs
- *         checks common to all stages.
+ * @brief  Dispatches the pending events to the vehicle state machine.
+ * @note   Called by FSM_TaskControl right after the received messages were decoded, so a
+ *         transition follows its CAN frame within the same control period.
  */
-void FSM_Stage_1()
+void FSM_DispatchEvents(void)
 {
-    FSM_InAnyStage();
-    opr_Stage_Leds(Stage1); // Set the LED for Stage 1
-    printf("Stage 1: Initializing\r\n");
-    Sensors_Ok = opr_SensorsCheck(); // Check if sensors are calibrated  
-    Communication_Ok = (opr_CommunicationCheck()>=100) ? 1:0; // Check if communication is OK 
-    
+    Event_t event;
 
-    if(Sensors_Ok && Communication_Ok) {
-        (*FSM_Stage) = Stage2; // Move to Stage 2 if sensors and communication are OK
-        printf("Stage 2: Sensors and Communication OK\r\n");
+    while(ev_Get(&event))
+    {
+        (void)hsm_Dispatch(&VehicleFsm, (uint8_t)event);
     }
 }
 
 /**
- * @brief  Handles the logic for Stage 2: Ready to Drive Pre-check.
- * @note   This stage waits for the driver to press the "Ready to Drive" (R2D)
- *         button while the brake pedal is pressed and high voltage is present.
- *         Upon meeting these conditions, it transitions to Stage 2.5.
+ * @brief  Checks if a state of the vehicle FSM is active.
+ * @param  state Leaf state or superstate
+ * @retval 1 if active, 0 otherwise.
+ */
+uint8_t FSM_InState(FsmState_t state)
+{
+    return hsm_InState(&VehicleFsm, (uint8_t)state);
+}
+
+/**
+ * @brief  Gets the vehicle state machine, for the transition history.
+ */
+const hsm_t* FSM_GetHsm(void)
+{
+    return &VehicleFsm;
+}
+
+/**
+ * @brief  Logs a transition of the vehicle FSM.
+ * @note   The logger has no %s, the ids are FsmState_t.
+ */
+static void FSM_Trace(uint8_t from, uint8_t to)
+{
+    LOG("FSM transition %u -> %u", from, to);
+}
+
+/**
+ * @brief  Do action common to all stages: node keep alive timeouts.
+ */
+static void FSM_AnyStageRun(void)
+{
+    opr_KeepAliveCheck();
+}
+
+/**
+ * @brief  Stage 1 entry: Initial Checks.
+ */
+static void FSM_Stage1Entry(void)
+{
+    (*FSM_Stage) = Stage1;
+    opr_Stage_Leds(Stage1);
+    LOG("Stage 1: Initializing");
+}
+
+/**
+ * @brief  Stage 1 guard: sensors calibrated and all nodes communicating.
+ */
+static uint8_t FSM_GuardStartupOk(void)
+{
+    Sensors_Ok = opr_SensorsCheck(); // Check if sensors are calibrated
+    Communication_Ok = (opr_CommunicationCheck()>=100) ? 1:0; // Check if communication is OK
+    return (Sensors_Ok && Communication_Ok);
+}
+
+/**
+ * @brief  Stage 2 entry: Ready to Drive Pre-check.
+ * @note   Zeroes the inverter setpoints and drops any R2D press from before the stage.
+ *         The inverters are switched on by their sequencers from this stage on. Also
+ *         entered from Stage 3 when an inverter drops out, no torque until the next R2D.
  */
-void FSM_Stage_2()
+static void FSM_Stage2Entry(void)
 {
-    FSM_InAnyStage();
+    (*FSM_Stage) = Stage2;
     opr_Stage_Leds(Stage2);
-    InvertersInitFC();
-    inv_CyclicTransmission();
-    R2D_Pressed = &pMainDB->dashboard_node->R2D;
+    LOG("Stage 2: Sensors and Communication OK");
+    inv_SetZeroTorque(0, 0);
+    (*R2D_Pressed) = 0;
+    R2D_Counter = 0;
+}
+
+/**
+ * @brief  Stage 2 do: times out the R2D press.
+ * @note   The R2D press is accepted at once (EV_R2D_PRESSED) or within params.r2d_timeout
+ *         FSM ticks while the brake pedal is pressed and high voltage is present.
+ */
+static void FSM_Stage2Run(void)
+{
+    if((*R2D_Pressed) && !FSM_GuardR2DAccepted())
+    {
+        R2D_Counter++;
+    }
+    if(R2D_Counter >= pMainDB->vcu_node->params.r2d_timeout)
+    {
+        R2D_Counter = 0;
+        (*R2D_Pressed) = 0;
+    }
+}
+
+/**
+ * @brief  Stage 2 guard: R2D pressed with the brake pedal pressed and high voltage present.
+ */
+static uint8_t FSM_GuardR2DAccepted(void)
+{
+    if(!(*R2D_Pressed)) return 0;
     Brake_Pedal_Pressed = (pMainDB->pedal_node->BIOPS > BRAKE_PEDAL_THRESHOLD) ? 1 : 0; // Check if brake pedal is pressed
     HV_DETECTED = inv_CheckHV();
-    
-    if((*R2D_Pressed) && (*R2D_counter) < R2D_TIMEOUT){
-        if(Brake_Pedal_Pressed && HV_DETECTED) {
-            *FSM_Stage = Stage2half;
-            *R2D_Pressed = 0;
-            *R2D_counter = 0;
-            return;
-        } else {
-            (*R2D_counter)++;
-        }
-    }
+    return (Brake_Pedal_Pressed && HV_DETECTED);
+}
 
-    if(*R2D_counter >= R2D_TIMEOUT){
-        *R2D_counter = 0;
-        *R2D_Pressed = 0;
+/**
+ * @brief  Stage 2.5 entry: Inverter Activation.
+ * @note   inv_Sequence only posts EV_INV_READY when the last inverter becomes ready, if
+ *         they already are it is posted here.
+ */
+static void FSM_Stage2halfEntry(void)
+{
+    (*FSM_Stage) = Stage2half;
+    opr_Stage_Leds(Stage2half);
+    (*R2D_Pressed) = 0;
+    if(FSM_GuardInvertersReady())
+    {
+        (void)ev_Post(EV_INV_READY);
     }
 }
 
 /**
- * @brief  Handles the logic for Stage 2.5: Inverter Activation.
- * @note   This intermediate stage is responsible for turning on the inverters
- *         and verifying that they have initialized correctly. Once confirmed,
- *         it transitions to Stage 3.
+ * @brief  Stage 2.5 do: turns on BE1 once all inverters are on.
+ * @note   The setpoints are rebuilt here because the torque limits are only set for the
+ *         inverters that finished their handshake.
  */
-void FSM_Stage_2half()
+static void FSM_Stage2halfRun(void)
 {
-    FSM_InAnyStage();
-    opr_Stage_Leds(Stage2half); // Set the LED for Stage 2.5
     InvertersInitFC();
-    inv_CyclicTransmission();
     inv_TurnOnBE1(); // Turn on BE1
+}
+
+/**
+ * @brief  All inverters initialized.
+ */
+static uint8_t FSM_GuardInvertersReady(void)
+{
     Inverters_OK = inv_CheckInit();
-    
-    if(Inverters_OK)
-    {
-        (*FSM_Stage) = Stage3; // Move to Stage 3 if Inverters are well initialized
-        printf("Stage 3: Inverters Initialized, Ready to Drive\r\n");
-        Inverters_OK = 0;
+    return Inverters_OK;
+}
 
-    }
+/**
+ * @brief  Stage 3 entry: Driving.
+ * @note   The driving routine runs in FSM_TaskControl. High voltage loss is taken at once
+ *         on EV_HV_LOST and checked as a level in FSM_TaskSafety, here only the buzzer is
+ *         started.
+ */
+static void FSM_Stage3Entry(void)
+{
+    (*FSM_Stage) = Stage3;
+    opr_Stage_Leds(Stage3);
+    LOG("Stage 3: Inverters Initialized, Ready to Drive");
+    (*BuzzerCounter) = 0;
+}
 
-    (*R2D_Pressed) = 0;
+/**
+ * @brief  Stage 3 do: times out the buzzer.
+ * @note   The launch control transitions take EV_R2D_PRESSED, posted once per press by the
+ *         dashboard decoder.
+ */
+static void FSM_Stage3Run(void)
+{
+    opr_Buzzer();
 }
 
 /**
- * @brief  Handles the logic for Stage 3: Driving.
- * @note   This is the main driving stage. It executes the driving routine,
- *         continuously checks for high voltage presence, sends cyclic CAN messages
- *         to the inverters, and activates the buzzer.
+ * @brief  Launch control guard: enabled, brake pedal pressed and vehicle at standstill.
  */
-void FSM_Stage_3()
+static uint8_t FSM_GuardLaunchArm(void)
 {
-   FSM_InAnyStage();
-   opr_Stage_Leds(Stage3);
-   inv_DrivingRoutine();
-   if(!(inv_CheckHV()))
-    {
-        pMainDB->vcu_node->error_group.system_error = HV_ERROR;
-    }
-   inv_CyclicTransmission();
-   opr_Buzzer();
+    Brake_Pedal_Pressed = (pMainDB->pedal_node->BIOPS > BRAKE_PEDAL_THRESHOLD) ? 1 : 0;
+    return (pMainDB->vcu_node->params.lc_enable && Brake_Pedal_Pressed && inv_Standstill());
 }
 
+/**
+ * @brief  Launch control armed entry.
+ * @note   FSM_TaskControl holds zero torque with the inverters enabled until the brake is
+ *         released.
+ */
+static void FSM_LaunchArmedEntry(void)
+{
+    LOG("Launch control armed");
+}
 
 /**
- * @brief  Executes operations common to all FSM stages.
- * @note   This function is called from every stage to perform essential,
- *         state-independent tasks like processing incoming CAN messages,
- *         checking for short circuits, monitoring node keep-alives, and
- *         controlling the brake light.
+ * @brief  Launch control guard: gas pressed enough to launch.
  */
-void FSM_InAnyStage()
+static uint8_t FSM_GuardLaunchGas(void)
 {
+    return (pMainDB->pedal_node->gas_value >= pMainDB->vcu_node->params.lc_gas_min);
+}
+
+/**
+ * @brief  Launch control guard: exit speed reached or gas lifted.
+ */
+static uint8_t FSM_GuardLaunchOver(void)
+{
+    return (lc_IsDone() || !FSM_GuardLaunchGas());
+}
+
+/**
+ * @brief  Launch entry: starts the launch from a clean traction control.
+ */
+static void FSM_LaunchEntry(void)
+{
+    tc_Reset();
+    lc_Start();
+    LOG("Launch");
+}
+
+/**
+ * @brief  Launch exit: back to the driver request, the traction control keeps its state.
+ */
+static void FSM_LaunchExit(void)
+{
+    lc_Stop();
+}
+
+/**
+ * @brief  High voltage lost while driving: sets the error, the transition leaves Stage 3.
+ * @note   The error is handled by FSM_Error_Handler in the next FSM_TaskSafety, not from
+ *         inside the transition.
+ */
+static void FSM_HvLost(void)
+{
+    pMainDB->vcu_node->error_group.system_error = HV_ERROR;
+}
+
+/**
+ * @brief  Stage 3 guard: an inverter is not on any more.
+ */
+static uint8_t FSM_GuardInverterLost(void)
+{
+    return (inv_ReadyCount() < 4);
+}
+
+/**
+ * @brief  Inverter lost while driving: logs it, the transition leaves Stage 3.
+ * @note   The sequencer of the inverter resets it on its own (amk_Step), Stage 2 holds
+ *         zero torque until then and the R2D procedure is required again.
+ */
+static void FSM_InvLost(void)
+{
+    LOG("Inverter lost, R2D required");
+}
+
+/**
+ * @brief  Thermal warning: sends the derating to the dashboard without waiting for the HMI task.
+ */
+static void FSM_ThermalWarning(void)
+{
+    opr_DashboardStatus();
+}
+
+/**
+ * @brief  Stage 3 exit: silences the buzzer if the stage is left while it sounds.
+ */
+static void FSM_Stage3Exit(void)
+{
+    opr_BuzzerStop();
+}
+
+
+/**
+ * @brief  Control task: communication, sensors and torque.
+ * @note   Runs every FSM_CONTROL_PERIOD_MS. Processes the received messages, updates the
+ *         on-board sensors, dispatches the events they posted, updates the state estimator, runs
+ *         the driving routine in Stage 3 and sends the setpoints to
+ *         the inverters once they are addressed (Stage 2 and later). With the launch control
+ *         armed the driving routine is skipped, brake and gas are both pressed on purpose.
+ */
+void FSM_TaskControl(void)
+{
+    PROF_BEGIN(PRF_TASK_CONTROL);
     plt_CanProcessRxMsgs();
+    #ifdef HAL_UART_MODULE_ENABLED
+    plt_UartProcessRxMsgs();
+    plt_UartSyncMCUs();
+    #endif
+    #ifdef HAL_SPI_MODULE_ENABLED
+    plt_SpiProcessRxMsgs();
+    #endif
+    InternalSensorsUpdate();
+    FSM_DispatchEvents();
+    inv_Estimate();
+
+    if(FSM_InState(FSM_ST_LC_ARMED))
+    {
+        inv_SetZeroTorque(pMainDB->vcu_node->params.pos_torque_limit, pMainDB->vcu_node->params.neg_torque_limit);
+    }
+    else if(FSM_InState(FSM_ST_STAGE3))
+    {
+        inv_DrivingRoutine();
+    }
+    if(FSM_InState(FSM_ST_INV_ACTIVE))
+    {
+        inv_CyclicTransmission();
+    }
+    PROF_END(PRF_TASK_CONTROL);
+}
+
+/**
+ * @brief  Safety task: checks common to all stages.
+ * @note   Runs every FSM_SAFETY_PERIOD_MS. Checks for short circuits, steps the inverter
+ *         startup sequencers (Stage 2 and later) and checks their errors, updates the
+ *         thermal derating, handles the resulting errors and controls the brake light.
+ *         The high voltage is checked as a level in Stage 3: EV_HV_LOST is an edge and is
+ *         missed when the voltage fell before Stage 3 or the event queue was full.
+ */
+void FSM_TaskSafety(void)
+{
+    PROF_BEGIN(PRF_TASK_SAFETY);
     opr_SCSCheck();
-    opr_KeepAliveCheck();
+    inv_Sequence(FSM_InState(FSM_ST_INV_ACTIVE));
     inv_CheckInvertersError();
-    opr_BrakeLight();
+    inv_ThermalUpdate();
+    if(FSM_InState(FSM_ST_STAGE3) && !inv_CheckHV())
+    {
+        pMainDB->vcu_node->error_group.system_error = HV_ERROR;
+    }
     FSM_Error_Handler();
+    opr_BrakeLight();
+    #ifdef HAL_SPI_MODULE_ENABLED
+    bbx_LogSnapshot(pMainDB);
+    #endif
+    PROF_END(PRF_TASK_SAFETY);
+}
+
+/**
+ * @brief  HMI task: stage LED blinking and dashboard status.
+ * @note   Runs every FSM_HMI_PERIOD_MS. The steady LEDs are set by the entry actions, only
+ *         the Stage 2.5 blink needs the task. The dashboard status frame (stage, thermal
+ *         warning and derating) is sent on every run.
+ */
+void FSM_TaskHmi(void)
+{
+    PROF_BEGIN(PRF_TASK_HMI);
+    if(FSM_InState(FSM_ST_STAGE2HALF))
+    {
+        opr_Stage_Leds(Stage2half);
+    }
+    opr_DashboardStatus();
+    PROF_END(PRF_TASK_HMI);
 }
 
 /**
  * @brief  Handles system errors based on the current error code.
  * @note   This function is called to manage system faults. It takes specific
- *         actions depending on the error code, such as resetting the FSM to
+ *         actions depending on the error code, such as forcing the FSM back to
  *         Stage 1, resetting inverters, or printing error messages.
  */
 void FSM_Error_Handler(void)
@@ -191,19 +511,19 @@ void FSM_Error_Handler(void)
         return;
         break;
     case PEDAL_COMMUNICTION_ERROR:
-        printf("Pedal Communication Error Detected\r\n");
+        LOG("Pedal Communication Error Detected");
         break;
     case INV_COMMUNICTION_ERROR:
-        (*FSM_Stage) = Stage1;
+        hsm_Goto(&VehicleFsm, FSM_ST_STAGE1);
         inv_set_ErrorReset();
         HAL_GPIO_WritePin(BE1_GROUP,BE1_PIN,RESET);
         (*BuzzerCounter) = 0 ;
         break;
 
     case HV_ERROR:
-        (*FSM_Stage) = Stage1;
+        hsm_Goto(&VehicleFsm, FSM_ST_STAGE1);
         inv_set_ErrorReset();
-        printf("HV fall Detected\r\n");
+        LOG("HV fall Detected");
         break;
     default:
         break;
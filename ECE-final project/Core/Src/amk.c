@@ -0,0 +1,129 @@
+#include "amk.h"
+
+// AMK startup sequencer: the switch-on handshake of one inverter
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Enter a state, restarts its timer
+ */
+static void amk_Enter(amk_t* amk, AmkState_t state)
+{
+    amk->state = state;
+    amk->timer = 0;
+}
+
+/**
+ * @brief Restart the sequence after a failed step, or give up
+ */
+static void amk_Retry(amk_t* amk, AmkState_t state)
+{
+    if (amk->retries >= AMK_MAX_RETRIES)
+    {
+        amk_Enter(amk, AMK_ST_FAULT);
+        return;
+    }
+    amk->retries++;
+    amk_Enter(amk, state);
+}
+
+/**
+ * @brief Initialize a sequencer, the inverter stays off
+ */
+void amk_Init(amk_t* amk)
+{
+    amk_Enter(amk, AMK_ST_OFF);
+    amk->retries = 0;
+    amk->controlWord = 0;
+}
+
+/**
+ * @brief Give the inverter a new set of retries
+ * @note  Leaves AMK_ST_FAULT, the sequence restarts from AMK_ST_OFF (with an error reset
+ *        if the inverter still reports an error). The other states keep running.
+ */
+void amk_Reset(amk_t* amk)
+{
+    amk->retries = 0;
+    if (amk->state == AMK_ST_FAULT) amk_Enter(amk, AMK_ST_OFF);
+}
+
+/**
+ * @brief Step the startup sequence of one inverter
+ * @param amk     Sequencer of the inverter
+ * @param in      Status bits of its last actual values 1 frame
+ * @param request 1 while the vehicle wants the inverter on, 0 switches it off
+ * @retval Control word to send
+ * @note  AMK handshake: SystemReady, then DcOn until the DC bus is on and QuitDcOn, then
+ *        Enable and InverterOn until QuitInverterOn. An error at any step takes the
+ *        enable bits away and holds ErrorReset until the error clears, then the sequence
+ *        restarts. A missing acknowledgement (AMK_QUIT_DC_TIMEOUT, AMK_ON_TIMEOUT) and an
+ *        error that does not clear (AMK_RESET_TIMEOUT) cost a retry, after AMK_MAX_RETRIES
+ *        the inverter goes to AMK_ST_FAULT. Waiting for the DC bus itself has no timeout,
+ *        the tractive system is switched on by the driver. Only this inverter is
+ *        re-sequenced, the others keep their state. Call every tick, the setpoints must
+ *        be zero unless amk_IsReady.
+ */
+uint16_t amk_Step(amk_t* amk, const amk_input_t* in, uint8_t request)
+{
+    if (!request)
+    {
+        amk_Init(amk);
+        return amk->controlWord;
+    }
+
+    if (amk->timer < UINT16_MAX) amk->timer++;
+    if (in->error && amk->state != AMK_ST_ERROR_RESET && amk->state != AMK_ST_FAULT)
+    {
+        amk_Retry(amk, AMK_ST_ERROR_RESET);
+    }
+
+    switch (amk->state)
+    {
+    case AMK_ST_OFF:
+        if (in->systemReady) amk_Enter(amk, AMK_ST_DC_ON);
+        break;
+    case AMK_ST_DC_ON:
+        if (!in->dcOn) amk->timer = 0; // The DC bus comes with the tractive system
+        else if (in->quitDcOn) amk_Enter(amk, AMK_ST_ENABLE);
+        else if (amk->timer >= AMK_QUIT_DC_TIMEOUT) amk_Retry(amk, AMK_ST_OFF);
+        break;
+    case AMK_ST_ENABLE:
+        if (!in->dcOn) amk_Enter(amk, AMK_ST_DC_ON);
+        else if (in->quitInverterOn && in->inverterOn)
+        {
+            amk_Enter(amk, AMK_ST_READY);
+            amk->retries = 0;
+        }
+        else if (amk->timer >= AMK_ON_TIMEOUT) amk_Retry(amk, AMK_ST_OFF);
+        break;
+    case AMK_ST_READY:
+        if (!in->dcOn || !in->quitDcOn) amk_Enter(amk, AMK_ST_DC_ON);
+        else if (!in->quitInverterOn) amk_Enter(amk, AMK_ST_ENABLE);
+        break;
+    case AMK_ST_ERROR_RESET:
+        if (!in->error) amk_Enter(amk, AMK_ST_OFF);
+        else if (amk->timer >= AMK_RESET_TIMEOUT) amk_Enter(amk, AMK_ST_OFF); // Drops the bit, the next reset is a new edge and a retry
+        break;
+    default:
+        break;
+    }
+
+    switch (amk->state)
+    {
+    case AMK_ST_DC_ON:       amk->controlWord = bDcOn; break;
+    case AMK_ST_ENABLE:
+    case AMK_ST_READY:       amk->controlWord = bDcOn | bEnable | bInverterOn; break;
+    case AMK_ST_ERROR_RESET: amk->controlWord = bDcOn | bErrorReset; break;
+    default:                 amk->controlWord = 0; break;
+    }
+    return amk->controlWord;
+}
+
+/**
+ * @brief Check if the inverter is on and applies its setpoints
+ */
+uint8_t amk_IsReady(const amk_t* amk)
+{
+    return (amk->state == AMK_ST_READY);
+}
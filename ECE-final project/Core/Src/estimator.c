@@ -0,0 +1,197 @@
+#include "estimator.h"
+
+// State estimator: Kalman filter for the longitudinal speed and acceleration
+
+/* =============================== Global Variables =============================== */
+
+// All matrices are static, the measurement ones are sized for EST_MAX_MEAS and
+// re-initialized with the rows used on each call
+static float32_t XData[EST_STATES];                          // [speed, accel]
+static float32_t PData[EST_STATES * EST_STATES];
+static float32_t FData[EST_STATES * EST_STATES] = {1.0f, EST_DT, 0.0f, 1.0f};
+static float32_t FtData[EST_STATES * EST_STATES];
+static float32_t QData[EST_STATES * EST_STATES];
+static float32_t IData[EST_STATES * EST_STATES] = {1.0f, 0.0f, 0.0f, 1.0f};
+static float32_t HData[EST_MAX_MEAS * EST_STATES];
+static float32_t HtData[EST_STATES * EST_MAX_MEAS];
+static float32_t RData[EST_MAX_MEAS * EST_MAX_MEAS];
+static float32_t SData[EST_MAX_MEAS * EST_MAX_MEAS];
+static float32_t SiData[EST_MAX_MEAS * EST_MAX_MEAS];
+static float32_t KData[EST_STATES * EST_MAX_MEAS];
+static float32_t PHtData[EST_STATES * EST_MAX_MEAS];
+static float32_t ZData[EST_MAX_MEAS];
+static float32_t YData[EST_MAX_MEAS];
+static float32_t HXData[EST_MAX_MEAS];
+static float32_t T1Data[EST_STATES * EST_STATES];
+static float32_t T2Data[EST_STATES * EST_STATES];
+static float32_t KYData[EST_STATES];
+
+static arm_matrix_instance_f32 X, P, F, Ft, Q, I, T1, T2, KY, XNew;
+static float32_t XNewData[EST_STATES];
+static float32_t Jerk = -1.0f;       // Jerk of the current Q
+static float32_t RpmToSpeed;
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Process noise of a constant acceleration model driven by white jerk
+ */
+static void est_LoadQ(float32_t jerk)
+{
+    float32_t q = jerk * jerk;
+
+    QData[0] = q * EST_DT * EST_DT * EST_DT / 3.0f;
+    QData[1] = q * EST_DT * EST_DT / 2.0f;
+    QData[2] = QData[1];
+    QData[3] = q * EST_DT;
+    Jerk = jerk;
+}
+
+/**
+ * @brief Initialize the state estimator, the car stands still
+ */
+void est_Init(void)
+{
+    RpmToSpeed = 2.0f * PI / 60.0f / TV_GEAR_RATIO * TV_WHEEL_RADIUS;
+    arm_mat_init_f32(&X, EST_STATES, 1, XData);
+    arm_mat_init_f32(&XNew, EST_STATES, 1, XNewData);
+    arm_mat_init_f32(&P, EST_STATES, EST_STATES, PData);
+    arm_mat_init_f32(&F, EST_STATES, EST_STATES, FData);
+    arm_mat_init_f32(&Ft, EST_STATES, EST_STATES, FtData);
+    arm_mat_init_f32(&Q, EST_STATES, EST_STATES, QData);
+    arm_mat_init_f32(&I, EST_STATES, EST_STATES, IData);
+    arm_mat_init_f32(&T1, EST_STATES, EST_STATES, T1Data);
+    arm_mat_init_f32(&T2, EST_STATES, EST_STATES, T2Data);
+    arm_mat_init_f32(&KY, EST_STATES, 1, KYData);
+    arm_mat_trans_f32(&F, &Ft);
+
+    memset(XData, 0, sizeof(XData));
+    memset(PData, 0, sizeof(PData));
+    PData[0] = 1.0f;
+    PData[3] = 1.0f;
+    Jerk = -1.0f;
+}
+
+/**
+ * @brief Estimate the speed, acceleration and wheel slips
+ * @param in    Motor speeds and torques, IMU and brake
+ * @param gains Noises and acceleration limit
+ * @param out   Speed, acceleration, slips and speed deviation
+ * @note  State [v, a], constant acceleration prediction x = F x, P = F P F' + Q with
+ *        white jerk noise. Up to three measurements, z = H x with the rows in use:
+ *        - the wheel speed, the slowest wheel while driving and the fastest while braking
+ *          (all four are driven, the wheel closest to the ground speed). Its noise grows
+ *          with the spread of the wheels and with a wheel speed that runs away from the
+ *          estimate in the slip direction, so spinning or locking wheels lose weight.
+ *        - the acceleration of the motor torques minus the drag, clamped to
+ *          gains->maxAccel (the tyres cannot pass more). Not used while the hydraulic
+ *          brake is pressed, its torque is unknown.
+ *        - the IMU acceleration when in->accelValid.
+ *        Update K = P H' (H P H' + R)^-1, x += K (z - H x), P = (I - K H) P with the
+ *        CMSIS-DSP matrix functions, all buffers static. Call every EST_DT.
+ */
+void est_Process(const est_input_t* in, const est_gains_t* gains, est_output_t* out)
+{
+    arm_matrix_instance_f32 H, Ht, R, S, Si, K, PHt, Z, Y, HX;
+    float32_t w[TV_NUM_WHEELS];
+    float32_t slowest = 0.0f, fastest = 0.0f, sum = 0.0f, force = 0.0f;
+    float32_t noise[EST_MAX_MEAS];          // Measurement variances
+    float32_t wheel, away;
+    int8_t dir;
+    uint8_t m = 0;
+
+    if (gains->jerk != Jerk) est_LoadQ(gains->jerk);
+
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        w[i] = in->motorSpeed[i] * RpmToSpeed;
+        if (i == 0 || w[i] < slowest) slowest = w[i];
+        if (i == 0 || w[i] > fastest) fastest = w[i];
+        sum += w[i];
+        force += in->torque[i] * TV_GEAR_RATIO / TV_WHEEL_RADIUS;
+    }
+
+    // Predict
+    arm_mat_mult_f32(&F, &X, &XNew);
+    memcpy(XData, XNewData, sizeof(XData));
+    arm_mat_mult_f32(&F, &P, &T1);
+    arm_mat_mult_f32(&T1, &Ft, &T2);
+    arm_mat_add_f32(&T2, &Q, &P);
+
+    // Wheel speed, direction of the slip from the torques
+    dir = (in->braking || force < 0.0f) ? -1 : (force > 0.0f) ? 1 : 0;
+    wheel = (dir > 0) ? slowest : (dir < 0) ? fastest : 0.25f * sum;
+    away = (wheel - XData[0]) * (float32_t)dir;
+    if (dir == 0 || away < 0.0f) away = 0.0f;
+    memset(HData, 0, sizeof(HData));
+    HData[m * EST_STATES] = 1.0f;
+    ZData[m] = wheel;
+    noise[m] = gains->wheelNoise * gains->wheelNoise + (fastest - slowest) * (fastest - slowest) +
+               EST_AWAY_WEIGHT * away * away;
+    m++;
+
+    // Acceleration of the motor torques
+    if (!in->braking)
+    {
+        float32_t a = (force - EST_DRAG * XData[0] * fabsf(XData[0])) / EST_MASS;
+        if (a > gains->maxAccel) a = gains->maxAccel;
+        if (a < -gains->maxAccel) a = -gains->maxAccel;
+        HData[m * EST_STATES + 1] = 1.0f;
+        ZData[m] = a;
+        noise[m] = gains->accelNoise * gains->accelNoise;
+        m++;
+    }
+
+    // IMU
+    if (in->accelValid)
+    {
+        HData[m * EST_STATES + 1] = 1.0f;
+        ZData[m] = in->accel;
+        noise[m] = gains->imuNoise * gains->imuNoise;
+        m++;
+    }
+
+    // Update with the m rows in use, the noises are independent
+    memset(RData, 0, sizeof(RData));
+    for (uint8_t r = 0; r < m; r++)
+    {
+        RData[r * m + r] = noise[r];
+    }
+    arm_mat_init_f32(&H, m, EST_STATES, HData);
+    arm_mat_init_f32(&Ht, EST_STATES, m, HtData);
+    arm_mat_init_f32(&R, m, m, RData);
+    arm_mat_init_f32(&S, m, m, SData);
+    arm_mat_init_f32(&Si, m, m, SiData);
+    arm_mat_init_f32(&K, EST_STATES, m, KData);
+    arm_mat_init_f32(&PHt, EST_STATES, m, PHtData);
+    arm_mat_init_f32(&Z, m, 1, ZData);
+    arm_mat_init_f32(&Y, m, 1, YData);
+    arm_mat_init_f32(&HX, m, 1, HXData);
+
+    arm_mat_trans_f32(&H, &Ht);
+    arm_mat_mult_f32(&P, &Ht, &PHt);
+    arm_mat_mult_f32(&H, &PHt, &S);
+    arm_mat_add_f32(&S, &R, &S);
+    if (arm_mat_inverse_f32(&S, &Si) == ARM_MATH_SUCCESS)
+    {
+        arm_mat_mult_f32(&PHt, &Si, &K);
+        arm_mat_mult_f32(&H, &X, &HX);
+        arm_mat_sub_f32(&Z, &HX, &Y);
+        arm_mat_mult_f32(&K, &Y, &KY);
+        arm_mat_add_f32(&X, &KY, &XNew);
+        memcpy(XData, XNewData, sizeof(XData));
+
+        arm_mat_mult_f32(&K, &H, &T1);
+        arm_mat_sub_f32(&I, &T1, &T2);
+        arm_mat_mult_f32(&T2, &P, &T1);
+        memcpy(PData, T1Data, sizeof(PData));
+    }
+
+    out->speed = XData[0];
+    out->accel = XData[1];
+    out->speedStd = sqrtf(PData[0]);
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        out->slip[i] = (w[i] - XData[0]) / ((fabsf(XData[0]) > EST_MIN_SPEED) ? fabsf(XData[0]) : EST_MIN_SPEED);
+    }
+}
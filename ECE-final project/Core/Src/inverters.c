@@ -8,6 +8,9 @@ static database_t *pMainDB = NULL;
 static CanChanel_t channel;
 static uint8_t BPPC = 0;
 static uint8_t *R2D_Pressed = 0; // Variable to check if R2D is pressed
+static amk_t Amk[4]; // Startup sequencer of each inverter, stepped by inv_Sequence
+static float32_t ThermalFactor[4] = {1.0f, 1.0f, 1.0f, 1.0f}; // Derating of each motor, from inv_ThermalUpdate
+static est_output_t Estimate; // Vehicle speed and acceleration, from inv_Estimate
 
 static can_message_t INV_Setpoints_msgs[] = {
     {INV1_Setpoints_ID, {0}},
@@ -15,12 +18,49 @@ static can_message_t INV_Setpoints_msgs[] = {
     {INV3_Setpoints_ID, {0}},
     {INV4_Setpoints_ID, {0}}};
 
+// AMK setpoints frame: little endian 16 bit words of inverter_t.setpoints. Bytes 2..3 are
+// the target of the control mode the inverters are parameterised for.
+static const inv_word_t INV_Setpoints_layout[] = {
+    {0, offsetof(inverter_setpoints_t, control_word)},
+#if INV_TORQUE_MODE
+    {2, offsetof(inverter_setpoints_t, target_torque)},
+#else
+    {2, offsetof(inverter_setpoints_t, target_velocity)},
+#endif
+    {4, offsetof(inverter_setpoints_t, positive_torque_limit)},
+    {6, offsetof(inverter_setpoints_t, negative_torque_limit)},
+};
+
 /* ========================== Function Definitions ============================ */
 
 /**
- * @brief  Initializes the inverters and sets the initial parameters.
- * @note   This function initializes the inverters and sets the initial parameters.
+ * @brief  Initializes the inverters module.
+ * @note   Gets the database pointer and initializes the startup sequencers, torque
+ *         vectoring, traction control, launch control, regenerative braking, pedal maps,
+ *         power limiter, thermal manager and state estimator.
+ */
+void inv_Init(void)
+{
+    pMainDB = db_GetDBPointer();
+    R2D_Pressed = &pMainDB->dashboard_node->R2D;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        amk_Init(&Amk[i]);
+    }
+    tv_Init(NULL);
+    tc_Init();
+    lc_Init();
+    rg_Init();
+    pm_Init();
+    th_Init();
+    est_Init();
+}
 
+/**
+ * @brief  Initializes the inverters and sets the initial parameters.
+ * @note   Sets the pedal setpoint of each inverter that is on (amk_IsReady), the others
+ *         get a zero target. The positive limit, and with it the target, is derated by the
+ *         thermal factor of the motor. Switching the inverters on is the job of inv_Sequence.
  */
 void InvertersInitFC(void)
 {
@@ -31,46 +71,40 @@ void InvertersInitFC(void)
 
     for (uint8_t i = 0; i < 4; i++)
     {
-        channel = (i < 2) ? INV12_CAN : INV34_CAN;// Select the CAN channel based on the inverter index
-        AMK_Status_t *Inv_status = &pMainDB->vcu_node->inverters[i].AMK_Status;
+        inverter_t *inv = &pMainDB->vcu_node->inverters[i];
 
-        INV_Setpoints_msgs[i].data[2] = 0;
-        INV_Setpoints_msgs[i].data[3] = 0;
-        if(Inv_status->AMK_bQuitInverterOn)
+        if(amk_IsReady(&Amk[i]))
         {
-            inv_SetInvParameters_FC(1000,-1000);
+            int16_t posLimit = (int16_t)(ThermalFactor[i] * pMainDB->vcu_node->params.pos_torque_limit);
+            inv_SetInvParameters_FC(i, posLimit, pMainDB->vcu_node->params.neg_torque_limit);
+        }
+        else
+        {
+            inv->setpoints.target_velocity = 0;
+            inv->setpoints.target_torque = 0;
         }
-        INV_Setpoints_msgs[i].data[1] |= bDcOn;
-        INV_Setpoints_msgs[i].data[1] |= bInverterOn;
-        INV_Setpoints_msgs[i].data[1] |= bEnable; // Set the Enable bit to 1
-        
     }
     
 }
 
 /**
- * @brief  Sets the velocity and torque limits for all inverters.
+ * @brief  Sets the pedal setpoint of one inverter.
+ * @param  inv The inverter index (0..3).
  * @param  posTorqueLimit The positive torque limit to set.
  * @param  negTorqueLimit The negative torque limit to set.
  * @retval None
- * @note   This function calculates the target velocity based on the gas pedal input
- *         and updates the setpoint messages for all inverters with the new
- *         velocity and torque limits.
+ * @note   The gas pedal scales the target of both modes: max_velocity in speed mode,
+ *         posTorqueLimit in torque mode.
  */
-void inv_SetInvParameters_FC(int16_t posTorqueLimit, int16_t negTorqueLimit)
+void inv_SetInvParameters_FC(uint8_t inv, int16_t posTorqueLimit, int16_t negTorqueLimit)
 {
-  
-    int16_t velocity = MAX_VELOCITY * ((float)pMainDB->pedal_node->gas_value / 100);
+    inverter_setpoints_t *set = &pMainDB->vcu_node->inverters[inv].setpoints;
+    float gas = (float)pMainDB->pedal_node->gas_value / 100;
 
-    for(int i=0 ;i<4;i++)
-    {
-        INV_Setpoints_msgs[i].data[2] = (uint8_t)(velocity & 0xFF);
-        INV_Setpoints_msgs[i].data[3] = (uint8_t)(velocity >> 8);
-        INV_Setpoints_msgs[i].data[4] = (uint8_t)(posTorqueLimit & 0xFF);
-        INV_Setpoints_msgs[i].data[5] = (uint8_t)(posTorqueLimit >> 8);
-        INV_Setpoints_msgs[i].data[6] = (uint8_t)(negTorqueLimit & 0xFF);
-        INV_Setpoints_msgs[i].data[7] = (uint8_t)(negTorqueLimit >> 8);
-    }
+    set->target_velocity = pMainDB->vcu_node->params.max_velocity * gas;
+    set->target_torque = posTorqueLimit * gas;
+    set->positive_torque_limit = posTorqueLimit;
+    set->negative_torque_limit = negTorqueLimit;
 }
 
 /**
@@ -78,37 +112,292 @@ void inv_SetInvParameters_FC(int16_t posTorqueLimit, int16_t negTorqueLimit)
  * @param  posTorqueLimit The positive torque limit to maintain.
  * @param  negTorqueLimit The negative torque limit to maintain.
  * @retval None
- * @note   This function sets the target velocity to zero in the setpoint messages
- *         for all inverters, effectively commanding zero torque, while keeping the
- *         specified torque limits.
+ * @note   This function sets the target velocity and torque to zero for all inverters,
+ *         effectively commanding zero torque, while keeping the specified torque limits.
  */
 void inv_SetZeroTorque(int16_t posTorqueLimit, int16_t negTorqueLimit)
 {
     for(int i=0; i<4; i++){
-        INV_Setpoints_msgs[i].data[2] = (uint8_t)(0 & 0xFF);
-        INV_Setpoints_msgs[i].data[3] = (uint8_t)(0 >> 8);
-        INV_Setpoints_msgs[i].data[4] = (uint8_t)(posTorqueLimit & 0XFF);
-        INV_Setpoints_msgs[i].data[5] = (uint8_t)(posTorqueLimit >> 8);
-        INV_Setpoints_msgs[i].data[6] = (uint8_t)(negTorqueLimit & 0xFF);
-        INV_Setpoints_msgs[i].data[7] = (uint8_t)(negTorqueLimit >> 8);
+        inverter_setpoints_t *set = &pMainDB->vcu_node->inverters[i].setpoints;
+        set->target_velocity = 0;
+        set->target_torque = 0;
+        set->positive_torque_limit = posTorqueLimit;
+        set->negative_torque_limit = negTorqueLimit;
     }
 }
 
+/**
+ * @brief  Sets the torque setpoint of one inverter.
+ * @param  inv The inverter index (0..3), see TV_FL..TV_RR.
+ * @param  sp  Target torque and limits [0.1% Mn].
+ * @retval None
+ * @note   The target is clamped to the limits. In torque mode it is the torque command.
+ *         In speed mode the inverter gets max_velocity with the target as positive
+ *         limit to drive, or zero velocity with the target as negative limit to brake:
+ *         the motor cannot reach the speed, so it runs at its torque limit.
+ */
+void inv_SetSetpoint(uint8_t inv, const inv_setpoint_t* sp)
+{
+    inverter_setpoints_t *set = &pMainDB->vcu_node->inverters[inv].setpoints;
+    int16_t torque = (sp->torque > sp->posLimit) ? sp->posLimit :
+                     (sp->torque < sp->negLimit) ? sp->negLimit : sp->torque;
+
+    set->target_torque = torque;
+#if INV_TORQUE_MODE
+    set->target_velocity = 0;
+    set->positive_torque_limit = sp->posLimit;
+    set->negative_torque_limit = sp->negLimit;
+#else
+    set->target_velocity = (torque >= 0) ? pMainDB->vcu_node->params.max_velocity : 0;
+    set->positive_torque_limit = (torque >= 0) ? torque : 0;
+    set->negative_torque_limit = (torque >= 0) ? sp->negLimit : torque;
+#endif
+}
+
+/**
+ * @brief  Packs the setpoints of an inverter into its CAN frame.
+ * @note   Table driven by INV_Setpoints_layout.
+ */
+static void inv_PackSetpoints(const inverter_setpoints_t* set, can_message_t* msg)
+{
+    for (uint8_t w = 0; w < sizeof(INV_Setpoints_layout) / sizeof(INV_Setpoints_layout[0]); w++)
+    {
+        uint16_t value;
+
+        memcpy(&value, (const uint8_t*)set + INV_Setpoints_layout[w].offset, sizeof(value));
+        msg->data[INV_Setpoints_layout[w].byte] = (uint8_t)(value & 0xFF);
+        msg->data[INV_Setpoints_layout[w].byte + 1] = (uint8_t)(value >> 8);
+    }
+}
+
+/**
+ * @brief  Commands the regen torques of the brake pedal.
+ * @retval 1 while a regen torque is commanded, 0 when the torque path is free.
+ * @note   The brake pedal asks for regen when BIOPS confirms it is pressed and the gas is
+ *         released. The pack voltage is the highest DC bus voltage of the inverters, the
+ *         temperature of a wheel its inverter cold plate. The regen ramps out after the
+ *         pedal is released, the torque path takes over once it reached 0. The torques
+ *         are kept within params.neg_torque_limit. No decoder fills dc_bus_voltage yet:
+ *         rg_Process gives no regen at 0 V, RG_ENABLE defaults to 0 and the shell
+ *         refuses rg_enable 1.
+ */
+static uint8_t inv_RegenControl(void)
+{
+    params_t* params = &pMainDB->vcu_node->params;
+    rg_gains_t gains = {params->rg_max_torque, params->rg_front_split, params->rg_pedal_start,
+                        params->rg_pedal_full, params->rg_volt_start, params->rg_volt_max,
+                        params->rg_temp_start, params->rg_temp_max, params->rg_rate};
+    rg_input_t in = {0};
+    rg_output_t out;
+    inv_setpoint_t sp[4];
+    uint8_t active = 0;
+
+    if (pMainDB->pedal_node->BIOPS > BRAKE_PEDAL_THRESHOLD && pMainDB->pedal_node->gas_value < INV_REGEN_GAS_MAX)
+    {
+        in.brake = pMainDB->pedal_node->brake_value;
+    }
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        inverter_t* inv = &pMainDB->vcu_node->inverters[i];
+        if (inv->dc_bus_voltage > in.packVoltage) in.packVoltage = inv->dc_bus_voltage;
+        in.temperature[i] = (float)inv->plate_temperature / 10;
+        in.motorSpeed[i] = inv->actual_speed;
+    }
+
+    PROF_BEGIN(PRF_REGEN);
+    rg_Process(&in, &gains, &out);
+    PROF_END(PRF_REGEN);
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        sp[i].torque = (int16_t)(out.torque[i] * ThermalFactor[i] / TV_MOTOR_MN * 1000);
+        sp[i].posLimit = 0; // The motors never drive while braking
+        sp[i].negLimit = params->neg_torque_limit;
+        if (sp[i].torque < sp[i].negLimit) sp[i].torque = sp[i].negLimit;
+        if (sp[i].torque < 0) active = 1;
+    }
+    if (active)
+    {
+        for (uint8_t i = 0; i < 4; i++) inv_SetSetpoint(i, &sp[i]);
+    }
+    return active;
+}
+
+/**
+ * @brief  Commands the driver request as per-wheel torques.
+ * @note   The driver request is the pedal map of params.pm_mode (gas and speed to a share
+ *         of pos_torque_limit on each motor). tv_Process moves
+ *         it between the wheels for the yaw moment that follows the steering (equal split
+ *         when tv_enable is 0) within the thermal limit of each motor, then tc_Process cuts the wheels that slip (tc_enable).
+ *         A motor whose inverter is not on (amk_IsReady) gets a zero limit, so its share
+ *         goes to the other wheel of the same side instead of being lost.
+ *         During a launch lc_Process caps the request to lc_torque_scale and sets the
+ *         slip target, the traction control then runs whatever tc_enable says. Last the
+ *         power limiter scales the torques to the allowed power (pl_enable), feed-forward
+ *         only until a DC side measurement is decoded (the BMS frame is empty). With est_enable the torque vectoring
+ *         and the traction control take the speed of the state estimator (inv_Estimate).
+ */
+static void inv_TorqueControl(void)
+{
+    params_t* params = &pMainDB->vcu_node->params;
+    tv_gains_t tvGains = {params->tv_front_split, params->tv_yaw_ff, params->tv_yaw_kp};
+    tc_gains_t tcGains = {params->tc_slip_target, params->tc_kp, params->tc_ki, 0.0f, params->tc_accel_limit};
+    tv_input_t in;
+    tv_output_t out;
+    tc_input_t tcIn;
+    tc_output_t tcOut;
+    lc_gains_t lcGains = {params->lc_torque_scale, params->lc_slip_target, params->lc_exit_speed};
+    lc_input_t lcIn;
+    lc_output_t lcOut;
+    pl_gains_t plGains = {params->pl_limit, params->pl_margin};
+    pl_input_t plIn;
+    pl_output_t plOut;
+    uint8_t launch = lc_IsActive();
+    float32_t* torque = out.torque;
+
+    in.steering = (float)pMainDB->pedal_node->steering_wheel_angle / MAX_VALUE_SW;
+    in.speed = Estimate.speed;
+    in.speedValid = params->est_enable;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        in.motorSpeed[i] = pMainDB->vcu_node->inverters[i].actual_speed;
+        in.torqueLimit[i] = amk_IsReady(&Amk[i]) ?
+                            ThermalFactor[i] * ((float)params->pos_torque_limit / 1000) * TV_MOTOR_MN : 0.0f;
+    }
+    in.driverTorque = pm_Process((PmMode_t)params->pm_mode, (float)pMainDB->pedal_node->gas_value, in.motorSpeed) *
+                      4.0f * ((float)params->pos_torque_limit / 1000) * TV_MOTOR_MN;
+
+    if (launch)
+    {
+        float32_t cap;
+
+        memcpy(lcIn.motorSpeed, in.motorSpeed, sizeof(lcIn.motorSpeed));
+        lc_Process(&lcIn, &lcGains, &lcOut);
+        cap = lcOut.torqueScale * 4.0f * ((float)params->pos_torque_limit / 1000) * TV_MOTOR_MN;
+        if (in.driverTorque > cap) in.driverTorque = cap;
+        tcGains.slipTarget = lcOut.slipTarget;
+    }
+
+    if (!params->tv_enable)
+    {
+        tvGains.yawFF = 0.0f;   // Allocation without yaw moment
+        tvGains.yawKp = 0.0f;
+        tvGains.frontSplit = 0.5f;
+    }
+    PROF_BEGIN(PRF_TORQUE_VECTORING);
+    tv_Process(&in, &tvGains, &out);
+    PROF_END(PRF_TORQUE_VECTORING);
+
+    if (params->tc_enable || launch)
+    {
+        memcpy(tcIn.torque, out.torque, sizeof(tcIn.torque));
+        memcpy(tcIn.motorSpeed, in.motorSpeed, sizeof(tcIn.motorSpeed));
+        tcIn.speed = Estimate.speed;
+        tcIn.speedValid = params->est_enable;
+        PROF_BEGIN(PRF_TRACTION_CONTROL);
+        tc_Process(&tcIn, &tcGains, &tcOut);
+        PROF_END(PRF_TRACTION_CONTROL);
+        torque = tcOut.torque;
+    }
+
+    if (params->pl_enable)
+    {
+        memcpy(plIn.torque, torque, sizeof(plIn.torque));
+        memcpy(plIn.motorSpeed, in.motorSpeed, sizeof(plIn.motorSpeed));
+        PROF_BEGIN(PRF_POWER_LIMIT);
+        pl_Process(&plIn, &plGains, &plOut);
+        PROF_END(PRF_POWER_LIMIT);
+        torque = plOut.torque;
+    }
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        inv_setpoint_t sp = {(int16_t)(torque[i] / TV_MOTOR_MN * 1000), params->pos_torque_limit, params->neg_torque_limit};
+        inv_SetSetpoint(i, &sp);
+    }
+}
 
 /**
  * @brief Send Setpoints values to the inverters every timer elpsed.
- * @note This function sends the Setpoints values to the inverters every timer elpsed.
+ * @note This function packs and sends the setpoints of each inverter every control tick,
+ *       with zero targets and limits while the inverter is not on (AMK handshake).
+ *       It never waits for a free TX mailbox: a message that does not fit is sent first
+ *       on the next call, so every inverter gets its setpoints at the same average rate.
  */
 void inv_CyclicTransmission(void)
 {
-        for (uint8_t i = 0; i < 4; i++)
+        static uint8_t first = 0; // First inverter to send, the one that did not fit last time
+
+        for (uint8_t n = 0; n < 4; n++)
         {
+            uint8_t i = (first + n) % 4;
             channel = (i < 2) ? INV12_CAN : INV34_CAN;          
-            INV_Setpoints_msgs[i].data[1] |= bDcOn;
-            plt_CanSendMsg(channel, &INV_Setpoints_msgs[i]);
-            HAL_Delay(1);
+            inverter_setpoints_t set = pMainDB->vcu_node->inverters[i].setpoints;
+
+            if (!amk_IsReady(&Amk[i]))
+            {
+                set.target_velocity = 0;
+                set.target_torque = 0;
+                set.positive_torque_limit = 0;
+                set.negative_torque_limit = 0;
+            }
+            inv_PackSetpoints(&set, &INV_Setpoints_msgs[i]);
+            if (plt_CanSendMsg(channel, &INV_Setpoints_msgs[i]) != HAL_OK)
+            {
+                first = i;
+                return;
+            }
+        }
+}
+
+/**
+ * @brief  Steps the startup sequencer of each inverter.
+ * @param  request 1 while the inverters are addressed (Stage 2 and later), 0 switches
+ *         them off.
+ * @note   Called from the safety task. Each inverter follows the AMK handshake on its own
+ *         acknowledgements (see amk_Step), a slow or faulted inverter does not hold the
+ *         others back. The control word goes to setpoints.control_word. EV_INV_READY is
+ *         posted when the last sequencer reaches AMK_ST_READY and EV_INV_LOST when one
+ *         leaves it, so the FSM follows the sequencers and not the raw status bits.
+ */
+void inv_Sequence(uint8_t request)
+{
+    uint8_t readyBefore = inv_ReadyCount();
+    uint8_t lost = 0;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        inverter_t* inv = &pMainDB->vcu_node->inverters[i];
+        AmkState_t last = Amk[i].state;
+        amk_input_t in = {inv->AMK_Status.AMK_bSystemReady, inv->AMK_Status.AMK_bError,
+                          inv->AMK_Status.AMK_bDcOn, inv->AMK_Status.AMK_bQuitDCon,
+                          inv->AMK_Status.AMK_bInverterOn, inv->AMK_Status.AMK_bQuitInverterOn};
+
+        inv->setpoints.control_word = amk_Step(&Amk[i], &in, request);
+        if (Amk[i].state != last)
+        {
+            LOG("Inverter %u: AMK state %u -> %u", i + 1, last, Amk[i].state);
+            if (last == AMK_ST_READY) lost = 1;
         }
-        printf("Sending Setpoints to the Inverters \r\n");
+    }
+
+    if (lost) (void)ev_Post(EV_INV_LOST);
+    else if (readyBefore < 4 && inv_ReadyCount() == 4) (void)ev_Post(EV_INV_READY);
+}
+
+/**
+ * @brief  Counts the inverters that are on.
+ * @retval Number of inverters in AMK_ST_READY.
+ * @note   The vehicle readiness for the FSM, see inv_CheckInit.
+ */
+uint8_t inv_ReadyCount(void)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        count += amk_IsReady(&Amk[i]);
+    }
+    return count;
 }
 
 /**
@@ -128,44 +417,149 @@ uint8_t inv_CheckHV()
             return 0;
         }
     }
-    printf("High Voltage Detected \r\n");
+    LOG("High Voltage Detected");
     return 1;
 }
 
 
 /**
  * @brief  Turns on the BE1 pin as part of the inverter initialization sequence.
- * @note   This function verifies that all inverters are at the right position before enabling the BE1 pin.
+ * @note   This function verifies that all inverters are on before enabling the BE1 pin.
  */
 void inv_TurnOnBE1()
+{
+    if (inv_ReadyCount() < 4) {
+        return ;
+    }
+    HAL_GPIO_WritePin(BE1_GROUP,BE1_PIN,SET);
+    LOG("BE1 Turned ON");
+}
+
+/**
+ * @brief  Checks if the vehicle stands still.
+ * @retval 1 if all motors turn slower than INV_STANDSTILL_RPM, 0 otherwise.
+ */
+uint8_t inv_Standstill(void)
 {
     inverter_t* pInverters = pMainDB->vcu_node->inverters;
     for (int i = 0; i < 4; ++i) {
-        if (pInverters[i].AMK_Status.AMK_bInverterOn != 1) {
-            return ;
+        if (pInverters[i].actual_speed > INV_STANDSTILL_RPM ||
+            pInverters[i].actual_speed < -INV_STANDSTILL_RPM) {
+            return 0;
         }
     }
-    HAL_GPIO_WritePin(BE1_GROUP,BE1_PIN,SET);
-    printf("BE1 Turned ON \r\n");
+    return 1;
+}
+
+/**
+ * @brief  Updates the thermal derating of each motor.
+ * @note   Called from the safety task every TH_DT. The motor, cold plate and IGBT
+ *         temperatures of the AV2 frames go through the thermal manager, its factors
+ *         limit the torque of each motor in inv_TorqueControl, InvertersInitFC and the
+ *         regen. A motor is not derated before the first AV2 frame of its inverter. The
+ *         factors and the warning go to the DB for the dashboard status frame
+ *         (opr_DashboardStatus), EV_THERMAL_WARNING is posted once when a factor falls
+ *         below th_warning so the frame goes out at once.
+ */
+void inv_ThermalUpdate(void)
+{
+    static uint8_t Warning = 0;
+    params_t* params = &pMainDB->vcu_node->params;
+    th_gains_t gains = {params->th_horizon, params->th_recovery, params->th_warning};
+    th_input_t in;
+    th_output_t out;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        inverter_t* inv = &pMainDB->vcu_node->inverters[i];
+        in.temperature[i][TH_MOTOR] = (float)inv->motor_temperature / 10;
+        in.temperature[i][TH_PLATE] = (float)inv->plate_temperature / 10;
+        in.temperature[i][TH_IGBT] = (float)inv->igbt_temperature / 10;
+        in.valid[i] = inv->av2_received;
+    }
+    th_Process(&in, &gains, &out); // Also when disabled, the rates stay up to date
+
+    if (!params->th_enable)
+    {
+        out.warning = 0;
+        for (uint8_t i = 0; i < 4; i++) out.factor[i] = 1.0f;
+    }
+    memcpy(ThermalFactor, out.factor, sizeof(ThermalFactor));
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        pMainDB->vcu_node->thermal_derate[i] = (uint8_t)(out.factor[i] * 100 + 0.5f);
+    }
+    pMainDB->vcu_node->thermal_warning = out.warning;
+
+    if (out.warning && !Warning)
+    {
+        uint8_t worst = 0;
+        for (uint8_t i = 1; i < 4; i++)
+        {
+            if (out.factor[i] < out.factor[worst]) worst = i;
+        }
+        (void)ev_Post(EV_THERMAL_WARNING);
+        LOG("Thermal derating, inverter %u at %u%%", worst + 1, (unsigned)(out.factor[worst] * 100));
+    }
+    Warning = out.warning;
+}
+
+/**
+ * @brief  Updates the state estimator.
+ * @note   Called from the control task every EST_DT, also outside Stage 3 so the estimate
+ *         follows the car before the driving routine takes it. The torques are the targets
+ *         of the inverters that are on, the braking flag the BIOPS. The IMU frame is used
+ *         while it keeps coming, INV_IMU_TIMEOUT ticks without one and the filter runs on
+ *         the wheels and torques alone.
+ */
+void inv_Estimate(void)
+{
+    static uint16_t ImuFrames = 0;
+    static uint8_t ImuAge = INV_IMU_TIMEOUT;
+    params_t* params = &pMainDB->vcu_node->params;
+    imu_t* imu = &pMainDB->vcu_node->imu;
+    est_gains_t gains = {params->est_jerk, params->est_wheel_noise, params->est_accel_noise,
+                         params->est_imu_noise, params->tc_accel_limit};
+    est_input_t in;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        inverter_t* inv = &pMainDB->vcu_node->inverters[i];
+        in.motorSpeed[i] = inv->actual_speed;
+        in.torque[i] = amk_IsReady(&Amk[i]) ? (float)inv->setpoints.target_torque / 1000 * TV_MOTOR_MN : 0.0f;
+    }
+    in.braking = (pMainDB->pedal_node->BIOPS > BRAKE_PEDAL_THRESHOLD);
+
+    if (imu->frames != ImuFrames)
+    {
+        ImuFrames = imu->frames;
+        ImuAge = 0;
+    }
+    else if (ImuAge < INV_IMU_TIMEOUT)
+    {
+        ImuAge++;
+    }
+    in.accel = (float)imu->accel_x / 100;
+    in.accelValid = (ImuAge < INV_IMU_TIMEOUT);
+
+    PROF_BEGIN(PRF_ESTIMATOR);
+    est_Process(&in, &gains, &Estimate);
+    PROF_END(PRF_ESTIMATOR);
 }
 
 /**
  * @brief  Checks if all inverters have successfully initialized.
  * @param  None
  * @retval 1 if all inverters are initialized, 0 otherwise.
- * @note   This function verifies that all inverters have acknowledged the
- *         "InverterOn" command and are ready for operation.
+ * @note   This function verifies that the startup sequencers of all inverters
+ *         finished the handshake and are ready for operation.
  */
 uint8_t inv_CheckInit()
 {
-    inverter_t* pInverters = pMainDB->vcu_node->inverters;
-    for (int i = 0; i < 4; ++i) {
-        if (pInverters[i].AMK_Status.AMK_bQuitInverterOn != 1 ||
-            pInverters[i].AMK_Status.AMK_bInverterOn != 1) {
-            return 0;
-        }
+    if (inv_ReadyCount() < 4) {
+        return 0;
     }
-    printf("Inverters Init  Succeeded\r\n");
+    LOG("Inverters Init  Succeeded");
     return 1;
 }
 
@@ -175,14 +569,17 @@ uint8_t inv_CheckInit()
  * @retval None
  * @note   This function implements a state machine for hard braking (BPPC).
  *         It commands zero torque if the gas and brake pedals are pressed
- *         simultaneously (Hard Brake state). Otherwise, it sends normal torque
- *         commands based on the gas pedal position.
+ *         simultaneously (Hard Brake state). Otherwise, it sends the regen torques
+ *         while the driver brakes (rg_enable) or normal torque commands based on the gas
+ *         pedal position, as per-wheel torques when torque vectoring, traction control,
+ *         the power limiter or a pedal map other than the linear one is enabled.
  */
 void inv_DrivingRoutine()
 {   
     uint16_t Gas_Value = pMainDB->pedal_node->gas_value;
     uint16_t Brake_Value = pMainDB->pedal_node->brake_value;
-    uint8_t* counter = &pMainDB->vcu_node->counters.hard_brake;
+    uint16_t* counter = &pMainDB->vcu_node->counters.hard_brake;
+    params_t* params = &pMainDB->vcu_node->params;
 
     
     // --- Hard Brake (BPPC) State Machine ---
@@ -190,12 +587,12 @@ void inv_DrivingRoutine()
     if (BPPC) // Currently in Hard Brake state
     {
         // Condition to exit Hard Brake state: Gas pedal is released
-        if (Gas_Value <= HB_GAS_LOW_VAL)
+        if (Gas_Value <= params->hb_gas_low)
         {
             (*counter)++;
             if ((*counter) >= HB_EXIT_TIMEOUT)
             {
-                printf("Hard Brake Released \r\n");
+                LOG("Hard Brake Released");
                 BPPC = 0;
                 (*counter) = 0;
             }
@@ -205,26 +602,40 @@ void inv_DrivingRoutine()
             (*counter) = 0;
         }
         // While in Hard Brake state or during exit timeout, command zero torque
-        inv_SetZeroTorque(1000, -1000);
+        inv_SetZeroTorque(params->pos_torque_limit, params->neg_torque_limit);
     }
     else // Not in Hard Brake state
     {
         // Condition to enter Hard Brake state: Gas and Brake pedals pressed simultaneously
-        if (Gas_Value >= HB_GAS_HIGH_VAL && Brake_Value >= HB_BRAKE_HIGH_VAL)
+        if (Gas_Value >= params->hb_gas_high && Brake_Value >= params->hb_brake_high)
         {
             (*counter)++;
             if ((*counter) >= HB_ENTRY_TIMEOUT)
             {
-                printf("Hard Brake Detected \r\n");
+                LOG("Hard Brake Detected");
                 BPPC = 1;
+                tc_Reset();
+                rg_Reset();
                 (*counter) = 0;
-                inv_SetZeroTorque(1000, -1000); // Immediately cut torque
+                inv_SetZeroTorque(params->pos_torque_limit, params->neg_torque_limit); // Immediately cut torque
             }
         }
         else // Normal driving condition
         {
             (*counter) = 0;
-            InvertersInitFC(); // Send torque based on gas value
+            if (params->rg_enable && inv_RegenControl())
+            {
+                // Braking on the motors
+            }
+            else if (params->tv_enable || params->tc_enable || params->pl_enable || lc_IsActive() ||
+                     params->pm_mode != PM_LINEAR)
+            {
+                inv_TorqueControl(); // Per-wheel torque from gas value and steering
+            }
+            else
+            {
+                InvertersInitFC(); // Send velocity based on gas value
+            }
         }
     }
     
@@ -234,14 +645,15 @@ void inv_DrivingRoutine()
  * @brief  Sends an error reset command to all inverters.
  * @param  None
  * @retval None
- * @note   This function sets the "bErrorReset" bit in the setpoint messages for
- *         all inverters and commands zero torque to attempt to clear any existing faults.
+ * @note   This function commands zero torque and gives every sequencer a new set of
+ *         retries: an inverter that gave up restarts its handshake with an error
+ *         reset, the others keep their state.
  */
 void inv_set_ErrorReset()
 {
+    inv_SetZeroTorque(0,0);
     for (int i=0; i<4; i++){
-        inv_SetZeroTorque(0,0);
-        INV_Setpoints_msgs[i].data[1] |= bErrorReset;
+        amk_Reset(&Amk[i]);
     }
 }
 
@@ -249,16 +661,18 @@ void inv_set_ErrorReset()
  * @brief  Checks for error flags from the inverters.
  * @param  None
  * @retval None
- * @note   This function checks the error status bit of the inverters. If an error
- *         is detected, it sets the system error code to indicate an inverter
- *         communication/fault error.
+ * @note   An inverter error is reset by the sequencer of that inverter alone. Only an
+ *         inverter whose retries are used up (AMK_ST_FAULT) sets the system error code
+ *         to indicate an inverter communication/fault error. The automatic reset is only
+ *         safe before R2D: in Stage 3 an inverter leaving AMK_ST_READY posts EV_INV_LOST
+ *         (inv_Sequence) and the FSM goes back to Stage 2 with zero torque.
  */
 void inv_CheckInvertersError()
 {
     uint16_t* pSystemError = &pMainDB->vcu_node->error_group.system_error;
     uint8_t reset_indicator = 0;
-    for (int i=0; i<2; i++){
-    reset_indicator |= pMainDB->vcu_node->inverters[i].AMK_Status.AMK_bError;
+    for (int i=0; i<4; i++){
+        reset_indicator |= (Amk[i].state == AMK_ST_FAULT);
     }
     if(reset_indicator){
         (*pSystemError) = INV_COMMUNICTION_ERROR;
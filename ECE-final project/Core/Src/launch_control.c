@@ -0,0 +1,87 @@
+#include "launch_control.h"
+
+// Launch control: Torque cap and slip target from standstill
+
+/* =============================== Global Variables =============================== */
+static float32_t RpmToSpeed;
+static float32_t Time = 0.0f;      // Since lc_Start [s]
+static uint8_t Active = 0;
+static uint8_t Done = 0;           // Exit speed reached
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Initialize the launch control
+ */
+void lc_Init(void)
+{
+    RpmToSpeed = 2.0f * PI / 60.0f / TV_GEAR_RATIO * TV_WHEEL_RADIUS;
+    lc_Stop();
+}
+
+/**
+ * @brief Start a launch, the launch time starts at the next lc_Process
+ */
+void lc_Start(void)
+{
+    Time = 0.0f;
+    Done = 0;
+    Active = 1;
+}
+
+/**
+ * @brief Stop the launch, the torque path goes back to the driver request
+ */
+void lc_Stop(void)
+{
+    Active = 0;
+    Done = 0;
+}
+
+/**
+ * @brief Check if a launch is running
+ */
+uint8_t lc_IsActive(void)
+{
+    return Active;
+}
+
+/**
+ * @brief Check if the launch reached its exit speed
+ * @note  Polled by the FSM to hand over to normal driving.
+ */
+uint8_t lc_IsDone(void)
+{
+    return Done;
+}
+
+/**
+ * @brief Run one step of the launch
+ * @param in    Motor speeds
+ * @param gains Torque scale, slip target and exit speed
+ * @param out   Torque scale, slip target, speed and launch time
+ * @note  The torque scale caps the driver request, the slip target replaces the one of the
+ *        traction control for the launch: the slip control keeps the wheels at the grip
+ *        peak. Both are constant over the launch, time based torque and slip profiles
+ *        were slower on the host "lc" scenario (Tools/vehicle_host.c) than the slip
+ *        control alone. The speed is the slowest wheel, the others may slip.
+ *        Call every LC_DT while active.
+ */
+void lc_Process(const lc_input_t* in, const lc_gains_t* gains, lc_output_t* out)
+{
+    float32_t slowest = 0.0f;
+
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        float32_t w = in->motorSpeed[i] * RpmToSpeed;
+        if (i == 0 || w < slowest) slowest = w;
+    }
+
+    out->torqueScale = gains->torqueScale;
+    out->slipTarget = gains->slipTarget;
+    out->speed = slowest;
+    out->time = Time;
+
+    if (slowest >= gains->exitSpeed) Done = 1;
+    Time += LC_DT;
+}
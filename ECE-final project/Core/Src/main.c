@@ -49,7 +49,6 @@ TIM_HandleTypeDef htim6;
 /* USER CODE BEGIN PV */
 handler_set_t handlers = {0};
 size_t RxQueueSize =128 ;
-uint8_t flag = 0 ;
 can_message_t msg = {0x100,{0}};
 /* USER CODE END PV */
 
@@ -109,7 +108,7 @@ int main(void)
   PlatformInit(&handlers,RxQueueSize);
   FSM_Init();
   memset(&msg.data,0x22, sizeof(msg.data)); // Initialize data with 0x22
-  HAL_TIM_Base_Start_IT(&htim6);
+  sch_Start(&htim6); // Base tick of the task scheduler (SCH_TICK_US)
   HAL_GPIO_WritePin(GPIOB, GPIO_PIN_8, GPIO_PIN_RESET);
 
   
@@ -120,12 +119,15 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-    if(flag)
-    {
-      flag = 0;
-      FSM();
-    }
-    plt_CanProcessRxMsgs();
+    uint8_t busy = sch_Run(); // Tasks released since the last loop (FSM.c task table)
+
+    // Background work between the ticks
+    log_Process();
+    sh_Process();
+    #ifdef HAL_SPI_MODULE_ENABLED
+    bbx_Process();
+    #endif
+    PROF_LOOP(busy); // CPU load estimate
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -403,10 +405,7 @@ static void MX_GPIO_Init(void)
 /* USER CODE BEGIN 4 */
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
-  if(htim->Instance == TIM6)
-  {
-    flag = 1;
-  }
+  sch_Tick(htim);
 }
 /* USER CODE END 4 */
 
@@ -23,32 +23,21 @@ void opr_Init()
   * @brief  Controls the stage indicator LEDs.
   * @param  stage The current FSM stage
   * @note   This function turns on the LED corresponding to the current stage and turns off the others.
+  *         Each LED is written once, so calling it again does not glitch the lit LED. In Stage 2.5
+  *         the Stage 2 LED toggles, call it periodically to blink.
 */
 void opr_Stage_Leds(Stage_t stage)
 {
-    // Turn off all stage LEDs first
-    HAL_GPIO_WritePin(STAGE1_LED_GROUP, STAGE1_LED_PIN, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(STAGE2_LED_GROUP, STAGE2_LED_PIN, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(STAGE3_LED_GROUP, STAGE3_LED_PIN, GPIO_PIN_RESET);
-
-    // Turn on the selected stage LED
-    switch(stage) {
-        case Stage1:
-            HAL_GPIO_WritePin(STAGE1_LED_GROUP, STAGE1_LED_PIN, GPIO_PIN_SET);
-            break;
-        case Stage2:
-            HAL_GPIO_WritePin(STAGE2_LED_GROUP, STAGE2_LED_PIN, GPIO_PIN_SET);
-            break;
-        case Stage2half:
-            HAL_GPIO_TogglePin(STAGE2_LED_GROUP, STAGE2_LED_PIN); // Toggle Stage 2 LED for 2half stage
-            break;
-        case Stage3:
-            HAL_GPIO_WritePin(STAGE3_LED_GROUP, STAGE3_LED_PIN, GPIO_PIN_SET);
-            break;
-        default:
-            // Do nothing if invalid stage
-            break;
+    HAL_GPIO_WritePin(STAGE1_LED_GROUP, STAGE1_LED_PIN, (stage == Stage1) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+    if(stage == Stage2half)
+    {
+        HAL_GPIO_TogglePin(STAGE2_LED_GROUP, STAGE2_LED_PIN); // Toggle Stage 2 LED for 2half stage
+    }
+    else
+    {
+        HAL_GPIO_WritePin(STAGE2_LED_GROUP, STAGE2_LED_PIN, (stage == Stage2) ? GPIO_PIN_SET : GPIO_PIN_RESET);
     }
+    HAL_GPIO_WritePin(STAGE3_LED_GROUP, STAGE3_LED_PIN, (stage == Stage3) ? GPIO_PIN_SET : GPIO_PIN_RESET);
 }
 
 
@@ -80,6 +69,16 @@ void opr_Buzzer()
     }
 }
 
+/**
+  * @brief  Stops the buzzer.
+  * @note   Used when Stage 3 is left before the buzzer timed out.
+*/
+void opr_BuzzerStop()
+{
+    plt_StopPWM(BUZZER_TIMER, BUZZER_TIMER_CH);
+    pMainDB->vcu_node->counters.buzzer_counter = BUZZER_STOP_VAL;
+}
+
 /**
   * @brief  Checks if critical sensors are uncalibrated.
   * @retval 1 if all sensors are calibrated, 0 otherwise.
@@ -96,6 +95,13 @@ uint8_t opr_SensorsCheck()
         (*pSystemError) = SENSORS_NOT_CALIBRATED_ERROR;
         return 0 ;
     }
+    #ifdef HAL_ADC_MODULE_ENABLED
+    if(!cal_IsValid()) // On-board pedal sensors need a calibration record from flash
+    {
+        (*pSystemError) = SENSORS_NOT_CALIBRATED_ERROR;
+        return 0 ;
+    }
+    #endif
     return 1;
 }
 
@@ -206,4 +212,25 @@ void opr_BrakeLight()
     {
         HAL_GPIO_WritePin(BRAKE_LIGHT_GROUP,BRAKE_LIGHT_PIN,RESET);
     }
-}
\ No newline at end of file
+}
+
+/**
+  * @brief  Sends the vehicle status frame to the dashboard.
+  * @note   Byte 0 is the FSM stage, byte 1 the status bits (DASH_THERMAL_WARNING), bytes 2..5
+  *         the thermal factor of each motor in %. Sent by the HMI task and at once on a new
+  *         thermal warning, a frame that does not fit in a TX mailbox is dropped, the next
+  *         one follows within FSM_HMI_PERIOD_MS.
+*/
+void opr_DashboardStatus(void)
+{
+    can_message_t msg = {VCU_STATUS_ID, {0}};
+    vcu_node_t* vcu = pMainDB->vcu_node;
+
+    msg.data[0] = (uint8_t)vcu->fsm_stage;
+    msg.data[1] = vcu->thermal_warning ? DASH_THERMAL_WARNING : 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        msg.data[2 + i] = vcu->thermal_derate[i];
+    }
+    (void)plt_CanSendMsg(DASH_STATUS_CAN, &msg);
+}
@@ -0,0 +1,110 @@
+#include "pedal_map.h"
+
+// Pedal map: Gas and vehicle speed to the driver torque request, one map per driver mode
+
+/* =============================== Global Variables =============================== */
+
+// Share of the peak driver torque (0..1), rows: speed 0, 5 .. 30 m/s, columns: gas 0, 10
+// .. 100 %. In flash, tuning the drivability is changing these tables.
+static const float32_t PmMaps[PM_NUM_MODES][PM_SPEED_POINTS * PM_PEDAL_POINTS] = {
+    [PM_LINEAR] = {
+        0.00f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f,
+        0.00f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f,
+        0.00f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f,
+        0.00f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f,
+        0.00f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f,
+        0.00f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f,
+        0.00f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f
+    },
+    [PM_RAIN] = {
+        0.00f, 0.01f, 0.03f, 0.07f, 0.10f, 0.15f, 0.20f, 0.25f, 0.31f, 0.38f, 0.45f,
+        0.00f, 0.01f, 0.04f, 0.07f, 0.12f, 0.17f, 0.23f, 0.29f, 0.36f, 0.43f, 0.51f,
+        0.00f, 0.02f, 0.05f, 0.09f, 0.14f, 0.20f, 0.26f, 0.34f, 0.42f, 0.51f, 0.60f,
+        0.00f, 0.02f, 0.05f, 0.09f, 0.14f, 0.20f, 0.26f, 0.34f, 0.42f, 0.51f, 0.60f,
+        0.00f, 0.02f, 0.05f, 0.09f, 0.14f, 0.20f, 0.26f, 0.34f, 0.42f, 0.51f, 0.60f,
+        0.00f, 0.02f, 0.05f, 0.09f, 0.14f, 0.20f, 0.26f, 0.34f, 0.42f, 0.51f, 0.60f,
+        0.00f, 0.02f, 0.05f, 0.09f, 0.14f, 0.20f, 0.26f, 0.34f, 0.42f, 0.51f, 0.60f
+    },
+    [PM_ENDURANCE] = {
+        0.00f, 0.04f, 0.09f, 0.16f, 0.23f, 0.30f, 0.39f, 0.47f, 0.56f, 0.65f, 0.75f,
+        0.00f, 0.04f, 0.09f, 0.16f, 0.23f, 0.30f, 0.39f, 0.47f, 0.56f, 0.65f, 0.75f,
+        0.00f, 0.04f, 0.09f, 0.16f, 0.23f, 0.30f, 0.39f, 0.47f, 0.56f, 0.65f, 0.75f,
+        0.00f, 0.04f, 0.09f, 0.16f, 0.23f, 0.30f, 0.39f, 0.47f, 0.56f, 0.65f, 0.75f,
+        0.00f, 0.03f, 0.08f, 0.14f, 0.21f, 0.27f, 0.35f, 0.42f, 0.51f, 0.59f, 0.68f,
+        0.00f, 0.03f, 0.07f, 0.13f, 0.18f, 0.24f, 0.31f, 0.38f, 0.45f, 0.52f, 0.60f,
+        0.00f, 0.03f, 0.06f, 0.11f, 0.16f, 0.21f, 0.27f, 0.33f, 0.39f, 0.46f, 0.52f
+    },
+    [PM_ACCELERATION] = {
+        0.00f, 0.12f, 0.25f, 0.38f, 0.50f, 0.62f, 0.75f, 0.88f, 1.00f, 1.00f, 1.00f,
+        0.00f, 0.12f, 0.25f, 0.38f, 0.50f, 0.62f, 0.75f, 0.88f, 1.00f, 1.00f, 1.00f,
+        0.00f, 0.12f, 0.25f, 0.38f, 0.50f, 0.62f, 0.75f, 0.88f, 1.00f, 1.00f, 1.00f,
+        0.00f, 0.12f, 0.25f, 0.38f, 0.50f, 0.62f, 0.75f, 0.88f, 1.00f, 1.00f, 1.00f,
+        0.00f, 0.12f, 0.25f, 0.38f, 0.50f, 0.62f, 0.75f, 0.88f, 1.00f, 1.00f, 1.00f,
+        0.00f, 0.12f, 0.25f, 0.38f, 0.50f, 0.62f, 0.75f, 0.88f, 1.00f, 1.00f, 1.00f,
+        0.00f, 0.12f, 0.25f, 0.38f, 0.50f, 0.62f, 0.75f, 0.88f, 1.00f, 1.00f, 1.00f
+    }
+};
+
+// The CMSIS instance takes a non-const table, the interpolation only reads it
+static arm_bilinear_interp_instance_f32 PmInterp[PM_NUM_MODES];
+static PmMode_t Mode = PM_LINEAR;     // Mode of the map in use
+static float32_t RpmToSpeed;
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Initialize the pedal maps
+ */
+void pm_Init(void)
+{
+    RpmToSpeed = 2.0f * PI / 60.0f / TV_GEAR_RATIO * TV_WHEEL_RADIUS;
+    for (uint8_t i = 0; i < PM_NUM_MODES; i++)
+    {
+        PmInterp[i].numRows = PM_SPEED_POINTS;
+        PmInterp[i].numCols = PM_PEDAL_POINTS;
+        PmInterp[i].pData = (float32_t*)PmMaps[i];
+    }
+    Mode = PM_LINEAR;
+}
+
+/**
+ * @brief Evaluate the map of the driver mode
+ * @param mode       Requested driver mode
+ * @param gas        Gas pedal [%]
+ * @param motorSpeed Motor speeds (inverter actual_speed) [rpm]
+ * @retval Share of the peak driver torque, 0..1
+ * @note  A mode change is taken over once the gas is below PM_SWITCH_PEDAL, switching
+ *        maps under load would step the torque. The vehicle speed is the mean wheel speed.
+ *        arm_bilinear_interp_f32 works on table indexes and returns 0 outside the table,
+ *        the inputs are clamped inside the last cell. Constant time, one cell lookup.
+ */
+float32_t pm_Process(PmMode_t mode, float32_t gas, const float32_t motorSpeed[TV_NUM_WHEELS])
+{
+    const float32_t maxX = (float32_t)(PM_PEDAL_POINTS - 1) - 1e-3f;
+    const float32_t maxY = (float32_t)(PM_SPEED_POINTS - 1) - 1e-3f;
+    float32_t speed = 0.0f;
+    float32_t x, y;
+
+    if (mode != Mode && mode < PM_NUM_MODES && gas < PM_SWITCH_PEDAL)
+    {
+        Mode = mode;
+    }
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        speed += 0.25f * motorSpeed[i] * RpmToSpeed;
+    }
+
+    x = gas / PM_PEDAL_STEP;
+    y = speed / PM_SPEED_STEP;
+    x = (x < 0.0f) ? 0.0f : (x > maxX) ? maxX : x;
+    y = (y < 0.0f) ? 0.0f : (y > maxY) ? maxY : y;
+    return arm_bilinear_interp_f32(&PmInterp[Mode], x, y);
+}
+
+/**
+ * @brief Get the driver mode of the map in use
+ */
+PmMode_t pm_GetMode(void)
+{
+    return Mode;
+}
@@ -0,0 +1,36 @@
+#include "power_limit.h"
+
+// Power limiter: Total electrical power of the inverters held below the rules limit
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Scale the driving torques to the allowed power
+ * @param in    Requested motor torques and motor speeds
+ * @param gains Limit and margin
+ * @param out   Motor torques and the limiter internals
+ * @note  Feed-forward only: the electrical power of the request is sum(T * w) / efficiency,
+ *        the driving torques are scaled so it meets limit - margin before the inverters
+ *        draw it. There is no feedback: no DC bus voltage and current are decoded, and the
+ *        inverter power (InvPower) is derived from the torque current with the same
+ *        efficiency, a loop on it would only correct against its own model. The margin
+ *        covers the efficiency error. Braking torques are not scaled. Call every PL_DT.
+ */
+void pl_Process(const pl_input_t* in, const pl_gains_t* gains, pl_output_t* out)
+{
+    out->request = 0.0f;
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        float32_t p = in->torque[i] * in->motorSpeed[i] * (2.0f * PI / 60.0f);
+        if (in->torque[i] > 0.0f && p > 0.0f) out->request += p / PL_EFFICIENCY;
+    }
+
+    out->allowed = gains->limit - gains->margin;
+    if (out->allowed < 0.0f) out->allowed = 0.0f;
+
+    out->scale = (out->request > out->allowed) ? out->allowed / out->request : 1.0f;
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        out->torque[i] = (in->torque[i] > 0.0f) ? in->torque[i] * out->scale : in->torque[i];
+    }
+}
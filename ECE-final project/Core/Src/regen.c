@@ -0,0 +1,86 @@
+#include "regen.h"
+
+// Regen: Brake pedal to negative motor torque, blended with the hydraulic brake
+
+/* =============================== Global Variables =============================== */
+static float32_t Torque[TV_NUM_WHEELS];   // Regen torque applied, positive magnitude [Nm]
+static float32_t RpmToSpeed;
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Linear taper of a limit
+ * @retval 1 at or below start, 0 at or above max, linear in between
+ */
+static float32_t rg_Taper(float32_t x, float32_t start, float32_t max)
+{
+    if (x <= start) return 1.0f;
+    if (x >= max || max <= start) return 0.0f;
+    return (max - x) / (max - start);
+}
+
+/**
+ * @brief Initialize the regenerative braking
+ */
+void rg_Init(void)
+{
+    RpmToSpeed = 2.0f * PI / 60.0f / TV_GEAR_RATIO * TV_WHEEL_RADIUS;
+    rg_Reset();
+}
+
+/**
+ * @brief Drop the applied regen torque at once
+ * @note  For the hard brake, where the motors must not brake either.
+ */
+void rg_Reset(void)
+{
+    memset(Torque, 0, sizeof(Torque));
+}
+
+/**
+ * @brief Compute the regen torque of each motor
+ * @param in    Brake pedal, pack voltage, inverter temperatures and motor speeds
+ * @param gains Pedal map, axle split, limits and rate
+ * @param out   Motor torques (negative), pedal request and speed
+ * @note  The hydraulic brake is not by wire, so the regen acts in parallel to it: the
+ *        pedal between pedalStart and pedalFull maps linearly to the regen torque, split
+ *        between the axles like the hydraulic brake so the balance does not move. The
+ *        pack voltage limit protects the cells of a full pack, the temperature limit is
+ *        per wheel. It fails closed: a pack voltage of 0 (not measured) gives no regen. Below RG_FADE_SPEED the regen fades out to RG_MIN_SPEED, the motors
+ *        cannot hold a car at standstill. Every torque change, including the release of the
+ *        pedal, is rate limited to gains->rate so the driver feels no step between regen
+ *        and hydraulic braking. Call every RG_DT, also after the pedal was released until
+ *        the torques are back to 0.
+ */
+void rg_Process(const rg_input_t* in, const rg_gains_t* gains, rg_output_t* out)
+{
+    float32_t front = (gains->frontSplit < 0.0f) ? 0.0f : (gains->frontSplit > 1.0f) ? 1.0f : gains->frontSplit;
+    float32_t pedal;
+    float32_t limit;
+    float32_t step = gains->rate * RG_DT;
+
+    out->speed = 0.0f;
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        out->speed += 0.25f * in->motorSpeed[i] * RpmToSpeed;
+    }
+
+    pedal = 1.0f - rg_Taper(in->brake, gains->pedalStart, gains->pedalFull);
+    out->request = pedal * TV_NUM_WHEELS * gains->maxTorque;
+    limit = (1.0f - rg_Taper(out->speed, RG_MIN_SPEED, RG_FADE_SPEED)) *
+            rg_Taper(in->packVoltage, gains->voltStart, gains->voltMax);
+    if (in->packVoltage <= 0.0f) limit = 0.0f; // No measurement, the taper would allow full regen
+
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        float32_t share = (i == TV_FL || i == TV_FR) ? front : 1.0f - front;
+        float32_t target = 0.5f * share * out->request * limit *
+                           rg_Taper(in->temperature[i], gains->tempStart, gains->tempMax);
+
+        if (target > TV_MAX_MOTOR_TORQUE) target = TV_MAX_MOTOR_TORQUE;
+        if (target > Torque[i] + step) target = Torque[i] + step;
+        if (target < Torque[i] - step) target = Torque[i] - step;
+        Torque[i] = target;
+        out->torque[i] = -Torque[i];
+    }
+}
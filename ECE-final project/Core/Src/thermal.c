@@ -0,0 +1,120 @@
+#include "thermal.h"
+
+// Thermal manager: Torque derating from the predicted motor and inverter temperatures
+
+/* =============================== Global Variables =============================== */
+
+// Derating curves, torque limit factor over temperature, in flash. They start below the
+// AMK internal derating so the car slows down gradually instead of hitting the inverter
+// cutback. The last point keeps some torque to drive back to the pits.
+static const float32_t ThMotorCurve[TH_CURVE_POINTS] = {   // 100 .. 140 degC
+    1.00f, 0.95f, 0.88f, 0.78f, 0.66f, 0.53f, 0.40f, 0.28f, 0.15f
+};
+static const float32_t ThPlateCurve[TH_CURVE_POINTS] = {   // 45 .. 65 degC
+    1.00f, 0.95f, 0.88f, 0.78f, 0.66f, 0.53f, 0.40f, 0.28f, 0.15f
+};
+static const float32_t ThIgbtCurve[TH_CURVE_POINTS] = {    // 70 .. 90 degC
+    1.00f, 0.95f, 0.88f, 0.78f, 0.66f, 0.53f, 0.40f, 0.28f, 0.15f
+};
+
+// The CMSIS instance takes a non-const table, the interpolation only reads it
+static arm_linear_interp_instance_f32 ThCurves[TH_NUM_SOURCES] = {
+    [TH_MOTOR] = {TH_CURVE_POINTS, 100.0f, 5.0f, (float32_t*)ThMotorCurve},
+    [TH_PLATE] = {TH_CURVE_POINTS, 45.0f,  2.5f, (float32_t*)ThPlateCurve},
+    [TH_IGBT]  = {TH_CURVE_POINTS, 70.0f,  2.5f, (float32_t*)ThIgbtCurve},
+};
+
+static float32_t Last[TV_NUM_WHEELS][TH_NUM_SOURCES];   // Temperatures of the last call [degC]
+static float32_t Rate[TV_NUM_WHEELS][TH_NUM_SOURCES];   // Filtered rates [degC/s]
+static float32_t Factor[TV_NUM_WHEELS];
+static uint8_t Seeded[TV_NUM_WHEELS];                   // Last holds a received value
+static uint8_t Rejects[TV_NUM_WHEELS][TH_NUM_SOURCES];  // Implausible steps in a row
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Initialize the thermal manager
+ */
+void th_Init(void)
+{
+    memset(Rate, 0, sizeof(Rate));
+    memset(Seeded, 0, sizeof(Seeded));
+    memset(Rejects, 0, sizeof(Rejects));
+    for (uint8_t w = 0; w < TV_NUM_WHEELS; w++)
+    {
+        Factor[w] = 1.0f;
+    }
+}
+
+/**
+ * @brief Compute the torque limit factor of each wheel
+ * @param in    Motor, cold plate and IGBT temperature of each wheel
+ * @param gains Prediction horizon, recovery rate and warning level
+ * @param out   Factors, predicted temperatures and the warning
+ * @note  First order prediction: each temperature is extrapolated over the horizon with
+ *        its filtered rate (only when rising), the factor of a wheel is the lowest of its
+ *        three curves at the predicted temperatures. A heating component is derated before
+ *        it reaches the curve, so the torque falls slowly instead of in steps. Factors fall
+ *        at once and rise at gains->recovery, a wheel at the edge of a curve does not
+ *        oscillate. A wheel is held at its factor until its first temperatures arrive
+ *        (in->valid), then the rates start from that value, not from 0 degC. A step above
+ *        TH_MAX_STEP is a lost or stale frame: the last value is kept, unless the step stays
+ *        for TH_MAX_REJECTS calls, then it is taken as the new start. Call every TH_DT.
+ */
+void th_Process(const th_input_t* in, const th_gains_t* gains, th_output_t* out)
+{
+    float32_t k = TH_DT / (TH_RATE_TAU + TH_DT);
+
+    out->warning = 0;
+    for (uint8_t w = 0; w < TV_NUM_WHEELS; w++)
+    {
+        float32_t factor = 1.0f;
+
+        if (!in->valid[w])
+        {
+            // No frame yet: hold the factor, nothing to predict from
+            Seeded[w] = 0;
+            memcpy(out->predicted[w], in->temperature[w], sizeof(out->predicted[w]));
+            out->factor[w] = Factor[w];
+            if (Factor[w] < gains->warning) out->warning = 1;
+            continue;
+        }
+        if (!Seeded[w])
+        {
+            memcpy(Last[w], in->temperature[w], sizeof(Last[w]));
+            memset(Rate[w], 0, sizeof(Rate[w]));
+            memset(Rejects[w], 0, sizeof(Rejects[w]));
+            Seeded[w] = 1;
+        }
+
+        for (uint8_t s = 0; s < TH_NUM_SOURCES; s++)
+        {
+            float32_t t = in->temperature[w][s];
+            float32_t f;
+
+            if (fabsf(t - Last[w][s]) > TH_MAX_STEP && ++Rejects[w][s] < TH_MAX_REJECTS)
+            {
+                t = Last[w][s];
+            }
+            else
+            {
+                if (Rejects[w][s] >= TH_MAX_REJECTS)
+                {
+                    Last[w][s] = t;        // The step stayed, start again from the new value
+                    Rate[w][s] = 0.0f;
+                }
+                Rejects[w][s] = 0;
+                Rate[w][s] += k * ((t - Last[w][s]) / TH_DT - Rate[w][s]);
+                Last[w][s] = t;
+            }
+            out->predicted[w][s] = t + ((Rate[w][s] > 0.0f) ? Rate[w][s] * gains->horizon : 0.0f);
+            f = arm_linear_interp_f32(&ThCurves[s], out->predicted[w][s]);
+            if (f < factor) factor = f;
+        }
+
+        if (factor > Factor[w] + gains->recovery * TH_DT) factor = Factor[w] + gains->recovery * TH_DT;
+        Factor[w] = factor;
+        out->factor[w] = factor;
+        if (factor < gains->warning) out->warning = 1;
+    }
+}
@@ -0,0 +1,109 @@
+#include "traction_control.h"
+
+// Traction control: Per-wheel slip control with the CMSIS-DSP PID
+
+/* =============================== Global Variables =============================== */
+static arm_pid_instance_f32 Pid[TV_NUM_WHEELS];
+static tc_gains_t Gains;                         // Gains the PIDs were initialized with
+static float32_t SpeedRef = 0.0f;                // Vehicle speed reference [m/s]
+static float32_t RpmToSpeed;
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Load the gains into the PIDs
+ * @param reset 1 to clear the PID states too
+ * @note  Ki and Kd are per second, CMSIS-DSP wants them per sample.
+ */
+static void tc_LoadGains(const tc_gains_t* gains, int32_t reset)
+{
+    Gains = *gains;
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        Pid[i].Kp = gains->kp;
+        Pid[i].Ki = gains->ki * TC_DT;
+        Pid[i].Kd = gains->kd / TC_DT;
+        arm_pid_init_f32(&Pid[i], reset);
+    }
+}
+
+/**
+ * @brief Initialize the traction control
+ */
+void tc_Init(void)
+{
+    const tc_gains_t none = {0};
+
+    RpmToSpeed = 2.0f * PI / 60.0f / TV_GEAR_RATIO * TV_WHEEL_RADIUS;
+    tc_LoadGains(&none, 1);
+    SpeedRef = 0.0f;
+}
+
+/**
+ * @brief Clear the PID states and the speed reference
+ * @note  Call when the torque path was not used for a while (hard brake, other stages).
+ */
+void tc_Reset(void)
+{
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        arm_pid_reset_f32(&Pid[i]);
+    }
+    SpeedRef = 0.0f;
+}
+
+/**
+ * @brief Cut the torque of the wheels that slip above the target
+ * @param in    Requested motor torques, motor speeds and the estimated speed
+ * @param gains Slip target and PID gains
+ * @param out   Motor torques, slips and the speed reference
+ * @note  The speed reference is the state estimator speed when in->speedValid. Without
+ *        it, all four wheels are driven, so the reference is the slowest wheel, rate
+ *        limited to gains->accelLimit so four spinning wheels cannot drag it up. The limit
+ *        must follow the grip (lower in the rain), above the grip the reference runs away
+ *        when all wheels spin together. The PIDs run in
+ *        the CMSIS incremental form, their output (the cut) is clamped to [0, request] and
+ *        written back to the PID state, which is the anti-windup: the integral cannot build
+ *        up while the wheel grips or while the whole request is cut. Wheels without a
+ *        positive request are not controlled. Call every TC_DT.
+ */
+void tc_Process(const tc_input_t* in, const tc_gains_t* gains, tc_output_t* out)
+{
+    float32_t w[TV_NUM_WHEELS];
+    float32_t slowest = 0.0f;
+
+    if (memcmp(gains, &Gains, sizeof(tc_gains_t)) != 0)
+    {
+        tc_LoadGains(gains, 0);  // Changed from the shell, keep the states
+    }
+
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        w[i] = in->motorSpeed[i] * RpmToSpeed;
+        if (i == 0 || w[i] < slowest) slowest = w[i];
+    }
+    if (in->speedValid) SpeedRef = in->speed;
+    else SpeedRef = (slowest < SpeedRef + gains->accelLimit * TC_DT) ? slowest : SpeedRef + gains->accelLimit * TC_DT;
+    if (SpeedRef < 0.0f) SpeedRef = 0.0f;
+    out->speed = SpeedRef;
+
+    for (uint8_t i = 0; i < TV_NUM_WHEELS; i++)
+    {
+        float32_t request = in->torque[i];
+        float32_t cut;
+
+        out->slip[i] = (w[i] - SpeedRef) / ((SpeedRef > TC_MIN_SPEED) ? SpeedRef : TC_MIN_SPEED);
+        if (request <= 0.0f)
+        {
+            arm_pid_reset_f32(&Pid[i]);
+            out->torque[i] = request;
+            continue;
+        }
+
+        cut = arm_pid_f32(&Pid[i], out->slip[i] - gains->slipTarget);
+        if (cut < 0.0f) cut = 0.0f;
+        if (cut > request) cut = request;
+        Pid[i].state[2] = cut;   // Anti-windup
+        out->torque[i] = request - cut;
+    }
+}
@@ -4,6 +4,9 @@
 
 /* =============================== Includes ======================================= */
 #include "database.h"
+#include "filter.h"
+#include "calibration.h"
+#include "event.h"
 
 /* ========================== Function Declarations =============================== */
 void DbSetFunctionsInit();
@@ -26,6 +29,8 @@ void setStage2Parameters(uint8_t* data);
 void setStage3Parameters(uint8_t* data);
 void setBmsParameters(uint8_t* data);
 void setResParameters(uint8_t* data);
+void setImuParameters(uint8_t* data);
+void setInternalSensorsParameters(const uint16_t* values, uint32_t timestamp);
 
 /* ==========================  Defines =============================== */
 #define MAX_VALUE_APPS 100
@@ -37,4 +42,9 @@ void setResParameters(uint8_t* data);
 #define MAX_VALUE_BIOPS 100
 #define MIN_VALUE_BIOPS 0
 
+// AMK actual values 1 to electrical power (actual_power)
+#define AMK_CURRENT_SCALE (107.2f / 16384) // Torque current per LSB [A], 0x4000 is the converter peak current
+#define AMK_MOTOR_KT 0.26f                 // Motor torque constant [Nm/A]
+#define AMK_EFFICIENCY 0.92f               // Motor and inverter efficiency, DC side to shaft
+
 #endif // DBSETFUNCTIONS_H
\ No newline at end of file
@@ -2,12 +2,9 @@
 #define ADC_H
 /* =============================== Includes ======================================= */
 #include "platform.h"
+#include "adc_kernels.h"
 
 #ifdef HAL_ADC_MODULE_ENABLED
-#ifdef HAL_CAN_MODULE_ENABLED //because we need the CAN message to send the ADC data
-/* ========================== Function Declarations ============================ */
-void plt_AdcInit();
-void plt_AdcProcessData(uint16_t *UF_Buffer, uint16_t Size);
 
 /* =============================== Defines =============================== */
 #define ADC1_NUM_SENSORS  3
@@ -26,6 +23,24 @@ void plt_AdcProcessData(uint16_t *UF_Buffer, uint16_t Size);
 #define ADC1_MIN_VALUE 0 // Minimum value for 12-bit ADC
 #define ADC2_MIN_VALUE 0 // Minimum value for 12-bit ADC
 #define ADC3_MIN_VALUE 0 // Minimum value for 12-bit ADC
-#endif
+
+#define ADC_MAX_SENSORS 3 // Largest ADCx_NUM_SENSORS, size of the mailbox values
+
+/* =============================== Structs =============================== */
+
+/**
+ * @brief ADC sample struct
+ * @note  Snapshot of an ADC mailbox returned by plt_AdcRead
+ */
+typedef struct{
+    uint16_t values[ADC_MAX_SENSORS]; // Averaged sensor values
+    uint32_t timestamp;               // HAL tick when the block was averaged
+    uint32_t sequence;                // Increments on every new block
+}adc_sample_t;
+
+/* ========================== Function Declarations ============================ */
+void plt_AdcInit();
+void plt_AdcProcessData(uint16_t *UF_Buffer, uint16_t Size);
+uint8_t plt_AdcRead(Adc_Module_t adc_module, adc_sample_t* pSample);
 #endif
 #endif // ADC_H
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef ADC_KERNELS_H
+#define ADC_KERNELS_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <string.h>
+
+// No HAL dependency: the averaging kernels of plt_AdcProcessData (adc.c), shared with the
+// host reference test and benchmark (Tools/adc_host.c). ADC_SIMD selects the __UADD16
+// kernel, set on cores with the DSP extension. The host defines it itself together with
+// a portable __UADD16 to check the SIMD lane layout.
+
+/* =============================== Defines ======================================= */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1) && !defined(ADC_SIMD)
+#define ADC_SIMD 1
+#endif
+
+#define ADC_SIMD_FLUSH_PAIRS 16 // 16 x 4095 still fits a 16-bit SIMD lane, flush the lanes after that
+
+/* =============================== Averaging Kernels =============================== */
+
+/**
+ * @brief Generic de-interleaving average for any number of channels
+ * @param buf        Pointer to the interleaved ADC buffer (ch0,ch1,..,chN-1,ch0,...)
+ * @param frames     Number of samples per channel in the buffer
+ * @param numSensors Number of interleaved channels
+ * @param avg        Output array of numSensors averages
+ * @note  Walks every channel with a fixed stride, so no modulo is needed per sample.
+ */
+static inline void adc_AverageStride(const uint16_t *buf, uint16_t frames, uint16_t numSensors, uint16_t *avg)
+{
+    for (uint16_t ch = 0; ch < numSensors; ++ch)
+    {
+        const uint16_t *p = &buf[ch];
+        uint32_t sum = 0;
+        for (uint16_t f = 0; f < frames; ++f)
+        {
+            sum += *p;
+            p += numSensors;
+        }
+        avg[ch] = (uint16_t)(sum / frames);
+    }
+}
+
+/**
+ * @brief 3-channel de-interleaving average using the Cortex-M4 SIMD instructions
+ * @param buf    Pointer to the interleaved ADC buffer (A,B,C,A,B,C,...), 4-byte aligned
+ * @param frames Number of samples per channel in the buffer
+ * @param avg    Output array of 3 averages
+ * @note  Two frames are 6 half-words = 3 words: [A0|B0] [C0|A1] [B1|C1].
+ *        Every word is added with __UADD16 into its own two-lane accumulator, so
+ *        each lane always collects the same channel. The 16-bit lanes are flushed
+ *        into 32-bit sums every ADC_SIMD_FLUSH_PAIRS iterations before they can overflow.
+ *        Without ADC_SIMD it falls back to adc_AverageStride.
+ */
+static inline void adc_Average3(const uint16_t *buf, uint16_t frames, uint16_t *avg)
+{
+#ifdef ADC_SIMD
+    const uint16_t *p = buf;
+    uint32_t sumA = 0, sumB = 0, sumC = 0;
+    uint16_t pairs = frames / 2U;
+
+    while (pairs > 0U)
+    {
+        uint16_t n = (pairs > ADC_SIMD_FLUSH_PAIRS) ? ADC_SIMD_FLUSH_PAIRS : pairs;
+        uint32_t acc0 = 0, acc1 = 0, acc2 = 0;
+        pairs -= n;
+        do
+        {
+            uint32_t w0, w1, w2;
+            memcpy(&w0, &p[0], sizeof(uint32_t)); // A(n)   | B(n)
+            memcpy(&w1, &p[2], sizeof(uint32_t)); // C(n)   | A(n+1)
+            memcpy(&w2, &p[4], sizeof(uint32_t)); // B(n+1) | C(n+1)
+            acc0 = __UADD16(acc0, w0);
+            acc1 = __UADD16(acc1, w1);
+            acc2 = __UADD16(acc2, w2);
+            p += 6;
+        } while (--n);
+
+        sumA += (acc0 & 0xFFFFU) + (acc1 >> 16);
+        sumB += (acc0 >> 16)     + (acc2 & 0xFFFFU);
+        sumC += (acc1 & 0xFFFFU) + (acc2 >> 16);
+    }
+
+    if (frames & 1U) // odd number of frames, one frame left over
+    {
+        sumA += p[0];
+        sumB += p[1];
+        sumC += p[2];
+    }
+
+    avg[0] = (uint16_t)(sumA / frames);
+    avg[1] = (uint16_t)(sumB / frames);
+    avg[2] = (uint16_t)(sumC / frames);
+#else
+    adc_AverageStride(buf, frames, 3U, avg);
+#endif
+}
+
+/**
+ * @brief Select the averaging kernel at compile time from the number of sensors
+ * @note  numSensors is always one of the ADCx_NUM_SENSORS constants, so the
+ *        unused branch is removed by the compiler.
+ */
+#define ADC_AVERAGE(numSensors, buf, frames, avg)                               \
+    (((numSensors) == 3U) ? adc_Average3((buf), (frames), (avg))                \
+                          : adc_AverageStride((buf), (frames), (numSensors), (avg)))
+
+#endif // ADC_KERNELS_H
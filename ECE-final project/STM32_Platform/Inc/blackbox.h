@@ -0,0 +1,60 @@
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+/* =============================== Includes ======================================= */
+#include "spi.h"
+#include "database.h"
+#include "norlog.h"
+
+#ifdef HAL_SPI_MODULE_ENABLED
+/* =============================== Defines ======================================= */
+#define BBX_SPI_CHANEL      Spi2          // Bus of the external NOR flash (master)
+#define BBX_CS_PORT         GPIOB         // Flash chip select
+#define BBX_CS_PIN          GPIO_PIN_12
+#define BBX_FLASH_SIZE      (16UL * 1024UL * 1024UL) // W25Q128 class flash
+#define BBX_SECTOR_SIZE     4096          // Erase sector (segment)
+#define BBX_PAGE_SIZE       256           // Program page
+#define BBX_READ_TIMEOUT    10            // Blocking read timeout [ms] (mount only)
+
+/**
+ * @brief Black box record types
+ * @note  Must match Tools/bbx_extract.py
+ */
+#define BBX_REC_SNAPSHOT    1             // bbx_snapshot_t, every FSM tick
+#define BBX_REC_CAN         2             // bbx_can_t, every received CAN frame
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief DB snapshot record struct
+ */
+typedef struct __attribute__((packed)){
+    uint8_t  stage;
+    uint8_t  r2d;
+    uint16_t system_error;
+    uint16_t gas;
+    uint16_t brake;
+    int16_t  steering;
+    uint16_t biops;
+    int16_t  speed[4];                    // rpm
+    int16_t  torque[4];                   // 0.1% Mn
+    int16_t  dc_bus_voltage;
+}bbx_snapshot_t;
+
+/**
+ * @brief CAN frame record struct
+ */
+typedef struct __attribute__((packed)){
+    uint32_t id;
+    uint8_t  data[8];
+}bbx_can_t;
+
+/* ========================== Function Declarations ============================ */
+uint8_t bbx_Init(void);
+void bbx_LogSnapshot(const database_t* db);
+void bbx_LogCan(const can_message_t* msg);
+void bbx_Process(void);
+void bbx_GetStats(nlog_stats_t* stats);
+
+#endif
+
+#endif // BLACKBOX_H
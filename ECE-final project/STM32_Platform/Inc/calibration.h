@@ -0,0 +1,100 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include "crc.h"
+
+// No HAL dependency: runs on the internal flash sector on the target (callbacks.c gives the
+// flash interface) and on a RAM region on the host (Tools/cal_host.c). The calibrated values
+// go to internal_sensors.calibrated in the DB, the pedal values the control uses still come
+// from the pedal node.
+
+/* =============================== Defines ======================================= */
+#define CAL_NUM_CHANNELS     3            // One calibration per on-board sensor (INTERNAL_SENSORS_NUM)
+#define CAL_OUTPUT_RANGE     100          // Calibrated output range (0..100 %), same scale as MAX_VALUE_APPS
+#define CAL_MIN_SPAN         200          // Minimum raw span between rest and full travel
+#define CAL_REST_TIME_MS     2000         // Time to average the released position
+#define CAL_FULL_TIME_MS     5000         // Time to search the fully pressed position
+#define CAL_MAGIC            0x43414C31U  // "CAL1"
+#define CAL_ERASED           0xFFFFFFFFU  // Magic of an erased record slot
+#define CAL_VERSION          1
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Calibration channels enum
+ * @note  Index of the ADC1 channel (same order as the ADC1 scan sequence)
+ */
+typedef enum{
+    CAL_APPS1 = 0,
+    CAL_APPS2 = 1,
+    CAL_BPPS  = 2
+}CalChannel_t;
+
+/**
+ * @brief Calibration capture state enum
+ */
+typedef enum{
+    CAL_IDLE = 0,
+    CAL_CAPTURE_REST,   // Pedals released, averaging the rest position
+    CAL_CAPTURE_FULL,   // Pedals pressed, searching the far end of the travel
+    CAL_DONE,
+    CAL_FAILED
+}CalState_t;
+
+/**
+ * @brief Calibration capture error enum
+ * @note  Why the last capture ended in CAL_FAILED
+ */
+typedef enum{
+    CAL_ERR_NONE = 0,
+    CAL_ERR_SPAN,       // A channel moved less than CAL_MIN_SPAN
+    CAL_ERR_FLASH,      // The record could not be written
+    CAL_ERR_ABORTED     // cal_AbortCapture
+}CalError_t;
+
+/**
+ * @brief Calibration record struct
+ * @note  Stored as is in flash. Records are appended in the calibration sector,
+ *        the last valid one is used, the sector is erased only when it is full.
+ */
+typedef struct{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sequence;
+    uint16_t rest[CAL_NUM_CHANNELS];   // Raw value with the pedal released
+    uint16_t full[CAL_NUM_CHANNELS];   // Raw value with the pedal fully pressed (may be below rest)
+    int32_t  scale[CAL_NUM_CHANNELS];  // Q16: (CAL_OUTPUT_RANGE << 16) / (full - rest)
+    uint16_t reserved;
+    uint16_t crc;                      // CRC-16 of all previous fields
+}cal_record_t;
+
+/**
+ * @brief Calibration flash interface struct
+ * @note  The record area is read through the memory mapped base pointer, erase and
+ *        program go through the function pointers (return 1 on success, 0 on failure).
+ *        program writes from the first field on, so a record with an erased magic
+ *        has no programmed field.
+ */
+typedef struct{
+    const uint8_t* base;
+    uint32_t size;
+    uint8_t (*erase)(void);
+    uint8_t (*program)(uint32_t offset, const uint8_t* data, uint32_t len);
+}cal_flash_t;
+
+/* ========================== Function Declarations ============================ */
+void cal_SetFlash(const cal_flash_t* flash);
+uint8_t cal_Init(void);
+uint8_t cal_IsValid(void);
+uint16_t cal_Apply(CalChannel_t channel, uint16_t raw);
+void cal_StartCapture(uint32_t now);
+void cal_AbortCapture(void);
+void cal_CaptureStep(const uint16_t* raw, uint32_t now);
+CalState_t cal_GetState(void);
+CalError_t cal_GetError(void);
+uint8_t cal_Save(void);
+const cal_record_t* cal_GetRecord(void);
+
+#endif // CALIBRATION_H
@@ -8,6 +8,12 @@
 #include "can.h"
 #include "adc.h"
 #include "tim.h"
+#include "flash.h"
+#include "logger.h"
+#include "shell.h"
+#include "blackbox.h"
+#include "scheduler.h"
+#include "profiler.h"
 //TODO: check if you can move this two verables to database.h
 extern uint8_t KL_Nodes[3];
 extern uint8_t FSM_stage;
@@ -17,6 +23,8 @@ void SpiRxCallback(spi_message_t *msg);
 void CanRxCallback(can_message_t *msg);
 void UartRxCallback(uart_message_t *msg);
 void SetCallbacks();
+void InternalSensorsUpdate(void);
+void ShellInit(void);
 void PlatformInit(handler_set_t *handlers,size_t RxQueueSize);
 
 #endif // CALLBACKS_H
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define CAN_H
 /* =============================== Includes ======================================= */
 #include "platform.h"
+#include "profiler.h"
 
 #ifdef HAL_CAN_MODULE_ENABLED
 /* ========================== Function Declarations ============================ */
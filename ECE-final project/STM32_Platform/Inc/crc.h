@@ -0,0 +1,17 @@
+#ifndef CRC_H
+#define CRC_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <stddef.h>
+
+// No HAL dependency, shared with the host tools.
+
+/*========================= CRC related definitions =========================*/
+
+#define CRC16_INIT 0xFFFF // CRC-16/CCITT-FALSE initial value
+
+/*========================= CRC related function prototypes =========================*/
+
+uint16_t Crc16_Calc(const uint8_t* data, size_t len, uint16_t crc);
+
+#endif // CRC_H
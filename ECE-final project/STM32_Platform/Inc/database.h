@@ -12,6 +12,8 @@
 
 /* =============================== Structs ======================================= */
 
+#define INTERNAL_SENSORS_NUM 3 // Number of on-board sensors sampled by ADC1
+
 /**
  * @brief Inverter Status struct.
  * @note This struct contain the status of the inverter that upsated by incoming CAN messages.
@@ -29,6 +31,19 @@ uint8_t AMK_bDerating;
 
 } AMK_Status_t;
 
+/**
+ * @brief Inverter setpoints struct.
+ * @note Filled by the inverter control (Core/Src/inverters.c), packed into the AMK
+ *       setpoints frame on every transmission.
+ */
+typedef struct {
+    uint16_t control_word;
+    int16_t target_velocity; //rpm, speed mode
+    int16_t target_torque; //0.1% Mn, torque mode
+    int16_t positive_torque_limit; //0.1% Mn change to meaningful value
+    int16_t negative_torque_limit; //0.1% Mn change to meaningful value
+}inverter_setpoints_t;
+
 /**
  * @brief Inverter struct.
  * @note This struct is used to store the inverter paramets for the database layer
@@ -51,15 +66,10 @@ uint8_t AMK_bDerating;
     int16_t motor_temperature; //0.1 degree C change to meaningful value
     int16_t plate_temperature; //0.1 degree C change to meaningful value
     int16_t igbt_temperature; //0.1 degree C change to meaningful value
+    uint8_t av2_received; // An actual values 2 frame was decoded, the temperatures are valid
   
     
-    struct {
-        uint16_t control_word;
-        int16_t target_velocity; //rpm
-        int16_t positive_torque_limit; //0.1% Mn change to meaningful value
-        int16_t negative_torque_limit; //0.1% Mn change to meaningful value
-
-    }setpoints;
+    inverter_setpoints_t setpoints;
 } inverter_t;
 
 
@@ -91,7 +101,7 @@ typedef enum{
 typedef struct{
     uint8_t buzzer_counter;
     uint8_t communication_counter;
-    uint8_t hard_brake;
+    uint16_t hard_brake;
 }counters_t;
 
 
@@ -121,6 +131,83 @@ typedef struct{
 
 
 
+/**
+ * @brief Internal sensors struct.
+ * @note This struct is used to store the on-board (ADC) sensor values, updated directly from the ADC mailbox
+ */
+
+typedef struct{
+    uint16_t adc1[INTERNAL_SENSORS_NUM]; // Averaged raw ADC1 values
+    uint16_t calibrated[INTERNAL_SENSORS_NUM]; // Calibrated values (0..100 %)
+    uint32_t timestamp;                   // HAL tick of the ADC block
+}internal_sensors_t;
+
+
+/**
+ * @brief IMU struct.
+ * @note This struct is used to store the optional IMU frame, the state estimator takes it
+ *       while frames keeps counting
+ */
+
+typedef struct{
+    int16_t accel_x;   // Longitudinal acceleration, forward positive [0.01 m/s^2]
+    uint16_t frames;   // Frames received, wraps
+}imu_t;
+
+
+/**
+ * @brief Tunable parameters struct.
+ * @note Runtime copies of the tuning defaults, changed live from the debug shell (get/set/dump)
+ */
+
+typedef struct{
+    uint16_t hb_gas_high;      // Hard brake entry gas threshold
+    uint16_t hb_gas_low;       // Hard brake exit gas threshold
+    uint16_t hb_brake_high;    // Hard brake entry brake threshold
+    uint16_t max_velocity;     // Target velocity at full gas
+    uint8_t  r2d_timeout;      // R2D window in FSM ticks
+    int16_t  pos_torque_limit; // Positive torque limit sent to the inverters
+    int16_t  neg_torque_limit; // Negative torque limit sent to the inverters
+    uint8_t  tv_enable;        // Torque vectoring on (1) or equal speed commands (0)
+    float    tv_front_split;   // Share of the driver torque on the front axle
+    float    tv_yaw_ff;        // Yaw moment per reference yaw rate [Nm s/rad]
+    float    tv_yaw_kp;        // Yaw moment per yaw rate error [Nm s/rad]
+    uint8_t  tc_enable;        // Traction control on (1) or off (0)
+    float    tc_slip_target;   // Slip ratio allowed before cutting torque
+    float    tc_kp;            // Torque cut per unit slip [Nm]
+    float    tc_ki;            // Torque cut per unit slip and second [Nm/s]
+    float    tc_accel_limit;   // Max plausible acceleration for the speed reference [m/s^2]
+    uint8_t  lc_enable;        // Launch control can be armed (1) or not (0)
+    uint16_t lc_gas_min;       // Gas needed to launch and to stay in the launch [%]
+    float    lc_torque_scale;  // Share of the peak driver torque allowed during the launch
+    float    lc_slip_target;   // Slip target of the traction control during the launch
+    float    lc_exit_speed;    // Hand over to normal driving above this speed [m/s]
+    uint8_t  rg_enable;        // Regenerative braking on (1) or off (0), needs a decoded dc_bus_voltage
+    float    rg_max_torque;    // Mean regen torque of the motors at full pedal [Nm]
+    float    rg_front_split;   // Share of the regen on the front axle
+    float    rg_pedal_start;   // Brake pedal where the regen starts [%]
+    float    rg_pedal_full;    // Brake pedal of full regen [%]
+    float    rg_volt_start;    // Pack voltage where the regen starts to derate [V]
+    float    rg_volt_max;      // No regen above this pack voltage [V]
+    float    rg_temp_start;    // Inverter temperature where the regen starts to derate [degC]
+    float    rg_temp_max;      // No regen above this inverter temperature [degC]
+    float    rg_rate;          // Max regen torque change of a motor [Nm/s]
+    uint8_t  pm_mode;          // Driver mode of the pedal map (PmMode_t)
+    uint8_t  pl_enable;        // Power limiter on (1) or off (0)
+    float    pl_limit;         // Max electrical power of the four inverters [W]
+    float    pl_margin;        // Kept below the limit [W]
+    uint8_t  th_enable;        // Thermal derating on (1) or off (0)
+    float    th_horizon;       // Temperature prediction [s]
+    float    th_recovery;      // Max rise of a derating factor [1/s]
+    float    th_warning;       // Thermal warning below this factor
+    uint8_t  est_enable;       // Estimator speed for the traction control and torque vectoring (1) or wheel speeds (0)
+    float    est_jerk;         // Estimator process noise [m/s^3]
+    float    est_wheel_noise;  // Wheel speed measurement noise [m/s]
+    float    est_accel_noise;  // Torque acceleration measurement noise [m/s^2]
+    float    est_imu_noise;    // IMU acceleration measurement noise [m/s^2]
+}params_t;
+
+
 /**
  * @brief VCU node struct.
  * @note This struct is used to store the VCU node paramets for the database layer
@@ -133,6 +220,11 @@ typedef struct{
     counters_t counters;
     Stage_t fsm_stage ;
     uint8_t error_reset_flag;
+    uint8_t thermal_derate[4];  // Thermal factor of each motor [%], 100 when not derated
+    uint8_t thermal_warning;    // A motor is derated below th_warning
+    internal_sensors_t internal_sensors;
+    imu_t imu;
+    params_t params;
 }vcu_node_t;
 
 
@@ -176,6 +268,8 @@ typedef struct {
 #define RES_ID 0x192
 #define PEDAL_ID 0x193
 #define DB_ID 0x194
+#define IMU_ID 0x195
+#define VCU_STATUS_ID 0x196 // Sent to the dashboard
 
 
 
@@ -202,14 +296,57 @@ typedef struct {
 #define SHORT_TO_VCC_VALUE 0xFF11
 
 /**** Hard Brake (BPPC) Defines ******/
-#define HB_ENTRY_TIMEOUT 18 // for 360 ms 
-#define HB_EXIT_TIMEOUT 5  // for 100 ms
+#define HB_ENTRY_TIMEOUT 360 // for 360 ms (control task ticks)
+#define HB_EXIT_TIMEOUT 100  // for 100 ms (control task ticks)
 #define MIN_RANGE 0 //for Gas pedal
 #define MAX_RANGE 1000 //for Gas pedal
 #define HB_GAS_HIGH_VAL 250
 #define HB_GAS_LOW_VAL 50
 #define HB_BRAKE_HIGH_VAL 300
 
+/**** Tunable parameter defaults (params_t) ******/
+#define MAX_VELOCITY 1000
+#define R2D_TIMEOUT 10
+#define POS_TORQUE_LIMIT 1000
+#define NEG_TORQUE_LIMIT -1000
+#define TV_ENABLE 1
+#define TV_FRONT_SPLIT 0.4f
+#define TV_YAW_FF 250.0f
+#define TV_YAW_KP 400.0f
+#define TC_ENABLE 1
+#define TC_SLIP_TARGET 0.10f
+#define TC_KP 150.0f
+#define TC_KI 3000.0f
+#define TC_ACCEL_LIMIT 15.0f
+#define LC_ENABLE 1
+#define LC_GAS_MIN 90
+#define LC_TORQUE_SCALE 1.0f
+#define LC_SLIP_TARGET 0.06f // Under the tyre peak (~0.11), the slip reads low below TC_MIN_SPEED
+#define LC_EXIT_SPEED 15.0f
+#define RG_ENABLE 0 // Off: dc_bus_voltage is not decoded yet, rg_Process gives no regen at 0 V
+#define RG_MAX_TORQUE 8.0f
+#define RG_FRONT_SPLIT 0.6f
+#define RG_PEDAL_START 5.0f
+#define RG_PEDAL_FULL 50.0f
+#define RG_VOLT_START 570.0f
+#define RG_VOLT_MAX 590.0f
+#define RG_TEMP_START 55.0f
+#define RG_TEMP_MAX 70.0f
+#define RG_RATE 200.0f
+#define PM_MODE 0 // PM_LINEAR
+#define PL_ENABLE 1
+#define PL_LIMIT 80000.0f
+#define PL_MARGIN 4000.0f // Covers an efficiency 0.04 below PL_EFFICIENCY, the limiter does not see it
+#define TH_ENABLE 1
+#define TH_HORIZON 10.0f
+#define TH_RECOVERY 0.05f
+#define TH_WARNING 0.9f
+#define EST_ENABLE 1
+#define EST_JERK 30.0f
+#define EST_WHEEL_NOISE 0.05f
+#define EST_ACCEL_NOISE 3.0f
+#define EST_IMU_NOISE 0.2f
+
 
 /* ========================== Function Declarations =============================== */
 
@@ -217,6 +354,7 @@ database_t* db_AllocateMemory();
 void db_FreeMemory(database_t* db_ptr);
 database_t* db_Init();
 database_t* db_GetDBPointer();
+void db_SetDefaultParams(params_t* params);
 #endif // DATABASE_H
 
 
@@ -0,0 +1,37 @@
+#ifndef EVENT_H
+#define EVENT_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <stddef.h>
+
+// No HAL dependency: events are posted by the decoders (DbSetFunctions.c) and the inverter
+// control (Core/Src/inverters.c) and consumed by the vehicle FSM (Core/Src/FSM.c).
+
+/* =============================== Defines ======================================= */
+#define EV_QUEUE_SIZE  16   // Pending events, power of 2
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Event enum
+ * @note  EV_NONE (0) is the id of the FSM tick transitions (HSM_EV_TICK) and is never
+ *        posted.
+ */
+typedef enum{
+    EV_NONE = 0,
+    EV_R2D_PRESSED,      // Dashboard R2D button pressed
+    EV_INV_READY,        // The last inverter sequencer reached AMK_ST_READY
+    EV_INV_LOST,         // An inverter sequencer left AMK_ST_READY
+    EV_HV_LOST,          // An inverter reports the DC bus off
+    EV_BRAKE_RELEASED,   // Brake pressure fell below BRAKE_PEDAL_THRESHOLD
+    EV_THERMAL_WARNING,  // A wheel is derated below th_warning, sends the dashboard status
+    EV_NUM
+}Event_t;
+
+/* ========================== Function Declarations ============================ */
+void ev_Init(void);
+uint8_t ev_Post(Event_t event);
+uint8_t ev_Get(Event_t* event);
+uint32_t ev_GetDroppedCount(void);
+
+#endif // EVENT_H
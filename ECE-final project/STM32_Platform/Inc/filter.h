@@ -0,0 +1,75 @@
+#ifndef FILTER_H
+#define FILTER_H
+/* =============================== Includes ======================================= */
+#include "database.h"
+#include "arm_math.h"
+
+/* =============================== Defines ======================================= */
+#define FLT_MAX_BLOCK_SIZE     8   // Max samples processed by one CMSIS-DSP call
+#define FLT_MAX_FIR_TAPS       16  // Max FIR length (must be even for the Q15 FIR)
+#define FLT_MAX_BIQUAD_STAGES  2   // Max cascaded 2nd order sections
+#define FLT_MAX_MEDIAN_WINDOW  7   // Max median window length (odd)
+#define FLT_SAMPLE_PERIOD_MS   10  // Sample period all coefficients are designed for (fs = 100 Hz)
+#define FLT_MAX_HOLD_STEPS     10  // Longest gap flt_Process bridges by holding the value [samples]
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Filtered signals enum
+ * @note  One pipeline slot per signal, the order matches the filter config table
+ */
+typedef enum{
+    FLT_GAS = 0,
+    FLT_BRAKE,
+    FLT_STEERING,
+    FLT_BIOPS,
+    FLT_NUM_SIGNALS
+}FilterSignal_t;
+
+/**
+ * @brief Filter type enum
+ */
+typedef enum{
+    FLT_NONE = 0,     // Pass through
+    FLT_FIR,          // arm_fir_q15 / arm_fir_f32
+    FLT_BIQUAD,       // arm_biquad_cascade_df1_q15 / arm_biquad_cascade_df2T_f32
+    FLT_MEDIAN,       // Sliding median, rejects single-sample spikes
+    FLT_EXPONENTIAL   // First order IIR: y += alpha * (x - y)
+}FilterType_t;
+
+/**
+ * @brief Filter arithmetic format enum
+ */
+typedef enum{
+    FLT_Q15 = 0,
+    FLT_F32
+}FilterFormat_t;
+
+/**
+ * @brief Filter configuration struct
+ * @note  Lives in flash (const table in filter.c), coefficients are also const and
+ *        designed for FLT_SAMPLE_PERIOD_MS, whatever rate the messages come at.
+ *        FIR coefficients are in time reversed order, Q15 biquad coefficients are
+ *        {b0, 0, b1, b2, a1, a2} per stage and f32 biquad {b0, b1, b2, a1, a2} per stage
+ *        (a1/a2 with the CMSIS sign convention).
+ *        Approximate cost per sample on the M4: FIR ~1.5 cycles per tap, biquad ~15 cycles
+ *        per stage, median ~window^2 compares, exponential ~5 cycles.
+ */
+typedef struct{
+    FilterType_t   type;
+    FilterFormat_t format;
+    uint16_t       order;       // FIR: taps, biquad: stages, median: window length
+    const void*    coeffs;      // q15_t* or float32_t* depending on format
+    float32_t      alpha;       // Exponential smoothing factor (0..1]
+    int8_t         postShift;   // Q15 biquad post shift
+    uint8_t        inputShift;  // Q15 only: value << inputShift before filtering to keep resolution
+}filter_config_t;
+
+/* ========================== Function Declarations ============================ */
+void flt_Init(void);
+void flt_Reset(FilterSignal_t signal);
+void flt_ProcessBlock(FilterSignal_t signal, const int32_t* pIn, int32_t* pOut, uint16_t blockSize);
+int32_t flt_Process(FilterSignal_t signal, int32_t value, uint16_t steps);
+uint16_t flt_Steps(uint32_t* pLastTick, uint32_t now);
+
+#endif // FILTER_H
@@ -0,0 +1,17 @@
+#ifndef FLASH_H
+#define FLASH_H
+/* =============================== Includes ======================================= */
+#include "platform.h"
+#ifdef HAL_FLASH_MODULE_ENABLED
+
+/* =============================== Defines =============================== */
+#define CAL_FLASH_ADDR       0x08060000U  // Sector 7, reserved in STM32F446XX_FLASH.ld
+#define CAL_FLASH_SIZE       (128U * 1024U)
+#define CAL_FLASH_SECTOR     FLASH_SECTOR_7
+
+/* ========================== Function Declarations ============================ */
+HAL_StatusTypeDef plt_FlashErase(uint32_t sector);
+HAL_StatusTypeDef plt_FlashProgram(uint32_t address, const uint8_t* data, uint32_t len);
+
+#endif
+#endif // FLASH_H
@@ -0,0 +1,88 @@
+#ifndef HSM_H
+#define HSM_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// No HAL dependency: the engine only calls the actions of the tables, the vehicle FSM is
+// in Core/Src/FSM.c.
+
+/* =============================== Defines ======================================= */
+#define HSM_NO_STATE      0xFF   // Parent of a top level state
+#define HSM_EV_TICK       0      // Event of the transitions checked by hsm_Run
+#define HSM_MAX_DEPTH     4      // Max nesting of the states
+#define HSM_HISTORY_SIZE  16     // Transitions kept in the history log, power of 2
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief HSM state struct
+ * @note  One entry of the const state table, the index is the state id. entry runs once
+ *        when the state is entered, run (do) on every hsm_Run while the state is active and
+ *        exit once when it is left. The actions of a superstate also run for all of its
+ *        substates. Any action may be NULL.
+ */
+typedef struct{
+    const char* name;
+    uint8_t parent;          // Superstate id, HSM_NO_STATE for a top level state
+    void (*entry)(void);
+    void (*run)(void);
+    void (*exit)(void);
+}hsm_state_t;
+
+/**
+ * @brief HSM transition struct
+ * @note  One entry of the const transition table. A transition from a superstate is taken
+ *        in all of its substates. The target must be a leaf state, or HSM_NO_STATE for an
+ *        internal transition: only the action runs, the state is not left. guard NULL means always,
+ *        action runs after the exits and before the entries. HSM_EV_TICK transitions are
+ *        polled by hsm_Run (timeouts, levels), the others are taken by hsm_Dispatch when
+ *        their event arrives.
+ */
+typedef struct{
+    uint8_t from;
+    uint8_t to;
+    uint8_t event;
+    uint8_t (*guard)(void);
+    void (*action)(void);
+}hsm_transition_t;
+
+/**
+ * @brief HSM history entry struct
+ */
+typedef struct{
+    uint32_t timestamp;      // From the clock given to hsm_Init
+    uint8_t  from;
+    uint8_t  to;
+    uint8_t  event;          // HSM_EV_TICK for polled and forced transitions
+}hsm_history_t;
+
+/**
+ * @brief HSM instance struct
+ * @note  The tables are const, only the current state and the history live in RAM.
+ */
+typedef struct{
+    const hsm_state_t* states;
+    uint8_t numStates;
+    const hsm_transition_t* transitions;
+    uint8_t numTransitions;
+    uint32_t (*clock)(void);                 // Timestamp source for the history, may be NULL
+    void (*trace)(uint8_t from, uint8_t to); // Called after every transition, may be NULL
+    uint8_t current;                         // Active leaf state
+    uint8_t historyHead;                     // Next history slot
+    uint32_t transitionCount;
+    hsm_history_t history[HSM_HISTORY_SIZE];
+}hsm_t;
+
+/* ========================== Function Declarations ============================ */
+void hsm_Init(hsm_t* hsm, const hsm_state_t* states, uint8_t numStates,
+              const hsm_transition_t* transitions, uint8_t numTransitions,
+              uint8_t initial, uint32_t (*clock)(void));
+void hsm_Run(hsm_t* hsm);
+uint8_t hsm_Dispatch(hsm_t* hsm, uint8_t event);
+void hsm_Goto(hsm_t* hsm, uint8_t target);
+uint8_t hsm_InState(const hsm_t* hsm, uint8_t state);
+uint8_t hsm_GetHistory(const hsm_t* hsm, uint8_t index, hsm_history_t* entry);
+
+#endif // HSM_H
@@ -0,0 +1,47 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+/* =============================== Includes ======================================= */
+#include "platform.h"
+
+/* =============================== Defines ======================================= */
+#define LOG_BUFFER_SIZE   1024  // Log record ring buffer size, must be a power of 2
+#define LOG_MAX_ARGS      4     // Max arguments per log site
+#define LOG_SYNC          0xA5  // First byte of every record
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Log record header struct
+ * @note  Followed by nargs 32 bit little endian arguments. The id is the offset of the
+ *        format string in the .logfmt section of the ELF, decoded on the host by
+ *        Tools/log_decode.py.
+ */
+typedef struct __attribute__((packed)){
+    uint8_t  sync;       // LOG_SYNC
+    uint8_t  nargs;      // Number of 32 bit arguments
+    uint16_t id;         // Format string id
+    uint32_t timestamp;  // HAL tick [ms]
+}log_header_t;
+
+/* =============================== Macros ========================================= */
+
+/**
+ * @brief Log a message in binary form
+ * @note  Same usage as printf with up to LOG_MAX_ARGS integer arguments (%d, %u, %lu, %x, %c).
+ *        The format string is placed in the non loaded .logfmt section, only its 16 bit
+ *        id and the raw arguments are written, so a log site costs tens of cycles.
+ *        Floats and strings (%f, %s) are not supported.
+ */
+#define LOG(fmt, ...) do{ \
+    static const char log_fmt_[] __attribute__((section(".logfmt"), used)) = fmt; \
+    const uint32_t log_args_[] = {0, ##__VA_ARGS__}; \
+    log_Write((uint16_t)(uintptr_t)log_fmt_, &log_args_[1], (uint8_t)(sizeof(log_args_) / sizeof(uint32_t) - 1U)); \
+}while(0)
+
+/* ========================== Function Declarations ============================ */
+void log_Init(void);
+void log_Write(uint16_t id, const uint32_t* args, uint8_t nargs);
+void log_Process(void);
+uint32_t log_GetDroppedCount(void);
+
+#endif // LOGGER_H
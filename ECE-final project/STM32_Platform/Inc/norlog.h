@@ -0,0 +1,90 @@
+#ifndef NORLOG_H
+#define NORLOG_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <stddef.h>
+#include "crc.h"
+
+// No HAL dependency: runs on the SPI NOR flash on the target (blackbox.c) and on the RAM
+// flash simulator on the host (Tools/norlog_host.c).
+
+/* =============================== Defines ======================================= */
+#define NLOG_MAGIC           0x31584242U  // "BBX1"
+#define NLOG_VERSION         1
+#define NLOG_MAX_PAGE_SIZE   256          // Largest supported program page
+// Page buffers: at the black box rate (~44 kB/s) a typical 45 ms sector erase leaves up to 9
+// pages waiting. No buffer size covers the 400 ms maximum erase, the flash then cannot keep
+// up at all and the records beyond the buffers are dropped (stats.dropped).
+#ifndef NLOG_PAGE_BUFFERS
+#define NLOG_PAGE_BUFFERS    16           // Pages assembled in RAM, covers a ~90 ms erase (Tools/norlog_host.c)
+#endif
+#define NLOG_ERASE_AHEAD     2            // Segments kept erased in front of the write position
+#define NLOG_TYPE_ERASED     0xFF         // Record type of erased flash, ends the records of a page
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Flash operations struct
+ * @note  Segments are erase sectors, pages are program pages. program and erase only start
+ *        the operation (busy returns 1 until it is done), read may block (mount only).
+ *        All functions return 1 on success, 0 on failure.
+ */
+typedef struct{
+    uint32_t size;                // Total size in bytes
+    uint32_t segmentSize;         // Erase sector size in bytes
+    uint16_t pageSize;            // Program page size in bytes (<= NLOG_MAX_PAGE_SIZE)
+    uint8_t (*read)(uint32_t addr, uint8_t* data, uint32_t len);
+    uint8_t (*program)(uint32_t addr, const uint8_t* data, uint16_t len);
+    uint8_t (*erase)(uint32_t addr);
+    uint8_t (*busy)(void);
+}nlog_ops_t;
+
+/**
+ * @brief Segment header struct
+ * @note  First bytes of the first page of every segment. The sequence grows by one per segment
+ *        and the segment index is sequence % number of segments, so the log is a ring.
+ */
+typedef struct __attribute__((packed)){
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t version;
+    uint16_t pageSize;
+    uint16_t reserved;
+    uint16_t crc;                 // CRC-16 of the previous fields
+}nlog_segment_t;
+
+/**
+ * @brief Record header struct
+ * @note  Followed by len payload bytes. Records never cross a page, the rest of a page is left
+ *        erased (type NLOG_TYPE_ERASED).
+ */
+typedef struct __attribute__((packed)){
+    uint8_t  type;
+    uint8_t  len;
+    uint16_t crc;                 // CRC-16 of type, len, timestamp and payload
+    uint32_t timestamp;           // ms
+}nlog_record_t;
+
+/**
+ * @brief Logger statistics struct
+ */
+typedef struct{
+    uint32_t records;             // Records accepted
+    uint32_t dropped;             // Records dropped because all page buffers were waiting
+    uint32_t pages;               // Pages programmed
+    uint32_t erases;              // Segments erased
+    uint32_t errors;              // Failed flash operations
+    uint32_t sequence;            // Sequence of the segment being written
+    uint32_t maxReady;            // Most page buffers waiting at once (high water mark)
+}nlog_stats_t;
+
+/* ========================== Function Declarations ============================ */
+uint8_t nlog_Mount(const nlog_ops_t* ops);
+uint8_t nlog_Write(uint8_t type, uint32_t timestamp, const void* payload, uint8_t len);
+void nlog_Flush(void);
+void nlog_Process(void);
+void nlog_GetStats(nlog_stats_t* stats);
+void nlog_RamInit(nlog_ops_t* ops, uint8_t* mem, uint32_t size, uint32_t segmentSize, uint16_t pageSize);
+void nlog_RamSetTiming(uint32_t (*nowUs)(void), uint32_t programUs, uint32_t eraseUs);
+
+#endif // NORLOG_H
@@ -44,13 +44,14 @@ typedef struct{
 }uart_message_t;
 
 /**
- * @brief Debug message structure
- * @note This struct is used to store the debug message data
+ * @brief SPI Chanels enum
+ * @note This enum is used to define the SPI channels
  */
-typedef struct {
-    uint8_t data[64];
-    uint16_t len;
-} debug_message_t; 
+typedef enum{
+	Spi1 = 1,
+	Spi2 = 2,
+	Spi3 = 3
+}SpiChanel_t;
 
 /**
  * @brief SPI message structure
@@ -122,6 +123,7 @@ typedef struct{
     #endif
     #ifdef HAL_UART_MODULE_ENABLED
     void (*UART_RxCallback)(uart_message_t *msg);
+    void (*UART_TxCallback)(UartChanel_t chanel);
     #endif
     #ifdef HAL_SPI_MODULE_ENABLED
     void (*SPI_RxCallback)(spi_message_t *msg);
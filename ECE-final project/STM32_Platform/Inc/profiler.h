@@ -0,0 +1,107 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+/* =============================== Includes ======================================= */
+#include "platform.h"
+
+// PRF_ENABLED is defined for Debug builds in CMakeLists.txt, in the other builds the PROF_
+// macros compile to nothing and the probes cost no cycle.
+
+/* =============================== Defines ======================================= */
+#define PRF_LOAD_WINDOW_MS   1000   // CPU load averaging window
+#define PRF_REPORT_SYNC      0x5A   // First byte of a serialized report
+#define PRF_REPORT_VERSION   1
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Profiler probes enum
+ * @note  One entry per instrumented code block, the names in Tools/prf_report.py must
+ *        follow the same order.
+ */
+typedef enum{
+    PRF_TASK_CONTROL = 0,    // FSM_TaskControl
+    PRF_TASK_SAFETY,         // FSM_TaskSafety
+    PRF_TASK_FSM,            // FSM
+    PRF_TASK_HMI,            // FSM_TaskHmi
+    PRF_CAN_PROCESS,         // plt_CanProcessRxMsgs
+    PRF_CAN_RX_ISR,          // HAL_CAN_RxFifo0/1MsgPendingCallback
+    PRF_TORQUE_VECTORING,    // tv_Process
+    PRF_TRACTION_CONTROL,    // tc_Process
+    PRF_REGEN,               // rg_Process
+    PRF_POWER_LIMIT,         // pl_Process
+    PRF_ESTIMATOR,           // est_Process
+    PRF_NUM_PROBES
+}PrfProbe_t;
+
+/**
+ * @brief Probe statistics struct
+ * @note  Cycles of the DWT cycle counter (core clock).
+ */
+typedef struct{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+}prf_stats_t;
+
+/**
+ * @brief Serialized report header struct
+ * @note  Followed by PRF_NUM_PROBES prf_report_probe_t, all little endian.
+ */
+typedef struct __attribute__((packed)){
+    uint8_t  sync;           // PRF_REPORT_SYNC
+    uint8_t  version;        // PRF_REPORT_VERSION
+    uint8_t  numProbes;
+    uint8_t  coreMHz;        // Cycles per us
+    uint16_t loadPermille;   // CPU load of the last window
+    uint32_t tickCount;      // Ticks measured for the period statistics
+    uint32_t tickMin;        // Shortest tick period [cycles]
+    uint32_t tickMax;        // Longest tick period [cycles]
+}prf_report_header_t;
+
+/**
+ * @brief Serialized probe struct
+ */
+typedef struct __attribute__((packed)){
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+}prf_report_probe_t;
+
+#define PRF_REPORT_SIZE (sizeof(prf_report_header_t) + PRF_NUM_PROBES * sizeof(prf_report_probe_t))
+
+/* =============================== Macros ========================================= */
+
+#ifdef PRF_ENABLED
+/**
+ * @brief Start a probe, PROF_END with the same probe must follow in the same scope
+ */
+#define PROF_BEGIN(probe)  const uint32_t prf_start_##probe = DWT->CYCCNT
+#define PROF_END(probe)    prf_Record((probe), DWT->CYCCNT - prf_start_##probe)
+/**
+ * @brief Mark the start of a base tick, for the tick period jitter
+ */
+#define PROF_TICK()        prf_Tick()
+/**
+ * @brief Mark the end of a main loop pass, busy is 0 when the pass had nothing to run
+ */
+#define PROF_LOOP(busy)    prf_Loop(busy)
+#else
+#define PROF_BEGIN(probe)
+#define PROF_END(probe)
+#define PROF_TICK()
+#define PROF_LOOP(busy)    ((void)(busy))
+#endif
+
+/* ========================== Function Declarations ============================ */
+void prf_Init(void);
+void prf_Reset(void);
+void prf_Record(PrfProbe_t probe, uint32_t cycles);
+void prf_Tick(void);
+void prf_Loop(uint8_t busy);
+uint8_t prf_GetStats(PrfProbe_t probe, prf_stats_t* stats);
+uint16_t prf_GetLoad(void);
+size_t prf_Serialize(uint8_t* buffer, size_t size);
+
+#endif // PROFILER_H
@@ -0,0 +1,49 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+/* =============================== Includes ======================================= */
+#include "platform.h"
+#include "profiler.h"
+
+#ifdef HAL_TIM_MODULE_ENABLED
+/* =============================== Defines ======================================= */
+#define SCH_TICK_US      1000   // Base tick [us], every task period and offset is a multiple of it
+#define SCH_TIMER_HZ     1000000U // Counter clock of the tick timer (1 us resolution)
+#define SCH_MAX_TASKS    8
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Scheduler task struct
+ * @note  One entry of the const task table. A task is released on the ticks where
+ *        (tick - offset) % period == 0 and runs to completion in the main loop. Tasks
+ *        released on the same tick run in table order.
+ */
+typedef struct{
+    const char* name;
+    void (*run)(void);
+    uint16_t period;      // Ticks
+    uint16_t offset;      // Ticks, spreads the slow tasks over different ticks
+}sch_task_t;
+
+/**
+ * @brief Scheduler task statistics struct
+ */
+typedef struct{
+    uint32_t runs;
+    uint32_t overruns;    // Releases dropped while the task was late, it runs once for all of them
+    uint32_t lastUs;      // Execution time of the last run
+    uint32_t maxUs;       // Longest execution time
+}sch_stats_t;
+
+/* ========================== Function Declarations ============================ */
+void sch_Init(const sch_task_t* tasks, uint8_t numTasks);
+HAL_StatusTypeDef sch_Start(TIM_HandleTypeDef* htim);
+void sch_Tick(TIM_HandleTypeDef* htim);
+uint8_t sch_Run(void);
+uint32_t sch_GetTicks(void);
+uint32_t sch_GetLateTicks(void);
+uint8_t sch_GetStats(uint8_t task, sch_stats_t* stats);
+
+#endif
+
+#endif // SCHEDULER_H
@@ -0,0 +1,78 @@
+#ifndef SHELL_H
+#define SHELL_H
+/* =============================== Includes ======================================= */
+#include <stdint.h>
+#include <stddef.h>
+
+// No HAL dependency: the shell runs on the debug UART on the target and on stdin/stdout
+// on the host (Tools/shell_host.c).
+
+/* =============================== Defines ======================================= */
+#define SHELL_LINE_SIZE   64   // Max command line length
+#define SHELL_MAX_TOKENS  4    // Max words per command line
+#define SHELL_PROMPT      "> "
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief Shell transport struct
+ * @note  read returns the next received byte or -1 when there is none (must not block),
+ *        write sends the bytes (must not block either on the target).
+ */
+typedef struct{
+    int  (*read)(void);
+    void (*write)(const char* data, size_t len);
+}shell_io_t;
+
+/**
+ * @brief Shell parameter type enum
+ */
+typedef enum{
+    SH_U8 = 0,
+    SH_U16,
+    SH_I16,
+    SH_U32,
+    SH_I32,
+    SH_F32
+}ShellType_t;
+
+/**
+ * @brief Shell parameter struct
+ * @note  One entry of the const parameter table, the value lives at base + offset where
+ *        base is given to sh_Init. set rejects values outside [min, max].
+ */
+typedef struct{
+    const char* name;
+    ShellType_t type;
+    uint16_t    offset;   // offsetof() in the parameter struct
+    float       min;
+    float       max;
+}shell_param_t;
+
+/**
+ * @brief Shell statistic struct
+ * @note  One line of the stats command.
+ */
+typedef struct{
+    const char* name;
+    uint32_t  (*get)(void);
+}shell_stat_t;
+
+/**
+ * @brief Shell command struct
+ * @note  One entry of the optional application command table (sh_SetCommands), run is
+ *        called with the transport to print its output.
+ */
+typedef struct{
+    const char* name;
+    void      (*run)(const shell_io_t* io);
+}shell_cmd_t;
+
+/* ========================== Function Declarations ============================ */
+void sh_SetCommands(const shell_cmd_t* cmds, uint8_t numCmds);
+void sh_Init(const shell_io_t* io, const shell_param_t* params, uint8_t numParams, void* base,
+             const shell_stat_t* stats, uint8_t numStats);
+void sh_Process(void);
+void sh_Execute(char* line);
+
+#endif // SHELL_H
@@ -4,11 +4,39 @@
 #include "platform.h"
 
 #ifdef HAL_SPI_MODULE_ENABLED
+/* =============================== Defines ======================================= */
+#define SPI_NUM_BUSES       3    // SPI1, SPI2, SPI3
+#define SPI_TXN_QUEUE_SIZE  8    // Pending transactions per bus, must be a power of 2
+#define SPI_MSG_SLOTS       4    // spi_message_t frames in flight per master bus
+#define SPI_RX_RING_SIZE    256  // Received spi_message_t frames per bus, must be a power of 2
+#define SPI_TX_RING_SIZE    256  // Slave frames waiting to be streamed per bus, must be a power of 2
+
+/* =============================== Structs ======================================= */
+
+/**
+ * @brief SPI transaction descriptor
+ * @note  Full duplex when both pTx and pRx are set, transmit only when pRx is NULL, receive
+ *        only when pTx is NULL. The descriptor and the buffers belong to the caller and must
+ *        stay valid until done is called (interrupt context).
+ */
+typedef struct spi_transaction{
+    const uint8_t* pTx;
+    uint8_t* pRx;
+    uint16_t len;
+    GPIO_TypeDef* csPort;      // Chip select (active low), NULL when not used
+    uint16_t csPin;
+    void (*done)(struct spi_transaction* txn, HAL_StatusTypeDef status);
+    void* ctx;                 // Free for the caller
+}spi_transaction_t;
+
 /*========================= Function Declarations =========================*/
-void plt_SpiInit(size_t rx_queue_size);
-void plt_SpiSendMsg(spi_message_t* pData);
+void plt_SpiInit(void);
+HAL_StatusTypeDef plt_SpiSubmit(SpiChanel_t chanel, spi_transaction_t* txn);
+HAL_StatusTypeDef plt_SpiSendMsg(SpiChanel_t chanel, spi_message_t* pData);
+uint8_t plt_SpiIdle(SpiChanel_t chanel);
 void plt_SpiProcessRxMsgs(void);
+uint32_t plt_SpiGetDroppedCount(SpiChanel_t chanel);
 
 #endif
 
-#endif    // SPI_H
\ No newline at end of file
+#endif    // SPI_H
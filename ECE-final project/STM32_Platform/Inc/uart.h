@@ -6,13 +6,37 @@
 #ifdef HAL_UART_MODULE_ENABLED
 
 #define UART_Between_MCUs Uart1
+#define DEBUG_TX_BUFFER_SIZE 2048 // Debug (printf) ring buffer size, must be a power of 2
+#define UART_RX_LINKS        3    // USART1 and USART3 framed, USART2 raw (shell)
+#define UART_MCU_LINKS       2    // Framed links: USART1 and USART3
+#define UART_RX_DMA_SIZE     128  // Circular RX DMA buffer per link
+#define UART_RX_RING_SIZE    512  // RX ring buffer per link, must be a power of 2
+#define UART_TX_RING_SIZE    512  // TX ring buffer per link, must be a power of 2
+#define UART_MAX_ENCODED_FRAME COBS_MAX_ENCODED_SIZE(sizeof(uart_message_t) + sizeof(uint16_t)) // Message + CRC16
+
+/**
+ * @brief UART link reception statistics
+ */
+typedef struct{
+    uint32_t frames;         // Valid frames delivered
+    uint32_t crcErrors;      // Frames with a wrong CRC
+    uint32_t framingErrors;  // Frames with a bad COBS encoding or length
+    uint32_t lineErrors;     // Overrun / noise / framing errors reported by the UART
+    uint32_t dropped;        // Bytes lost because the RX ring was full
+}uart_rx_stats_t;
+
 /*========================= Function Declarations =========================*/
 void plt_UartInit(size_t tx_queue_size);
 HAL_StatusTypeDef plt_UartSendMsg(UartChanel_t chanel, uart_message_t* pData);
 void plt_DebugSendMSG(uint8_t* pData,uint16_t len);
+uint16_t plt_UartTxSpace(UartChanel_t chanel);
+uint8_t plt_UartTxIdle(UartChanel_t chanel);
+void plt_UartSyncMCUs(void);
 void plt_UartProcessRxMsgs(void);
-Queue_t* GetDebugTxQueue(void);
-Queue_t* plt_GetUartRxQueue();
+void plt_UartGetRxStats(UartChanel_t chanel, uart_rx_stats_t* stats);
+size_t plt_DebugRead(uint8_t* pData, size_t len);
+size_t plt_DebugGetFree(void);
+uint32_t plt_DebugGetOverflowCount(void);
 Queue_t* plt_GetUartTxQueue(void);
 
 #endif // HAL_UART_MODULE_ENABLED
@@ -3,6 +3,7 @@
 #define UTILS_H
 /* =============================== Includes ======================================= */
 #include "hashtable.h"
+#include "crc.h"
 /*========================= Queue related definitions =========================*/
 
 /**
@@ -47,6 +48,42 @@ void Queue_Pop(Queue_t* Q, void* data);
 void Queue_free(Queue_t* Q);
 void* Queue_Peek(Queue_t* Q);
 
+/*========================= Ring buffer related definitions =========================*/
+
+/**
+ * @brief Byte ring buffer
+ * @note  Single producer / single consumer byte stream on a static buffer. The size must
+ *        be a power of 2, head and tail are free running so used = head - tail.
+ *        Only the producer writes head and only the consumer writes tail, so one side
+ *        may run in an interrupt without locking.
+ */
+typedef struct{
+    uint8_t* buffer;
+    size_t size;
+    volatile size_t head;      // Write index (producer)
+    volatile size_t tail;      // Read index (consumer)
+    volatile uint32_t overflow; // Number of writes dropped because the buffer was full
+} RingBuffer_t;
+
+/*========================= Ring buffer related function prototypes =========================*/
+
+void Ring_Init(RingBuffer_t* R, uint8_t* buffer, size_t size);
+size_t Ring_Used(const RingBuffer_t* R);
+size_t Ring_Free(const RingBuffer_t* R);
+size_t Ring_Write(RingBuffer_t* R, const uint8_t* data, size_t len);
+size_t Ring_Read(RingBuffer_t* R, uint8_t* data, size_t len);
+size_t Ring_PeekContiguous(const RingBuffer_t* R, uint8_t** data);
+void Ring_Consume(RingBuffer_t* R, size_t len);
+
+/*========================= COBS related definitions =========================*/
+
+#define COBS_DELIMITER 0x00                                      // Frame delimiter, never inside an encoded frame
+#define COBS_MAX_ENCODED_SIZE(len) ((len) + ((len) / 254) + 1)   // Worst case encoded size (without the delimiter)
+
+/*========================= COBS related function prototypes =========================*/
+
+size_t Cobs_Encode(const uint8_t* in, size_t len, uint8_t* out);
+size_t Cobs_Decode(const uint8_t* in, size_t len, uint8_t* out);
 
 
 
@@ -2,6 +2,10 @@
 
 /* =============================== Global Variables =============================== */
 static database_t* pMainDB = NULL;
+static uint8_t InvHvOn = 0;      // All inverters reported the DC bus on, for EV_HV_LOST
+static uint8_t BrakePressed = 0; // BIOPS above BRAKE_PEDAL_THRESHOLD, for EV_BRAKE_RELEASED
+static uint16_t R2DLevel = 0;    // Last raw R2D value of the dashboard, for EV_R2D_PRESSED
+static uint32_t PedalFilterTick = 0; // Tick the pedal filters were last advanced to
 
 /* ========================== Function Definitions ============================ */
 /**
@@ -11,6 +15,45 @@ static database_t* pMainDB = NULL;
 void DbSetFunctionsInit()
 {
     pMainDB = db_GetDBPointer();
+    flt_Init(); // Initialize the filter pipeline used by the decoders
+}
+
+/**
+ * @brief Post the inverter status events
+ * @note  Called after every inverter status decode. Posts EV_HV_LOST when the first
+ *        inverter drops the DC bus, only on the edge so the FSM sees each change once.
+ *        EV_INV_READY comes from the inverter sequencers (inv_Sequence), not from the
+ *        raw status bits.
+ */
+static void InvStatusEvents(void)
+{
+    uint8_t hvOn = 1;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        AMK_Status_t* status = &pMainDB->vcu_node->inverters[i].AMK_Status;
+        if (status->AMK_bQuitDCon != 1 || status->AMK_bDcOn != 1) hvOn = 0;
+    }
+
+    if (InvHvOn && !hvOn) (void)ev_Post(EV_HV_LOST);
+    InvHvOn = hvOn;
+}
+
+/**
+ * @brief Compute the electrical power of an inverter
+ * @param inv Inverter with the actual values 1 just decoded
+ * @note  The AMK actual values carry no DC bus voltage or power, the power is derived from
+ *        the torque current and the speed: shaft power divided by the efficiency when
+ *        driving, multiplied when braking. In W, negative while regenerating. An estimate
+ *        with the efficiency the power limiter also assumes, not a DC side measurement,
+ *        so the limiter does not use it as feedback.
+ */
+static void InvPower(inverter_t* inv)
+{
+    float torque = (float)inv->torque_current * AMK_CURRENT_SCALE * AMK_MOTOR_KT;
+    float shaft = torque * (float)inv->actual_speed * 2.0f * 3.14159265f / 60.0f;
+
+    inv->actual_power = (int32_t)((shaft > 0.0f) ? shaft / AMK_EFFICIENCY : shaft * AMK_EFFICIENCY);
 }
 
 /**
@@ -33,28 +76,51 @@ void setPedalParameters(uint8_t* data)
     memcpy(&steering_wheel_angle,&data[4], sizeof(int16_t));
     memcpy(&BIOPS,&data[6], sizeof(uint16_t));
 
-    gas_value = (gas_value > MAX_VALUE_APPS) ? MAX_VALUE_APPS : gas_value;
-    brake_value = (brake_value > MAX_VALUE_BPPS) ? MAX_VALUE_BPPS : brake_value;
-    steering_wheel_angle = (steering_wheel_angle > MAX_VALUE_SW) ? MAX_VALUE_SW : (steering_wheel_angle < MIN_VALUE_SW) ? MIN_VALUE_SW : steering_wheel_angle;
-    BIOPS = (BIOPS > MAX_VALUE_BIOPS) ? MAX_VALUE_BIOPS :  BIOPS ;
+    // Filter the decoded values before they reach the database, at the filter design rate
+    uint16_t steps = flt_Steps(&PedalFilterTick, HAL_GetTick());
+    int32_t gas = flt_Process(FLT_GAS, gas_value, steps);
+    int32_t brake = flt_Process(FLT_BRAKE, brake_value, steps);
+    int32_t steering = flt_Process(FLT_STEERING, steering_wheel_angle, steps);
+    int32_t biops = flt_Process(FLT_BIOPS, BIOPS, steps);
+
+    // Clamp after filtering on both sides, IIR over- and undershoot must not leave the valid range
+    gas_value = (uint16_t)((gas > MAX_VALUE_APPS) ? MAX_VALUE_APPS : (gas < MIN_VALUE_APPS) ? MIN_VALUE_APPS : gas);
+    brake_value = (uint16_t)((brake > MAX_VALUE_BPPS) ? MAX_VALUE_BPPS : (brake < MIN_VALUE_BPPS) ? MIN_VALUE_BPPS : brake);
+    steering_wheel_angle = (int16_t)((steering > MAX_VALUE_SW) ? MAX_VALUE_SW : (steering < MIN_VALUE_SW) ? MIN_VALUE_SW : steering);
+    BIOPS = (uint16_t)((biops > MAX_VALUE_BIOPS) ? MAX_VALUE_BIOPS : (biops < MIN_VALUE_BIOPS) ? MIN_VALUE_BIOPS : biops);
 
     pMainDB->pedal_node->gas_value = gas_value;
     pMainDB->pedal_node->brake_value = brake_value;
     pMainDB->pedal_node->steering_wheel_angle = steering_wheel_angle;
     pMainDB->pedal_node->BIOPS = BIOPS;
 
+    // Launch control releases on this edge, not on the next FSM tick
+    if (BrakePressed && BIOPS <= BRAKE_PEDAL_THRESHOLD) (void)ev_Post(EV_BRAKE_RELEASED);
+    BrakePressed = (BIOPS > BRAKE_PEDAL_THRESHOLD) ? 1 : 0;
 }
 
 
+/**
+ * @brief Set the dashboard parameters
+ * @note  The R2D button is sent as a level. A press is its rising edge: it latches R2D for
+ *        the Stage 2 checks and posts EV_R2D_PRESSED once, holding the button does not
+ *        repeat it. The FSM clears the latch.
+ * @param data Pointer to the data received from the CAN message
+ */
 void setDBParameters(uint8_t* data)
 {
+    uint16_t r2d = 0;
+
     pMainDB->vcu_node->keep_alive[DBNODE] = 1; // Set the database node alive
-    if(pMainDB->dashboard_node->R2D == 0)
+    memcpy(&r2d, &data[2], sizeof(uint16_t));
+    if (r2d != 0 && R2DLevel == 0)
     {
-        memcpy(&pMainDB->dashboard_node->R2D,&data[2], sizeof(uint16_t));
+        pMainDB->dashboard_node->R2D = 1;
+        (void)ev_Post(EV_R2D_PRESSED);
     }
-    
+    R2DLevel = r2d;
 }
+
 void setInv1Av1Parameters(uint8_t* data)
 {
     pMainDB->vcu_node->keep_alive[INV1] = 1; // Set the inverter 1 alive
@@ -71,6 +137,8 @@ void setInv1Av1Parameters(uint8_t* data)
     memcpy(&pMainDB->vcu_node->inverters[0].actual_speed,&data[2], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[0].torque_current,&data[4], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[0].magnetizing_current,&data[6], sizeof(uint16_t));
+    InvPower(&pMainDB->vcu_node->inverters[0]);
+    InvStatusEvents();
 }
 void setInv1Av2Parameters(uint8_t* data)
 {
@@ -79,7 +147,9 @@ void setInv1Av2Parameters(uint8_t* data)
 
     memcpy(&pMainDB->vcu_node->inverters[0].motor_temperature,&data[0], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[0].plate_temperature,&data[2], sizeof(uint16_t));
+    memcpy(&pMainDB->vcu_node->inverters[0].igbt_temperature,&data[6], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->error_group.inv1_error,&data[4], sizeof(uint16_t));
+    pMainDB->vcu_node->inverters[0].av2_received = 1;
 }
 
 void setInv2Av1Parameters(uint8_t* data)
@@ -97,6 +167,8 @@ void setInv2Av1Parameters(uint8_t* data)
     memcpy(&pMainDB->vcu_node->inverters[1].actual_speed,&data[2], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[1].torque_current,&data[4], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[1].magnetizing_current,&data[6], sizeof(uint16_t));
+    InvPower(&pMainDB->vcu_node->inverters[1]);
+    InvStatusEvents();
 }
 void setInv2Av2Parameters(uint8_t* data)
 {
@@ -104,7 +176,9 @@ void setInv2Av2Parameters(uint8_t* data)
 
     memcpy(&pMainDB->vcu_node->inverters[1].motor_temperature,&data[0], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[1].plate_temperature,&data[2], sizeof(uint16_t));
+    memcpy(&pMainDB->vcu_node->inverters[1].igbt_temperature,&data[6], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->error_group.inv2_error,&data[4], sizeof(uint16_t));
+    pMainDB->vcu_node->inverters[1].av2_received = 1;
 }
 
 void setInv3Av1Parameters(uint8_t* data)
@@ -123,6 +197,8 @@ void setInv3Av1Parameters(uint8_t* data)
     memcpy(&pMainDB->vcu_node->inverters[2].actual_speed,&data[2], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[2].torque_current,&data[4], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[2].magnetizing_current,&data[6], sizeof(uint16_t));
+    InvPower(&pMainDB->vcu_node->inverters[2]);
+    InvStatusEvents();
 }
 void setInv3Av2Parameters(uint8_t* data)
 {
@@ -130,7 +206,9 @@ void setInv3Av2Parameters(uint8_t* data)
 
     memcpy(&pMainDB->vcu_node->inverters[2].motor_temperature,&data[0], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[2].plate_temperature,&data[2], sizeof(uint16_t));
+    memcpy(&pMainDB->vcu_node->inverters[2].igbt_temperature,&data[6], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->error_group.inv3_error,&data[4], sizeof(uint16_t));
+    pMainDB->vcu_node->inverters[2].av2_received = 1;
 }
 
 void setInv4Av1Parameters(uint8_t* data)
@@ -148,6 +226,8 @@ void setInv4Av1Parameters(uint8_t* data)
     memcpy(&pMainDB->vcu_node->inverters[3].actual_speed,&data[2], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[3].torque_current,&data[4], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[3].magnetizing_current,&data[6], sizeof(uint16_t));
+    InvPower(&pMainDB->vcu_node->inverters[3]);
+    InvStatusEvents();
 }
 
 void setInv4Av2Parameters(uint8_t* data)
@@ -156,7 +236,36 @@ void setInv4Av2Parameters(uint8_t* data)
     
     memcpy(&pMainDB->vcu_node->inverters[3].motor_temperature,&data[0], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->inverters[3].plate_temperature,&data[2], sizeof(uint16_t));
+    memcpy(&pMainDB->vcu_node->inverters[3].igbt_temperature,&data[6], sizeof(uint16_t));
     memcpy(&pMainDB->vcu_node->error_group.inv4_error,&data[4], sizeof(uint16_t));
+    pMainDB->vcu_node->inverters[3].av2_received = 1;
+}
+
+/**
+ * @brief Set the internal (on-board ADC) sensor values
+ * @param values Averaged ADC1 values, INTERNAL_SENSORS_NUM entries
+ * @param timestamp HAL tick of the ADC block
+ * @note  Called from the ADC mailbox reader, not from the CAN RX queue
+ */
+void setInternalSensorsParameters(const uint16_t* values, uint32_t timestamp)
+{
+    memcpy(pMainDB->vcu_node->internal_sensors.adc1, values, sizeof(pMainDB->vcu_node->internal_sensors.adc1));
+    pMainDB->vcu_node->internal_sensors.timestamp = timestamp;
+    for (uint8_t i = 0; i < INTERNAL_SENSORS_NUM; i++)
+    {
+        pMainDB->vcu_node->internal_sensors.calibrated[i] = cal_Apply((CalChannel_t)i, values[i]);
+    }
+}
+
+/**
+ * @brief Decode the IMU frame
+ * @param data accel_x in data[0..1], int16 in 0.01 m/s^2, forward positive
+ * @note  The IMU is optional and has no keep alive, the consumer checks that frames moves
+ */
+void setImuParameters(uint8_t* data)
+{
+    memcpy(&pMainDB->vcu_node->imu.accel_x, &data[0], sizeof(int16_t));
+    pMainDB->vcu_node->imu.frames++;
 }
 
 // ! meanwhile, these functions are not implemented yet maybe not relvante to vcu
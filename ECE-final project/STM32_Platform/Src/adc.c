@@ -10,30 +10,40 @@ ADC_HandleTypeDef *pAdc3;
 
 static handler_set_t* pHandlers = NULL; // Pointer to the handler set form the platform layer
 static plt_callbacks_t* pCallbacks = NULL; // Pointer to the callback function pointers from the platform layer
-static Queue_t* pCanRxQueue = NULL; // Pointer to the CAN RX queue from the platform layer
-static can_message_t msg = {0}; 
-//static Queue_t* pUartRxQueue = NULL; // Pointer to the UART RX queue from the platform layer
-//static uart_message_t uart_msg = {0};
-
 
+/**
+ * @brief Latest-value mailbox of one ADC
+ * @note  Written by the DMA complete interrupt, read by the control loop with plt_AdcRead.
+ *        The sequence is odd while the interrupt is updating the mailbox (sequence lock),
+ *        so the reader never needs to disable interrupts.
+ */
+typedef struct{
+    volatile uint32_t sequence;
+    uint32_t timestamp;
+    uint16_t values[ADC_MAX_SENSORS];
+}adc_mailbox_t;
 
+static adc_mailbox_t AdcMailbox[3]; // One mailbox per ADC, indexed by Adc_Module_t - 1
 
-uint16_t ADC1_UF_Buffer[ADC1_TOTAL_BUFFER_SIZE];  // ADC Data Buffer
+__ALIGNED(4) uint16_t ADC1_UF_Buffer[ADC1_TOTAL_BUFFER_SIZE];  // ADC Data Buffer (word aligned for the SIMD kernel)
 uint16_t ADC1_AVG_Samples[ADC1_NUM_SENSORS];  // Stores the averaged sensor values
 
-uint16_t ADC2_UF_Buffer[ADC2_TOTAL_BUFFER_SIZE];  // ADC Data Buffer
+__ALIGNED(4) uint16_t ADC2_UF_Buffer[ADC2_TOTAL_BUFFER_SIZE];  // ADC Data Buffer (word aligned for the SIMD kernel)
 uint16_t ADC2_AVG_Samples[ADC2_NUM_SENSORS];  // Stores the averaged sensor values
 
-uint16_t ADC3_UF_Buffer[ADC3_TOTAL_BUFFER_SIZE];  // ADC Data Buffer
+__ALIGNED(4) uint16_t ADC3_UF_Buffer[ADC3_TOTAL_BUFFER_SIZE];  // ADC Data Buffer (word aligned for the SIMD kernel)
 uint16_t ADC3_AVG_Samples[ADC3_NUM_SENSORS];  // Stores the averaged sensor values
 
+#ifdef ADC_BENCHMARK
+uint32_t ADC_LastProcessCycles = 0;  // DWT cycles spent in the last plt_AdcProcessData call
+#endif
+
 
 
 void plt_AdcInit() 
 {
     pHandlers = plt_GetHandlersPointer(); // Get the platform layer handlers pointer
     pCallbacks = plt_GetCallbacksPointer(); // Get the platform layer Callbacks pointer
-    pCanRxQueue = plt_GetCanRxQueue(); // Get the CAN RX queue pointer
     
     // Initialize the ADC1 peripheral
     if (pHandlers->hadc1 != NULL) 
@@ -58,62 +68,91 @@ void plt_AdcInit()
         HAL_ADC_Start_DMA(pAdc3, (uint32_t*)ADC3_UF_Buffer, ADC3_TOTAL_BUFFER_SIZE);
     }
 
-    msg.id = Internal_ADC; // Set the message ID for the CAN message
+    #ifdef ADC_BENCHMARK
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable the DWT cycle counter
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
 }
 
 
 /**
- * @brief Process the ADC data and store it in DB using the CAN-RxQueue
+ * @brief Publish new averages into the mailbox of an ADC
+ * @param pBox       Pointer to the ADC mailbox
+ * @param values     Averaged sensor values
+ * @param numSensors Number of values
+ * @note  Called in interrupt context only, see adc_mailbox_t for the sequence lock.
+ */
+static inline void adc_MailboxWrite(adc_mailbox_t* pBox, const uint16_t* values, uint16_t numSensors)
+{
+    pBox->sequence++;   // odd: update in progress
+    __DMB();
+    memcpy(pBox->values, values, numSensors * sizeof(uint16_t));
+    pBox->timestamp = HAL_GetTick();
+    __DMB();
+    pBox->sequence++;   // even: mailbox is consistent
+}
+
+/**
+ * @brief Process the ADC data and publish it in the ADC mailbox
  * @param UF_Buffer Pointer to the Unfiltered ADC data buffer
  * @param Size Size of the Unfiltered buffer
+ * @note  Runs in the DMA complete interrupt, the averaging kernel is picked per ADC
+ *        at compile time (see ADC_AVERAGE). Define ADC_BENCHMARK to record the
+ *        DWT cycle count of the last call in ADC_LastProcessCycles.
  * TODO: add error check on the values
- * TODO : this setup need to be checked that it not taking to long to process the data
- * TODO : try to figureout if we can change the number of sensors to 3 fixed make the code more easy and efficent.
  * TODO : check if we can use DMA circular mode to remove the DMA_Start and Stop calls
  * 
  */
 void plt_AdcProcessData(uint16_t *UF_Buffer, uint16_t Size)
 {
-/* ---------- 1.  Pick the right metadata for the buffer we got ---------- */
-uint16_t   numSensors;
-uint16_t   samplesPerSensor;
-uint16_t  *avgSamples;
-
-
-if (UF_Buffer == ADC1_UF_Buffer) {        /* ADC-1 */
-    numSensors       = ADC1_NUM_SENSORS;
-    samplesPerSensor = ADC1_SAMPLES_PER_SENSOR;
-    avgSamples       = ADC1_AVG_Samples;
-    
-} else if (UF_Buffer == ADC2_UF_Buffer) { /* ADC-2 */
-    numSensors       = ADC2_NUM_SENSORS;
-    samplesPerSensor = ADC2_SAMPLES_PER_SENSOR;
-    avgSamples       = ADC2_AVG_Samples;
-  
-} else if (UF_Buffer == ADC3_UF_Buffer) { /* ADC-3 */
-    numSensors       = ADC3_NUM_SENSORS;
-    samplesPerSensor = ADC3_SAMPLES_PER_SENSOR;
-    avgSamples       = ADC3_AVG_Samples;
-   
-} else {
-    return;                               /* unknown buffer-ptr → ignore  */
-}
+    #ifdef ADC_BENCHMARK
+    uint32_t start = DWT->CYCCNT;
+    #endif
+
+    if (UF_Buffer == ADC1_UF_Buffer) {        /* ADC-1 */
+        ADC_AVERAGE(ADC1_NUM_SENSORS, UF_Buffer, Size / ADC1_NUM_SENSORS, ADC1_AVG_Samples);
+        adc_MailboxWrite(&AdcMailbox[Adc1 - 1], ADC1_AVG_Samples, ADC1_NUM_SENSORS);
+    } else if (UF_Buffer == ADC2_UF_Buffer) { /* ADC-2 */
+        ADC_AVERAGE(ADC2_NUM_SENSORS, UF_Buffer, Size / ADC2_NUM_SENSORS, ADC2_AVG_Samples);
+        adc_MailboxWrite(&AdcMailbox[Adc2 - 1], ADC2_AVG_Samples, ADC2_NUM_SENSORS);
+    } else if (UF_Buffer == ADC3_UF_Buffer) { /* ADC-3 */
+        ADC_AVERAGE(ADC3_NUM_SENSORS, UF_Buffer, Size / ADC3_NUM_SENSORS, ADC3_AVG_Samples);
+        adc_MailboxWrite(&AdcMailbox[Adc3 - 1], ADC3_AVG_Samples, ADC3_NUM_SENSORS);
+    } else {
+        return;                               /* unknown buffer-ptr → ignore  */
+    }
 
-/* ---------- 2.  Single-pass accumulation (fast, cache-friendly) -------- */
-uint32_t sums[numSensors] = {0};     /* ADC1_NUM_SENSORS == 3       */
-for (uint16_t i = 0; i < Size; ++i) {
-    sums[i % numSensors] +=UF_Buffer[i]  ; // subtract the min value from the sensor value);
+    #ifdef ADC_BENCHMARK
+    ADC_LastProcessCycles = DWT->CYCCNT - start;
+    #endif
 }
 
-/* ---------- 3.  Convert to averages ------------------------------------ */
-for (uint16_t i = 0; i < numSensors; ++i) {
-    avgSamples[i] = (uint16_t)(sums[i] / samplesPerSensor);
-}
+/**
+ * @brief Read the latest averaged values of an ADC
+ * @param adc_module The ADC to read
+ * @param pSample    Pointer to the sample to fill (values, timestamp and sequence)
+ * @retval 1 if the ADC has published at least one block, 0 otherwise
+ * @note  Lock free, safe to call from the main loop while the DMA interrupt is running.
+ *        Compare pSample->sequence with the previous read to detect a new block.
+ */
+uint8_t plt_AdcRead(Adc_Module_t adc_module, adc_sample_t* pSample)
+{
+    if (adc_module < Adc1 || adc_module > Adc3) return 0;
+    adc_mailbox_t* pBox = &AdcMailbox[adc_module - 1];
+    uint32_t sequence;
 
-/* copy the averages (6 bytes for 3×uint16_t) and clear any padding       */
-memset(msg.data, 0, sizeof(msg.data));
-memcpy(msg.data, avgSamples, numSensors * sizeof(uint16_t));
-Queue_Push(pCanRxQueue, &msg);
+    do
+    {
+        sequence = pBox->sequence;
+        __DMB();
+        memcpy(pSample->values, pBox->values, sizeof(pSample->values));
+        pSample->timestamp = pBox->timestamp;
+        __DMB();
+    } while ((sequence & 1U) || (sequence != pBox->sequence)); // retry if the interrupt wrote meanwhile
+
+    pSample->sequence = sequence;
+    return (sequence != 0) ? 1 : 0;
 }
 
 /*
@@ -168,24 +207,4 @@ void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
     HAL_ADC_Start_DMA(pAdc3, (uint32_t*)ADC3_UF_Buffer, ADC3_TOTAL_BUFFER_SIZE);
   }
 }
-
-void plt_AdcSetMinMax(Adc_Module_t adc_module,uint16_t *min, uint16_t *max)
-{
-    switch (adc_module) {
-        case Adc1:
-            memcpy(ADC1_Mins, min, sizeof(ADC1_Mins));
-            memcpy(ADC1_Maxs, max, sizeof(ADC1_Maxs));
-            break;
-        case Adc2:
-            memcpy(ADC2_Mins, min, sizeof(ADC2_Mins));
-            memcpy(ADC2_Maxs, max, sizeof(ADC2_Maxs));
-            break;
-        case Adc3:
-            memcpy(ADC3_Mins, min, sizeof(ADC3_Mins));
-            memcpy(ADC3_Maxs, max, sizeof(ADC3_Maxs));
-            break;
-        default:
-            break;
-    }
-}
 #endif
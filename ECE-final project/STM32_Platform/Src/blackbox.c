@@ -0,0 +1,259 @@
+#include "blackbox.h"
+
+// Black box: Streams DB snapshots and CAN frames to the external SPI NOR flash (norlog.c)
+
+#ifdef HAL_SPI_MODULE_ENABLED
+/* =============================== Defines ======================================= */
+#define NOR_CMD_WREN   0x06  // Write enable
+#define NOR_CMD_RDSR   0x05  // Read status register
+#define NOR_CMD_READ   0x03  // Read data
+#define NOR_CMD_PP     0x02  // Page program
+#define NOR_CMD_SE     0x20  // Sector erase
+#define NOR_SR_WIP     0x01  // Write in progress
+#define NOR_HEADER     4     // Command and 24 bit address
+
+/* =============================== Global Variables =============================== */
+static nlog_ops_t FlashOps;
+static uint8_t Mounted = 0;
+
+static volatile uint8_t Pending = 0;      // Transactions submitted and not done yet
+static volatile uint8_t WriteBusy = 0;    // 1 until the status register reports the program/erase done
+static volatile uint8_t TxnError = 0;     // A transaction failed since the last check
+
+static spi_transaction_t WrenTxn;
+static spi_transaction_t CmdTxn;          // Program, erase or read
+static spi_transaction_t StatusTxn;
+static const uint8_t WrenCmd = NOR_CMD_WREN;
+static const uint8_t StatusCmd[2] = {NOR_CMD_RDSR, 0};
+static uint8_t StatusRx[2];
+static uint8_t CmdTx[NOR_HEADER + BBX_PAGE_SIZE];
+static uint8_t CmdRx[NOR_HEADER + BBX_PAGE_SIZE];
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Completion of a flash transaction (interrupt context)
+ */
+static void bbx_TxnDone(spi_transaction_t* txn, HAL_StatusTypeDef status)
+{
+    if (status != HAL_OK)
+    {
+        TxnError = 1;
+        WriteBusy = 0;  // Nothing was started, do not poll forever
+    }
+    else if (txn == &StatusTxn && (StatusRx[1] & NOR_SR_WIP) == 0)
+    {
+        WriteBusy = 0;
+    }
+    Pending--;
+}
+
+/**
+ * @brief Fill a transaction of the chip select and done callback of the flash
+ */
+static void bbx_TxnInit(spi_transaction_t* txn, const uint8_t* pTx, uint8_t* pRx, uint16_t len)
+{
+    txn->pTx = pTx;
+    txn->pRx = pRx;
+    txn->len = len;
+    txn->csPort = BBX_CS_PORT;
+    txn->csPin = BBX_CS_PIN;
+    txn->done = bbx_TxnDone;
+    txn->ctx = NULL;
+}
+
+/**
+ * @brief Queue a transaction
+ * @retval 1 if queued, 0 otherwise
+ */
+static uint8_t bbx_Submit(spi_transaction_t* txn)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Pending++;  // Decremented by bbx_TxnDone in interrupt context
+    __set_PRIMASK(primask);
+
+    if (plt_SpiSubmit(BBX_SPI_CHANEL, txn) != HAL_OK)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        Pending--;
+        __set_PRIMASK(primask);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Write the command and 24 bit address header
+ */
+static void bbx_Header(uint8_t cmd, uint32_t addr)
+{
+    CmdTx[0] = cmd;
+    CmdTx[1] = (uint8_t)(addr >> 16);
+    CmdTx[2] = (uint8_t)(addr >> 8);
+    CmdTx[3] = (uint8_t)addr;
+}
+
+/**
+ * @brief Start a write enable followed by a program or erase command
+ */
+static uint8_t bbx_StartWrite(uint16_t len)
+{
+    bbx_TxnInit(&CmdTxn, CmdTx, NULL, len);
+    WriteBusy = 1;
+    if (!bbx_Submit(&WrenTxn) || !bbx_Submit(&CmdTxn))
+    {
+        return 0;  // bbx_Busy waits for the queued part, WriteBusy is cleared by the status poll
+    }
+    return 1;
+}
+
+/**
+ * @brief Blocking read (mount only)
+ */
+static uint8_t bbx_Read(uint32_t addr, uint8_t* data, uint32_t len)
+{
+    while (len > 0)
+    {
+        uint16_t chunk = (len > BBX_PAGE_SIZE) ? BBX_PAGE_SIZE : (uint16_t)len;
+        uint32_t start = HAL_GetTick();
+
+        bbx_Header(NOR_CMD_READ, addr);
+        memset(&CmdTx[NOR_HEADER], 0, chunk);
+        bbx_TxnInit(&CmdTxn, CmdTx, CmdRx, (uint16_t)(NOR_HEADER + chunk));
+        TxnError = 0;
+        if (!bbx_Submit(&CmdTxn)) return 0;
+        while (Pending > 0)
+        {
+            if (HAL_GetTick() - start > BBX_READ_TIMEOUT) return 0;
+        }
+        if (TxnError) return 0;
+
+        memcpy(data, &CmdRx[NOR_HEADER], chunk);
+        data += chunk;
+        addr += chunk;
+        len -= chunk;
+    }
+    return 1;
+}
+
+/**
+ * @brief Start a page program
+ */
+static uint8_t bbx_Program(uint32_t addr, const uint8_t* data, uint16_t len)
+{
+    if (len > BBX_PAGE_SIZE) return 0;
+    bbx_Header(NOR_CMD_PP, addr);
+    memcpy(&CmdTx[NOR_HEADER], data, len);
+    return bbx_StartWrite((uint16_t)(NOR_HEADER + len));
+}
+
+/**
+ * @brief Start a sector erase
+ */
+static uint8_t bbx_Erase(uint32_t addr)
+{
+    bbx_Header(NOR_CMD_SE, addr);
+    return bbx_StartWrite(NOR_HEADER);
+}
+
+/**
+ * @brief Check if the flash is busy
+ * @note  Never waits: while a program or erase runs every call queues one status register
+ *        read, the answer is seen by the next call.
+ */
+static uint8_t bbx_Busy(void)
+{
+    if (Pending > 0) return 1;
+    if (WriteBusy)
+    {
+        bbx_Submit(&StatusTxn);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Initialize the black box and mount the log
+ * @retval 1 if the log is mounted, 0 otherwise (the black box stays disabled)
+ * @note  Call after plt_SpiInit. Blocks for the mount scan.
+ */
+uint8_t bbx_Init(void)
+{
+    HAL_GPIO_WritePin(BBX_CS_PORT, BBX_CS_PIN, GPIO_PIN_SET);
+    bbx_TxnInit(&WrenTxn, &WrenCmd, NULL, 1);
+    bbx_TxnInit(&StatusTxn, StatusCmd, StatusRx, sizeof(StatusCmd));
+
+    FlashOps.size = BBX_FLASH_SIZE;
+    FlashOps.segmentSize = BBX_SECTOR_SIZE;
+    FlashOps.pageSize = BBX_PAGE_SIZE;
+    FlashOps.read = bbx_Read;
+    FlashOps.program = bbx_Program;
+    FlashOps.erase = bbx_Erase;
+    FlashOps.busy = bbx_Busy;
+
+    Mounted = nlog_Mount(&FlashOps);
+    return Mounted;
+}
+
+/**
+ * @brief Log a DB snapshot
+ * @note  Call once per control tick, copies into RAM only.
+ */
+void bbx_LogSnapshot(const database_t* db)
+{
+    bbx_snapshot_t snap;
+
+    if (!Mounted) return;
+
+    snap.stage = (uint8_t)db->vcu_node->fsm_stage;
+    snap.r2d = db->dashboard_node->R2D;
+    snap.system_error = db->vcu_node->error_group.system_error;
+    snap.gas = db->pedal_node->gas_value;
+    snap.brake = db->pedal_node->brake_value;
+    snap.steering = db->pedal_node->steering_wheel_angle;
+    snap.biops = db->pedal_node->BIOPS;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        snap.speed[i] = db->vcu_node->inverters[i].actual_speed;
+        snap.torque[i] = db->vcu_node->inverters[i].torque;
+    }
+    snap.dc_bus_voltage = db->vcu_node->inverters[0].dc_bus_voltage;
+
+    nlog_Write(BBX_REC_SNAPSHOT, HAL_GetTick(), &snap, sizeof(snap));
+}
+
+/**
+ * @brief Log a received CAN frame
+ * @note  Call from the CAN RX processing (main loop), copies into RAM only.
+ */
+void bbx_LogCan(const can_message_t* msg)
+{
+    bbx_can_t rec;
+
+    if (!Mounted) return;
+
+    rec.id = msg->id;
+    memcpy(rec.data, msg->data, sizeof(rec.data));
+    nlog_Write(BBX_REC_CAN, HAL_GetTick(), &rec, sizeof(rec));
+}
+
+/**
+ * @brief Move the log to the flash
+ * @note  Call from the main loop, starts at most one flash operation and never waits.
+ */
+void bbx_Process(void)
+{
+    if (Mounted) nlog_Process();
+}
+
+/**
+ * @brief Get the log statistics
+ */
+void bbx_GetStats(nlog_stats_t* stats)
+{
+    nlog_GetStats(stats);
+}
+
+#endif
@@ -0,0 +1,280 @@
+#include "calibration.h"
+#include <string.h>
+#include <stdlib.h>
+
+// Calibration: Pedal sensor min/max capture, fixed-point scaling and flash persistence
+
+/* =============================== Global Variables =============================== */
+static const cal_flash_t* pFlash = NULL;           // Flash interface in use
+static cal_record_t Calibration = {0};             // Active calibration (RAM copy)
+static uint8_t CalibrationValid = 0;
+static uint32_t NextRecordOffset = 0;               // First free record slot in the sector
+
+static CalState_t CaptureState = CAL_IDLE;
+static CalError_t CaptureError = CAL_ERR_NONE;
+static cal_record_t Capture;                        // Scratch record of the running capture
+static uint32_t CaptureStart = 0;
+static uint32_t RestSum[CAL_NUM_CHANNELS];
+static uint16_t RestCount = 0;
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Check the magic, version and CRC of a record
+ */
+static uint8_t cal_RecordIsValid(const cal_record_t* record)
+{
+    if (record->magic != CAL_MAGIC || record->version != CAL_VERSION) return 0;
+    return (Crc16_Calc((const uint8_t*)record, offsetof(cal_record_t, crc), CRC16_INIT) == record->crc) ? 1 : 0;
+}
+
+/**
+ * @brief Get the record in a slot of the sector
+ */
+static const cal_record_t* cal_Slot(uint32_t slot)
+{
+    return (const cal_record_t*)&pFlash->base[slot * sizeof(cal_record_t)];
+}
+
+/**
+ * @brief Append a record to the sector
+ * @param record Record to write, magic, version, sequence and CRC are filled in here
+ * @retval 1 on success, 0 on failure
+ * @note  The sector is erased only when there is no free slot left.
+ */
+static uint8_t cal_Append(cal_record_t* record)
+{
+    if (pFlash == NULL) return 0;
+
+    record->magic = CAL_MAGIC;
+    record->version = CAL_VERSION;
+    record->sequence++;
+    record->reserved = 0xFFFF;
+    record->crc = Crc16_Calc((const uint8_t*)record, offsetof(cal_record_t, crc), CRC16_INIT);
+
+    if (NextRecordOffset + sizeof(cal_record_t) > pFlash->size)
+    {
+        if (!pFlash->erase()) return 0;
+        NextRecordOffset = 0;
+    }
+
+    if (!pFlash->program(NextRecordOffset, (const uint8_t*)record, sizeof(cal_record_t))) return 0;
+    NextRecordOffset += sizeof(cal_record_t);
+    return 1;
+}
+
+/**
+ * @brief Set the flash interface used for the calibration records
+ * @param flash Pointer to the flash interface
+ * @note  The internal flash sector on the target, a RAM region on the host.
+ */
+void cal_SetFlash(const cal_flash_t* flash)
+{
+    pFlash = flash;
+}
+
+/**
+ * @brief Load the last valid calibration record from flash
+ * @retval 1 if a valid calibration was loaded, 0 otherwise
+ * @note  Records are only appended, so the written slots come before the erased ones:
+ *        a binary search on the magic finds the first erased slot (log2 of the slot
+ *        count, 12 reads for the 128 KB sector), then the records are checked backwards
+ *        from there. Normally the last one is valid and a single CRC is computed, the
+ *        boot load stays in the microseconds however full the sector is.
+ */
+uint8_t cal_Init(void)
+{
+    uint32_t low = 0, high;
+
+    memset(&Calibration, 0, sizeof(Calibration));
+    CalibrationValid = 0;
+    CaptureState = CAL_IDLE;
+    CaptureError = CAL_ERR_NONE;
+    if (pFlash == NULL) return 0;
+
+    high = pFlash->size / sizeof(cal_record_t);
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (cal_Slot(mid)->magic == CAL_ERASED) high = mid;
+        else                                    low = mid + 1;
+    }
+    NextRecordOffset = low * sizeof(cal_record_t);
+
+    while (low > 0)
+    {
+        const cal_record_t* record = cal_Slot(--low);
+        if (cal_RecordIsValid(record))
+        {
+            memcpy(&Calibration, record, sizeof(cal_record_t));
+            CalibrationValid = 1;
+            break;
+        }
+    }
+    return CalibrationValid;
+}
+
+/**
+ * @brief Get the calibration status
+ * @retval 1 if a valid calibration is active, 0 otherwise
+ */
+uint8_t cal_IsValid(void)
+{
+    return CalibrationValid;
+}
+
+/**
+ * @brief Convert a raw sensor value to the calibrated range
+ * @param channel The calibration channel
+ * @param raw     The raw ADC value
+ * @retval Value in 0..CAL_OUTPUT_RANGE, 0 if the channel is not calibrated
+ * @note  One multiply and one shift per sample (rounded), the division is done once when
+ *        the calibration is computed.
+ */
+uint16_t cal_Apply(CalChannel_t channel, uint16_t raw)
+{
+    if (!CalibrationValid) return 0;
+
+    int32_t delta = (int32_t)raw - (int32_t)Calibration.rest[channel];
+    int32_t value = (int32_t)(((int64_t)delta * Calibration.scale[channel] + 0x8000) >> 16);
+
+    if (value < 0) value = 0;
+    if (value > CAL_OUTPUT_RANGE) value = CAL_OUTPUT_RANGE;
+    return (uint16_t)value;
+}
+
+/**
+ * @brief Start the guided min/max capture
+ * @param now Current tick [ms]
+ * @note  The driver first keeps the pedals released for CAL_REST_TIME_MS, then presses
+ *        them fully (several times) during CAL_FULL_TIME_MS. The capture fills a scratch
+ *        record, the active calibration stays in use until the new one is validated and
+ *        saved to flash.
+ */
+void cal_StartCapture(uint32_t now)
+{
+    memset(&Capture, 0, sizeof(Capture));
+    memset(RestSum, 0, sizeof(RestSum));
+    RestCount = 0;
+    CaptureStart = now;
+    CaptureError = CAL_ERR_NONE;
+    CaptureState = CAL_CAPTURE_REST;
+}
+
+/**
+ * @brief Abort a running capture
+ * @note  The scratch record is dropped, the active calibration is not touched.
+ */
+void cal_AbortCapture(void)
+{
+    if (CaptureState == CAL_CAPTURE_REST || CaptureState == CAL_CAPTURE_FULL)
+    {
+        CaptureState = CAL_FAILED;
+        CaptureError = CAL_ERR_ABORTED;
+    }
+}
+
+/**
+ * @brief Feed one set of raw values to the capture routine
+ * @param raw Raw values of all CAL_NUM_CHANNELS channels
+ * @param now Current tick [ms]
+ * @note  Called for every new ADC block, does nothing when no capture is running.
+ *        A span below CAL_MIN_SPAN or a failed flash write ends in CAL_FAILED with
+ *        the previous calibration still active.
+ */
+void cal_CaptureStep(const uint16_t* raw, uint32_t now)
+{
+    uint32_t elapsed = now - CaptureStart;
+
+    switch (CaptureState)
+    {
+    case CAL_CAPTURE_REST:
+        for (uint8_t i = 0; i < CAL_NUM_CHANNELS; i++) RestSum[i] += raw[i];
+        RestCount++;
+        if (elapsed >= CAL_REST_TIME_MS)
+        {
+            for (uint8_t i = 0; i < CAL_NUM_CHANNELS; i++)
+            {
+                Capture.rest[i] = (uint16_t)(RestSum[i] / RestCount);
+                Capture.full[i] = Capture.rest[i];
+            }
+            CaptureStart = now;
+            CaptureState = CAL_CAPTURE_FULL;
+        }
+        break;
+
+    case CAL_CAPTURE_FULL:
+        // Keep the value farthest from rest, works for rising and falling sensors
+        for (uint8_t i = 0; i < CAL_NUM_CHANNELS; i++)
+        {
+            if (abs((int32_t)raw[i] - Capture.rest[i]) > abs((int32_t)Capture.full[i] - Capture.rest[i]))
+            {
+                Capture.full[i] = raw[i];
+            }
+        }
+        if (elapsed >= CAL_FULL_TIME_MS)
+        {
+            for (uint8_t i = 0; i < CAL_NUM_CHANNELS; i++)
+            {
+                int32_t span = (int32_t)Capture.full[i] - (int32_t)Capture.rest[i];
+                if (abs(span) < CAL_MIN_SPAN)
+                {
+                    CaptureState = CAL_FAILED;
+                    CaptureError = CAL_ERR_SPAN;
+                    return;
+                }
+                Capture.scale[i] = ((int32_t)CAL_OUTPUT_RANGE << 16) / span;
+            }
+            Capture.sequence = Calibration.sequence;
+            if (cal_Append(&Capture))
+            {
+                memcpy(&Calibration, &Capture, sizeof(cal_record_t));
+                CalibrationValid = 1;
+                CaptureState = CAL_DONE;
+            }
+            else
+            {
+                CaptureState = CAL_FAILED;
+                CaptureError = CAL_ERR_FLASH;
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Get the state of the capture routine
+ */
+CalState_t cal_GetState(void)
+{
+    return CaptureState;
+}
+
+/**
+ * @brief Get why the last capture failed
+ */
+CalError_t cal_GetError(void)
+{
+    return CaptureError;
+}
+
+/**
+ * @brief Append the active calibration as a new record in flash
+ * @retval 1 on success, 0 on failure
+ */
+uint8_t cal_Save(void)
+{
+    return CalibrationValid ? cal_Append(&Calibration) : 0;
+}
+
+/**
+ * @brief Get the active calibration record
+ * @retval Pointer to the RAM copy of the active record
+ */
+const cal_record_t* cal_GetRecord(void)
+{
+    return &Calibration;
+}
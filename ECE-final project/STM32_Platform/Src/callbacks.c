@@ -7,8 +7,60 @@ plt_callbacks_t pcallbacks;
 Set_Function_t pSet_Function;
 
 
+#ifdef HAL_ADC_MODULE_ENABLED
+static uint8_t CalFlashErase(void);
+static uint8_t CalFlashProgram(uint32_t offset, const uint8_t* data, uint32_t len);
+
+static const cal_flash_t CalFlash = {
+    .base = (const uint8_t*)CAL_FLASH_ADDR,
+    .size = CAL_FLASH_SIZE,
+    .erase = CalFlashErase,
+    .program = CalFlashProgram
+};
+#endif
+
 /* ========================== Function Definitions ============================ */
 
+#ifdef HAL_ADC_MODULE_ENABLED
+/**
+ * @brief Erase the calibration sector, flash interface of calibration.c
+ */
+static uint8_t CalFlashErase(void)
+{
+    return (plt_FlashErase(CAL_FLASH_SECTOR) == HAL_OK) ? 1 : 0;
+}
+
+/**
+ * @brief Program a calibration record, flash interface of calibration.c
+ */
+static uint8_t CalFlashProgram(uint32_t offset, const uint8_t* data, uint32_t len)
+{
+    return (plt_FlashProgram(CAL_FLASH_ADDR + offset, data, len) == HAL_OK) ? 1 : 0;
+}
+
+/**
+ * @brief Log the prompts and the result of a calibration capture
+ * @note  Called after every capture step, logs each state change once.
+ */
+static void CalibrationReport(void)
+{
+    static CalState_t last = CAL_IDLE;
+    CalState_t state = cal_GetState();
+
+    if (state == last) return;
+    last = state;
+    switch (state)
+    {
+    case CAL_CAPTURE_REST: LOG("Calibration: release the pedals"); break;
+    case CAL_CAPTURE_FULL: LOG("Calibration: press the pedals fully"); break;
+    case CAL_DONE:         LOG("Calibration: saved"); break;
+    case CAL_FAILED:       LOG("Calibration: failed, error %u, previous calibration kept", cal_GetError()); break;
+    default: break;
+    }
+}
+#endif
+
+
  /**
   * @brief Initialize the platform layer with the provided handlers and RxQueueSize
   * @param handlers Pointer to the handler set for the platform layer
@@ -19,6 +71,8 @@ Set_Function_t pSet_Function;
  {
     // Initialize the platform layer with the provided handlers and RxQueueSize
     
+    log_Init();
+    prf_Init();
     pMainDB = db_Init();
     //pUartTxQueue = plt_GetUartTxQueue(); // Get the UART transmission queue pointer
     plt_SetHandlers(handlers);
@@ -28,28 +82,38 @@ Set_Function_t pSet_Function;
 
     #ifdef HAL_CAN_MODULE_ENABLED
     plt_CanInit(RxQueueSize);
-    printf("CAN Initialized \r\n");
+    LOG("CAN Initialized");
     #endif
 
     #ifdef HAL_UART_MODULE_ENABLED
     plt_UartInit(RxQueueSize);
     pUartTxQueue = plt_GetUartTxQueue(); // Get the UART transmission queue pointer
-    printf("UART Initialized \r\n");
+    ShellInit();
+    LOG("UART Initialized");
     #endif
 
     #ifdef HAL_SPI_MODULE_ENABLED
-    plt_SpiInit(RxQueueSize);
-    printf("SPI Initialized \r\n");
+    plt_SpiInit();
+    LOG("SPI Initialized");
+    if(!bbx_Init())
+    {
+      LOG("Black box flash not mounted");
+    }
     #endif
 
     #ifdef HAL_ADC_MODULE_ENABLED
     plt_AdcInit();
-    printf("ADC Initialized \r\n");
+    LOG("ADC Initialized");
+    cal_SetFlash(&CalFlash);
+    if(!cal_Init())
+    {
+      LOG("No pedal calibration in flash");
+    }
     #endif
 
     #ifdef HAL_TIM_MODULE_ENABLED
     plt_TimInit();
-    printf("Advanced TIM Initialized \r\n");
+    LOG("Advanced TIM Initialized");
     #endif
  }
 
@@ -69,6 +133,9 @@ void CanRxCallback(can_message_t *msg)
     pSet_Function(msg->data); // Call the set function for the received message
   }
     */
+  #ifdef HAL_SPI_MODULE_ENABLED
+  bbx_LogCan(msg);
+  #endif
   switch (msg->id) // Replace with actual condition
   {
     case PEDAL_ID:
@@ -76,38 +143,33 @@ void CanRxCallback(can_message_t *msg)
       break;
     case DB_ID:
       setDBParameters(msg->data);
-      break;\
+      break;
     case INV1_AV1_ID:
-      msg->data[0] = 1; // Inverter number change before calling this function
       setInv1Av1Parameters(msg->data);
       break;
     case INV2_AV1_ID:
-      msg->data[0] = 2; // Inverter number change before calling this function
       setInv2Av1Parameters(msg->data);
       break;
     case INV3_AV1_ID:
-      msg->data[0] = 3; // Inverter number change before calling this function
       setInv3Av1Parameters(msg->data);
       break;
     case INV4_AV1_ID:
-      msg->data[0] = 4; // Inverter number change before calling this function
       setInv4Av1Parameters(msg->data);
       break;
     case INV1_AV2_ID:
-      msg->data[6] = 1; // Inverter number change before calling this function
       setInv1Av2Parameters(msg->data);
       break;
     case INV2_AV2_ID:
-      msg->data[6] = 2; // Inverter number change before calling this function
       setInv2Av2Parameters(msg->data);
       break;
     case INV3_AV2_ID:
-      msg->data[6] = 3; // Inverter number change before calling this function
       setInv3Av2Parameters(msg->data);
       break;
     case INV4_AV2_ID:
-      msg->data[6] = 4; // Inverter number change before calling this function
-      setInv4Av1Parameters(msg->data);
+      setInv4Av2Parameters(msg->data);
+      break;
+    case IMU_ID:
+      setImuParameters(msg->data);
       break;
     
     default:
@@ -115,6 +177,27 @@ void CanRxCallback(can_message_t *msg)
   }
 }
 
+/**
+ * @brief Copy a new ADC block from the ADC mailbox into the DB
+ * @note This function is called from the control loop. On-board sensors do not go
+ *       through the CAN-RxQueue, the latest averages are read directly from the mailbox.
+ */
+void InternalSensorsUpdate(void)
+{
+  #ifdef HAL_ADC_MODULE_ENABLED
+  static uint32_t lastSequence = 0;
+  adc_sample_t sample;
+
+  if (plt_AdcRead(Adc1, &sample) && sample.sequence != lastSequence)
+  {
+    lastSequence = sample.sequence;
+    cal_CaptureStep(sample.values, HAL_GetTick()); // No-op unless a calibration capture is running
+    CalibrationReport();
+    setInternalSensorsParameters(sample.values, sample.timestamp);
+  }
+  #endif
+}
+
 /**
  * @brief Callback function for handling SPI messages from the SPI-RxQueue and store the data in the DB.
  * @param msg Pointer to the received SPI message
@@ -152,6 +235,7 @@ void SetCallbacks() {
     #endif
     #ifdef HAL_UART_MODULE_ENABLED
     pcallbacks.UART_RxCallback = UartRxCallback;
+    pcallbacks.UART_TxCallback = NULL;
     #endif
     #ifdef HAL_SPI_MODULE_ENABLED
     pcallbacks.SPI_RxCallback = SpiRxCallback;
@@ -159,3 +243,223 @@ void SetCallbacks() {
     #endif
  }
 
+/* ============================== Debug Shell ============================== */
+#ifdef HAL_UART_MODULE_ENABLED
+
+/**
+ * @brief Shell parameter table
+ * @note  Fields of params_t that can be changed live with the shell set command
+ */
+static const shell_param_t ShellParams[] = {
+    {"hb_gas_high",      SH_U16, offsetof(params_t, hb_gas_high),      0,     1000},
+    {"hb_gas_low",       SH_U16, offsetof(params_t, hb_gas_low),       0,     1000},
+    {"hb_brake_high",    SH_U16, offsetof(params_t, hb_brake_high),    0,     1000},
+    {"max_velocity",     SH_U16, offsetof(params_t, max_velocity),     0,     20000},
+    {"r2d_timeout",      SH_U8,  offsetof(params_t, r2d_timeout),      1,     250},
+    {"pos_torque_limit", SH_I16, offsetof(params_t, pos_torque_limit), 0,     1000},
+    {"neg_torque_limit", SH_I16, offsetof(params_t, neg_torque_limit), -1000, 0},
+    {"tv_enable",        SH_U8,  offsetof(params_t, tv_enable),        0,     1},
+    {"tv_front_split",   SH_F32, offsetof(params_t, tv_front_split),   0,     1},
+    {"tv_yaw_ff",        SH_F32, offsetof(params_t, tv_yaw_ff),        0,     2000},
+    {"tv_yaw_kp",        SH_F32, offsetof(params_t, tv_yaw_kp),        0,     2000},
+    {"tc_enable",        SH_U8,  offsetof(params_t, tc_enable),        0,     1},
+    {"tc_slip_target",   SH_F32, offsetof(params_t, tc_slip_target),   0,     1},
+    {"tc_kp",            SH_F32, offsetof(params_t, tc_kp),            0,     2000},
+    {"tc_ki",            SH_F32, offsetof(params_t, tc_ki),            0,     20000},
+    {"tc_accel_limit",   SH_F32, offsetof(params_t, tc_accel_limit),   1,     30},
+    {"lc_enable",        SH_U8,  offsetof(params_t, lc_enable),        0,     1},
+    {"lc_gas_min",       SH_U16, offsetof(params_t, lc_gas_min),       0,     100},
+    {"lc_torque_scale",  SH_F32, offsetof(params_t, lc_torque_scale),  0,     1},
+    {"lc_slip_target",   SH_F32, offsetof(params_t, lc_slip_target),   0,     1},
+    {"lc_exit_speed",    SH_F32, offsetof(params_t, lc_exit_speed),    1,     40},
+    {"rg_enable",        SH_U8,  offsetof(params_t, rg_enable),        0,     0},  // 1 once dc_bus_voltage is decoded
+    {"rg_max_torque",    SH_F32, offsetof(params_t, rg_max_torque),    0,     21},
+    {"rg_front_split",   SH_F32, offsetof(params_t, rg_front_split),   0,     1},
+    {"rg_pedal_start",   SH_F32, offsetof(params_t, rg_pedal_start),   0,     100},
+    {"rg_pedal_full",    SH_F32, offsetof(params_t, rg_pedal_full),    0,     100},
+    {"rg_volt_start",    SH_F32, offsetof(params_t, rg_volt_start),    0,     600},
+    {"rg_volt_max",      SH_F32, offsetof(params_t, rg_volt_max),      0,     600},
+    {"rg_temp_start",    SH_F32, offsetof(params_t, rg_temp_start),    0,     120},
+    {"rg_temp_max",      SH_F32, offsetof(params_t, rg_temp_max),      0,     120},
+    {"rg_rate",          SH_F32, offsetof(params_t, rg_rate),          1,     5000},
+    {"pm_mode",          SH_U8,  offsetof(params_t, pm_mode),          0,     3},
+    {"pl_enable",        SH_U8,  offsetof(params_t, pl_enable),        0,     1},
+    {"pl_limit",         SH_F32, offsetof(params_t, pl_limit),         0,     80000},
+    {"pl_margin",        SH_F32, offsetof(params_t, pl_margin),        0,     20000},
+    {"th_enable",        SH_U8,  offsetof(params_t, th_enable),        0,     1},
+    {"th_horizon",       SH_F32, offsetof(params_t, th_horizon),       0,     60},
+    {"th_recovery",      SH_F32, offsetof(params_t, th_recovery),      0.001, 1},
+    {"th_warning",       SH_F32, offsetof(params_t, th_warning),       0,     1},
+    {"est_enable",       SH_U8,  offsetof(params_t, est_enable),       0,     1},
+    {"est_jerk",         SH_F32, offsetof(params_t, est_jerk),         0.1,   1000},
+    {"est_wheel_noise",  SH_F32, offsetof(params_t, est_wheel_noise),  0.001, 10},
+    {"est_accel_noise",  SH_F32, offsetof(params_t, est_accel_noise),  0.001, 100},
+    {"est_imu_noise",    SH_F32, offsetof(params_t, est_imu_noise),    0.001, 100},
+};
+
+static uint32_t ShellStatUart1Frames(void)    { uart_rx_stats_t s; plt_UartGetRxStats(Uart1,&s); return s.frames; }
+static uint32_t ShellStatUart1CrcErrors(void) { uart_rx_stats_t s; plt_UartGetRxStats(Uart1,&s); return s.crcErrors; }
+static uint32_t ShellStatUart3Frames(void)    { uart_rx_stats_t s; plt_UartGetRxStats(Uart3,&s); return s.frames; }
+static uint32_t ShellStatUart3CrcErrors(void) { uart_rx_stats_t s; plt_UartGetRxStats(Uart3,&s); return s.crcErrors; }
+
+/**
+ * @brief Shell statistics table
+ */
+static const shell_stat_t ShellStats[] = {
+    {"log_dropped",     log_GetDroppedCount},
+    {"debug_overflow",  plt_DebugGetOverflowCount},
+    {"uart1_frames",    ShellStatUart1Frames},
+    {"uart1_crc_err",   ShellStatUart1CrcErrors},
+    {"uart3_frames",    ShellStatUart3Frames},
+    {"uart3_crc_err",   ShellStatUart3CrcErrors},
+    {"sch_late_ticks",  sch_GetLateTicks},
+    {"ev_dropped",      ev_GetDroppedCount},
+};
+
+/**
+ * @brief Read one byte received on the debug UART for the shell
+ */
+static int ShellRead(void)
+{
+    uint8_t c;
+    return (plt_DebugRead(&c,1) == 1) ? c : -1;
+}
+
+/**
+ * @brief Write the shell output to the debug UART
+ */
+static void ShellWrite(const char* data, size_t len)
+{
+    plt_DebugSendMSG((uint8_t*)data,(uint16_t)len);
+}
+
+/**
+ * @brief Shell command: print the profiler report as one hex line (Tools/prf_report.py)
+ */
+static void ShellCmdProf(const shell_io_t* io)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t report[PRF_REPORT_SIZE];
+    size_t len = prf_Serialize(report, sizeof(report));
+
+    io->write("PRF:", 4);
+    for (size_t i = 0; i < len; i++)
+    {
+        char byte[2] = {hex[report[i] >> 4], hex[report[i] & 0x0F]};
+        io->write(byte, 2);
+    }
+    io->write("\r\n", 2);
+}
+
+/**
+ * @brief Shell command: clear the profiler statistics
+ */
+static void ShellCmdProfReset(const shell_io_t* io)
+{
+    prf_Reset();
+    io->write("ok\r\n", 4);
+}
+
+#ifdef HAL_ADC_MODULE_ENABLED
+/**
+ * @brief Write a string for the shell commands, the length comes from the string
+ */
+static void ShellPuts(const shell_io_t* io, const char* str)
+{
+    io->write(str, strlen(str));
+}
+
+/**
+ * @brief Shell command: start the pedal calibration capture
+ * @note  Only in Stage 1, the pedals are pressed fully during the capture.
+ */
+static void ShellCmdCalStart(const shell_io_t* io)
+{
+    if (pMainDB->vcu_node->fsm_stage != Stage1)
+    {
+        ShellPuts(io, "error: stage 1 only\r\n");
+        return;
+    }
+    cal_StartCapture(HAL_GetTick());
+    ShellPuts(io, "ok\r\n");
+}
+
+/**
+ * @brief Shell command: abort the pedal calibration capture
+ */
+static void ShellCmdCalAbort(const shell_io_t* io)
+{
+    cal_AbortCapture();
+    ShellPuts(io, "ok\r\n");
+}
+
+/**
+ * @brief Write a label and an unsigned value for the shell commands (no printf)
+ */
+static void ShellPutU32(const shell_io_t* io, const char* label, uint32_t value)
+{
+    char buf[10];
+    uint8_t i = sizeof(buf);
+
+    do
+    {
+        buf[--i] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value > 0);
+    ShellPuts(io, label);
+    io->write(&buf[i], sizeof(buf) - i);
+}
+
+/**
+ * @brief Shell command: print the capture state and the active calibration
+ */
+static void ShellCmdCalStatus(const shell_io_t* io)
+{
+    const cal_record_t* record = cal_GetRecord();
+
+    ShellPutU32(io, "state ", cal_GetState());
+    ShellPutU32(io, " error ", cal_GetError());
+    ShellPutU32(io, " valid ", cal_IsValid());
+    ShellPutU32(io, " seq ", record->sequence);
+    ShellPuts(io, "\r\n");
+    for (uint8_t i = 0; i < CAL_NUM_CHANNELS; i++)
+    {
+        ShellPutU32(io, "ch", i);
+        ShellPutU32(io, " rest ", record->rest[i]);
+        ShellPutU32(io, " full ", record->full[i]);
+        ShellPuts(io, "\r\n");
+    }
+}
+#endif
+
+/**
+ * @brief Shell application command table
+ */
+static const shell_cmd_t ShellCmds[] = {
+    {"prof",       ShellCmdProf},
+    {"prof_reset", ShellCmdProfReset},
+#ifdef HAL_ADC_MODULE_ENABLED
+    {"cal_start",  ShellCmdCalStart},
+    {"cal_abort",  ShellCmdCalAbort},
+    {"cal_status", ShellCmdCalStatus},
+#endif
+};
+
+static const shell_io_t ShellIo = {
+    .read = ShellRead,
+    .write = ShellWrite
+};
+#endif
+
+/**
+ * @brief Initialize the debug shell on the debug UART
+ * @note  The commands are processed by sh_Process in the main loop (idle time)
+ */
+void ShellInit(void)
+{
+    #ifdef HAL_UART_MODULE_ENABLED
+    sh_Init(&ShellIo, ShellParams, sizeof(ShellParams) / sizeof(ShellParams[0]), &pMainDB->vcu_node->params,
+            ShellStats, sizeof(ShellStats) / sizeof(ShellStats[0]));
+    sh_SetCommands(ShellCmds, sizeof(ShellCmds) / sizeof(ShellCmds[0]));
+    #endif
+}
@@ -158,6 +158,7 @@ void plt_CanFilterInit(CAN_HandleTypeDef* pCan)
 void plt_CanProcessRxMsgs()
 {
     can_message_t data = {0};
+    PROF_BEGIN(PRF_CAN_PROCESS);
 
     while (canRxQueue.status != QUEUE_EMPTY)
     {
@@ -167,6 +168,7 @@ void plt_CanProcessRxMsgs()
             Can_RxCallback(&data);
         }
     }
+    PROF_END(PRF_CAN_PROCESS);
 }
 
 /**
@@ -190,7 +192,7 @@ HAL_StatusTypeDef plt_CanTx(CanChanel_t chanel, CAN_TxHeaderTypeDef* TxHeader, u
             &TxMailbox[chanel - 1]
         );
       }
-    
+    return HAL_BUSY; // All TX mailboxes are full
 }
 
 /**
@@ -221,12 +223,14 @@ plt_CanSendMsg(CanChanel_t chanel, can_message_t *pData)
 */
 void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
 {
+    PROF_BEGIN(PRF_CAN_RX_ISR);
     //Get the message from FIFO0 and Push it to the queue
     VALID(HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &RxHeader[0], Can_RxData[0]));   
     can_message_t msg;
     msg.id = RxHeader[0].StdId;
     memcpy(msg.data, Can_RxData[0], 8); 
     Queue_Push(&canRxQueue, &msg);
+    PROF_END(PRF_CAN_RX_ISR);
     return;
 }
 
@@ -239,12 +243,14 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
 */
 void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)
 {
+    PROF_BEGIN(PRF_CAN_RX_ISR);
     //Get the message from FIFO1 and Push it to the queue
     VALID(HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO1, &RxHeader[1], Can_RxData[1]));
     can_message_t msg;
     msg.id = RxHeader[1].StdId;
     memcpy(msg.data, Can_RxData[1], 8);
     Queue_Push(&canRxQueue, &msg);
+    PROF_END(PRF_CAN_RX_ISR);
     return;
 }
 
@@ -0,0 +1,25 @@
+#include "crc.h"
+/*================================== CRC implementation ===============================*/
+/**
+  * @brief  Calculates a CRC-16/CCITT-FALSE (poly 0x1021) over a buffer.
+  * @param  data Pointer to the data
+  * @param  len  Number of bytes
+  * @param  crc  Start value, CRC16_INIT for a new CRC or a previous result to continue
+  * @retval The updated CRC
+  *
+  * @note   Nibble table implementation, 16 entries in flash and 2 lookups per byte.
+  */
+uint16_t Crc16_Calc(const uint8_t* data, size_t len, uint16_t crc)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
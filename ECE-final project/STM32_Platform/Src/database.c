@@ -14,6 +14,7 @@ static database_t* pMainDB = NULL;
 database_t* db_Init()
 {
    pMainDB = db_AllocateMemory();
+   db_SetDefaultParams(&pMainDB->vcu_node->params);
    DbSetFunctionsInit();
    return pMainDB;
 }
@@ -42,6 +43,58 @@ if (db->dashboard_node == NULL) {free(db->vcu_node);free(db->pedal_node);free(db
 return db;
 }
 
+/**
+ * @brief Set the tunable parameters to their compile time defaults
+ * @param params Pointer to the parameters to set
+ */
+void db_SetDefaultParams(params_t* params)
+{
+    params->hb_gas_high = HB_GAS_HIGH_VAL;
+    params->hb_gas_low = HB_GAS_LOW_VAL;
+    params->hb_brake_high = HB_BRAKE_HIGH_VAL;
+    params->max_velocity = MAX_VELOCITY;
+    params->r2d_timeout = R2D_TIMEOUT;
+    params->pos_torque_limit = POS_TORQUE_LIMIT;
+    params->neg_torque_limit = NEG_TORQUE_LIMIT;
+    params->tv_enable = TV_ENABLE;
+    params->tv_front_split = TV_FRONT_SPLIT;
+    params->tv_yaw_ff = TV_YAW_FF;
+    params->tv_yaw_kp = TV_YAW_KP;
+    params->tc_enable = TC_ENABLE;
+    params->tc_slip_target = TC_SLIP_TARGET;
+    params->tc_kp = TC_KP;
+    params->tc_ki = TC_KI;
+    params->tc_accel_limit = TC_ACCEL_LIMIT;
+    params->lc_enable = LC_ENABLE;
+    params->lc_gas_min = LC_GAS_MIN;
+    params->lc_torque_scale = LC_TORQUE_SCALE;
+    params->lc_slip_target = LC_SLIP_TARGET;
+    params->lc_exit_speed = LC_EXIT_SPEED;
+    params->rg_enable = RG_ENABLE;
+    params->rg_max_torque = RG_MAX_TORQUE;
+    params->rg_front_split = RG_FRONT_SPLIT;
+    params->rg_pedal_start = RG_PEDAL_START;
+    params->rg_pedal_full = RG_PEDAL_FULL;
+    params->rg_volt_start = RG_VOLT_START;
+    params->rg_volt_max = RG_VOLT_MAX;
+    params->rg_temp_start = RG_TEMP_START;
+    params->rg_temp_max = RG_TEMP_MAX;
+    params->rg_rate = RG_RATE;
+    params->pm_mode = PM_MODE;
+    params->pl_enable = PL_ENABLE;
+    params->pl_limit = PL_LIMIT;
+    params->pl_margin = PL_MARGIN;
+    params->th_enable = TH_ENABLE;
+    params->th_horizon = TH_HORIZON;
+    params->th_recovery = TH_RECOVERY;
+    params->th_warning = TH_WARNING;
+    params->est_enable = EST_ENABLE;
+    params->est_jerk = EST_JERK;
+    params->est_wheel_noise = EST_WHEEL_NOISE;
+    params->est_accel_noise = EST_ACCEL_NOISE;
+    params->est_imu_noise = EST_IMU_NOISE;
+}
+
 /**
  * @brief Free memory allocated for the database
  * @param db_ptr Pointer to the database to be freed
@@ -0,0 +1,62 @@
+#include "event.h"
+
+// Event: Queue of the events posted by the decoders for the vehicle FSM
+
+/* =============================== Global Variables =============================== */
+static uint8_t Queue[EV_QUEUE_SIZE];
+static volatile uint8_t Head = 0;      // Write index (decoders), free running
+static volatile uint8_t Tail = 0;      // Read index (FSM), free running
+static uint32_t Dropped = 0;
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Clear the queue
+ */
+void ev_Init(void)
+{
+    Head = 0;
+    Tail = 0;
+    Dropped = 0;
+}
+
+/**
+ * @brief Post an event
+ * @param event The event
+ * @retval 1 if queued, 0 if the queue is full (the event is dropped and counted)
+ * @note  Single producer: post from the main loop context only (the decoders run from
+ *        the RX processing of FSM_TaskControl), or from one interrupt and nowhere else.
+ */
+uint8_t ev_Post(Event_t event)
+{
+    if (event == EV_NONE || event >= EV_NUM) return 0;
+    if ((uint8_t)(Head - Tail) >= EV_QUEUE_SIZE)
+    {
+        Dropped++;
+        return 0;
+    }
+    Queue[Head & (EV_QUEUE_SIZE - 1U)] = (uint8_t)event;
+    Head++;
+    return 1;
+}
+
+/**
+ * @brief Get the oldest pending event
+ * @param event The event
+ * @retval 1 if an event was pending, 0 otherwise
+ */
+uint8_t ev_Get(Event_t* event)
+{
+    if (Head == Tail) return 0;
+    *event = (Event_t)Queue[Tail & (EV_QUEUE_SIZE - 1U)];
+    Tail++;
+    return 1;
+}
+
+/**
+ * @brief Get the number of events dropped because the queue was full
+ */
+uint32_t ev_GetDroppedCount(void)
+{
+    return Dropped;
+}
@@ -0,0 +1,282 @@
+#include "filter.h"
+
+// Filter: Per-signal digital filter pipeline between the message decoders and the database (CMSIS-DSP)
+
+/* =============================== Filter Coefficients =============================== */
+
+/* Gas (APPS): 8 tap triangular low pass, unity DC gain, Q15, time reversed (symmetric) */
+static const q15_t GasFirCoeffs[8] = {
+    1638, 3277, 4915, 6554, 6554, 4915, 3277, 1638
+};
+
+/* Brake (BPPS): 2nd order Butterworth, fs = 100 Hz, fc = 10 Hz, Q15 with postShift 1 */
+static const q15_t BrakeBiquadCoeffs[6] = {
+    1105, 0, 2210, 1105, 18727, -6763
+};
+
+/**
+ * @brief Filter configuration table, one entry per FilterSignal_t
+ * @note  Stored in flash, change the type/coefficients here to retune a signal.
+ */
+static const filter_config_t FilterConfig[FLT_NUM_SIGNALS] = {
+    [FLT_GAS]      = {.type = FLT_FIR,         .format = FLT_Q15, .order = 8, .coeffs = GasFirCoeffs,      .inputShift = 8},
+    [FLT_BRAKE]    = {.type = FLT_BIQUAD,      .format = FLT_Q15, .order = 1, .coeffs = BrakeBiquadCoeffs, .postShift = 1, .inputShift = 8},
+    [FLT_STEERING] = {.type = FLT_MEDIAN,      .format = FLT_Q15, .order = 5},
+    [FLT_BIOPS]    = {.type = FLT_EXPONENTIAL, .format = FLT_F32, .alpha = 0.3f},
+};
+
+/* =============================== Global Variables =============================== */
+
+/**
+ * @brief Filter runtime struct
+ * @note  CMSIS instance and state for one signal, all statically allocated
+ */
+typedef struct{
+    const filter_config_t* cfg;
+    union{
+        arm_fir_instance_q15                 fir_q15;
+        arm_fir_instance_f32                 fir_f32;
+        arm_biquad_casd_df1_inst_q15         biquad_q15;
+        arm_biquad_cascade_df2T_instance_f32 biquad_f32;
+    }inst;
+    union{
+        q15_t     q15[FLT_MAX_FIR_TAPS + FLT_MAX_BLOCK_SIZE];
+        float32_t f32[FLT_MAX_FIR_TAPS + FLT_MAX_BLOCK_SIZE];
+    }state;
+    int32_t   window[FLT_MAX_MEDIAN_WINDOW]; // Median history
+    uint8_t   windowIndex;
+    uint8_t   windowFill;
+    q15_t     alpha_q15;                     // Exponential factor in Q15
+    q15_t     y_q15;                         // Exponential output in Q15
+    float32_t y_f32;                         // Exponential output in f32
+    uint8_t   primed;                        // Exponential filter got its first sample
+    int32_t   last;                          // Last output, returned by flt_Process between samples
+}filter_t;
+
+static filter_t Filters[FLT_NUM_SIGNALS];
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Convert a raw value to Q15 using the configured input shift (saturated)
+ */
+static inline q15_t flt_ToQ15(const filter_config_t* cfg, int32_t value)
+{
+    return (q15_t)__SSAT(value << cfg->inputShift, 16);
+}
+
+/**
+ * @brief Convert a Q15 value back to raw units (rounded)
+ */
+static inline int32_t flt_FromQ15(const filter_config_t* cfg, q15_t value)
+{
+    if (cfg->inputShift == 0) return value;
+    return ((int32_t)value + (1 << (cfg->inputShift - 1))) >> cfg->inputShift;
+}
+
+/**
+ * @brief Initialize the filter pipeline
+ * @note  Binds every signal to its config entry and initializes the CMSIS-DSP instances.
+ *        Must be called before the first decoded message is filtered.
+ */
+void flt_Init(void)
+{
+    for (uint8_t i = 0; i < FLT_NUM_SIGNALS; i++)
+    {
+        Filters[i].cfg = &FilterConfig[i];
+        flt_Reset((FilterSignal_t)i);
+    }
+}
+
+/**
+ * @brief Reset the state of one signal filter
+ * @param signal The signal to reset
+ */
+void flt_Reset(FilterSignal_t signal)
+{
+    filter_t* f = &Filters[signal];
+    const filter_config_t* cfg = f->cfg;
+
+    memset(&f->state, 0, sizeof(f->state));
+    f->windowIndex = 0;
+    f->windowFill = 0;
+    f->primed = 0;
+    f->last = 0;
+
+    switch (cfg->type)
+    {
+    case FLT_FIR:
+        if (cfg->format == FLT_Q15)
+        {
+            arm_fir_init_q15(&f->inst.fir_q15, cfg->order, (const q15_t*)cfg->coeffs, f->state.q15, FLT_MAX_BLOCK_SIZE);
+        }
+        else
+        {
+            arm_fir_init_f32(&f->inst.fir_f32, cfg->order, (const float32_t*)cfg->coeffs, f->state.f32, FLT_MAX_BLOCK_SIZE);
+        }
+        break;
+    case FLT_BIQUAD:
+        if (cfg->format == FLT_Q15)
+        {
+            arm_biquad_cascade_df1_init_q15(&f->inst.biquad_q15, (uint8_t)cfg->order, (const q15_t*)cfg->coeffs, f->state.q15, cfg->postShift);
+        }
+        else
+        {
+            arm_biquad_cascade_df2T_init_f32(&f->inst.biquad_f32, (uint8_t)cfg->order, (const float32_t*)cfg->coeffs, f->state.f32);
+        }
+        break;
+    case FLT_EXPONENTIAL:
+        f->alpha_q15 = (q15_t)__SSAT((int32_t)(cfg->alpha * 32768.0f), 16);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Sliding median of the last cfg->order samples
+ */
+static int32_t flt_Median(filter_t* f, int32_t value)
+{
+    int32_t sorted[FLT_MAX_MEDIAN_WINDOW];
+    uint8_t window = (uint8_t)f->cfg->order;
+
+    f->window[f->windowIndex] = value;
+    f->windowIndex = (uint8_t)((f->windowIndex + 1) % window);
+    if (f->windowFill < window) f->windowFill++;
+
+    // Insertion sort of the (small) window
+    for (uint8_t i = 0; i < f->windowFill; i++)
+    {
+        int32_t v = f->window[i];
+        int8_t j = (int8_t)i - 1;
+        while (j >= 0 && sorted[j] > v)
+        {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    return sorted[f->windowFill / 2];
+}
+
+/**
+ * @brief Filter one block of samples of a signal
+ * @param signal    The signal the samples belong to
+ * @param pIn       Input samples in raw (database) units, one per FLT_SAMPLE_PERIOD_MS
+ * @param pOut      Output samples in raw units, may be the same buffer as pIn
+ * @param blockSize Number of samples, processed in chunks of FLT_MAX_BLOCK_SIZE
+ * @note  Samples are 32 bit so unsigned 16 bit raw values (pressures) keep their range.
+ *        The Q15 formats saturate at 32767 >> inputShift.
+ */
+void flt_ProcessBlock(FilterSignal_t signal, const int32_t* pIn, int32_t* pOut, uint16_t blockSize)
+{
+    filter_t* f = &Filters[signal];
+    const filter_config_t* cfg = f->cfg;
+    q15_t     bufQ15[FLT_MAX_BLOCK_SIZE];
+    float32_t bufF32[FLT_MAX_BLOCK_SIZE];
+
+    while (blockSize > 0)
+    {
+        uint16_t n = (blockSize > FLT_MAX_BLOCK_SIZE) ? FLT_MAX_BLOCK_SIZE : blockSize;
+
+        switch (cfg->type)
+        {
+        case FLT_FIR:
+        case FLT_BIQUAD:
+            if (cfg->format == FLT_Q15)
+            {
+                for (uint16_t i = 0; i < n; i++) bufQ15[i] = flt_ToQ15(cfg, pIn[i]);
+                if (cfg->type == FLT_FIR) arm_fir_q15(&f->inst.fir_q15, bufQ15, bufQ15, n);
+                else                      arm_biquad_cascade_df1_q15(&f->inst.biquad_q15, bufQ15, bufQ15, n);
+                for (uint16_t i = 0; i < n; i++) pOut[i] = flt_FromQ15(cfg, bufQ15[i]);
+            }
+            else
+            {
+                for (uint16_t i = 0; i < n; i++) bufF32[i] = (float32_t)pIn[i];
+                if (cfg->type == FLT_FIR) arm_fir_f32(&f->inst.fir_f32, bufF32, bufF32, n);
+                else                      arm_biquad_cascade_df2T_f32(&f->inst.biquad_f32, bufF32, bufF32, n);
+                for (uint16_t i = 0; i < n; i++) pOut[i] = (int32_t)lroundf(bufF32[i]);
+            }
+            break;
+
+        case FLT_MEDIAN:
+            for (uint16_t i = 0; i < n; i++) pOut[i] = flt_Median(f, pIn[i]);
+            break;
+
+        case FLT_EXPONENTIAL:
+            for (uint16_t i = 0; i < n; i++)
+            {
+                if (cfg->format == FLT_Q15)
+                {
+                    q15_t x = flt_ToQ15(cfg, pIn[i]);
+                    if (!f->primed) { f->y_q15 = x; f->primed = 1; }
+                    f->y_q15 = (q15_t)__SSAT(f->y_q15 + (((int32_t)f->alpha_q15 * (x - f->y_q15)) >> 15), 16);
+                    pOut[i] = flt_FromQ15(cfg, f->y_q15);
+                }
+                else
+                {
+                    float32_t x = (float32_t)pIn[i];
+                    if (!f->primed) { f->y_f32 = x; f->primed = 1; }
+                    f->y_f32 += cfg->alpha * (x - f->y_f32);
+                    pOut[i] = (int32_t)lroundf(f->y_f32);
+                }
+            }
+            break;
+
+        default: // FLT_NONE
+            if (pOut != pIn) memcpy(pOut, pIn, n * sizeof(int32_t));
+            break;
+        }
+
+        pIn += n;
+        pOut += n;
+        blockSize -= n;
+    }
+}
+
+/**
+ * @brief Filter the latest value of a signal at the design rate
+ * @param signal The signal the sample belongs to
+ * @param value  The raw value decoded from the message
+ * @param steps  Sample periods since the last call, from flt_Steps
+ * @retval The filtered value
+ * @note  Used by the per-frame decoders. The value is held over the steps (zero order
+ *        hold), so the filters advance at FLT_SAMPLE_PERIOD_MS for any message rate:
+ *        slower messages repeat the value, a second message within the same period is
+ *        skipped and the last output is returned.
+ */
+int32_t flt_Process(FilterSignal_t signal, int32_t value, uint16_t steps)
+{
+    filter_t* f = &Filters[signal];
+    int32_t in[FLT_MAX_HOLD_STEPS];
+    int32_t out[FLT_MAX_HOLD_STEPS];
+
+    if (steps > FLT_MAX_HOLD_STEPS) steps = FLT_MAX_HOLD_STEPS;
+    if (steps == 0) return f->last;
+    for (uint16_t i = 0; i < steps; i++) in[i] = value;
+    flt_ProcessBlock(signal, in, out, steps);
+    f->last = out[steps - 1];
+    return f->last;
+}
+
+/**
+ * @brief Count the filter sample periods elapsed since the last one
+ * @param pLastTick Tick the filters of a message were last advanced to, updated
+ * @param now       Current HAL tick [ms]
+ * @retval Sample periods to advance, 0 .. FLT_MAX_HOLD_STEPS
+ * @note  Keeps the phase of the sample grid. After a gap longer than FLT_MAX_HOLD_STEPS
+ *        periods the grid restarts at now, the held value has settled the filters.
+ */
+uint16_t flt_Steps(uint32_t* pLastTick, uint32_t now)
+{
+    uint32_t steps = (now - *pLastTick) / FLT_SAMPLE_PERIOD_MS;
+
+    if (steps >= FLT_MAX_HOLD_STEPS)
+    {
+        *pLastTick = now;
+        return FLT_MAX_HOLD_STEPS;
+    }
+    *pLastTick += steps * FLT_SAMPLE_PERIOD_MS;
+    return (uint16_t)steps;
+}
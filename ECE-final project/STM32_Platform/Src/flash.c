@@ -0,0 +1,50 @@
+#include "flash.h"
+
+#ifdef HAL_FLASH_MODULE_ENABLED
+
+/**
+ * @brief Erase one sector of the internal flash
+ * @param sector The sector (FLASH_SECTOR_x)
+ * @retval HAL status
+ * @note  Blocks until the erase is done, the CPU stalls on flash reads meanwhile.
+ */
+HAL_StatusTypeDef plt_FlashErase(uint32_t sector)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t sectorError = 0;
+    HAL_StatusTypeDef status;
+
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = sector;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    HAL_FLASH_Unlock();
+    status = HAL_FLASHEx_Erase(&erase, &sectorError);
+    HAL_FLASH_Lock();
+    return status;
+}
+
+/**
+ * @brief Program words into the internal flash
+ * @param address Absolute address (word aligned)
+ * @param data    Data to program
+ * @param len     Number of bytes (multiple of 4)
+ * @retval HAL status
+ * @note  The words are programmed in order, the first word first.
+ */
+HAL_StatusTypeDef plt_FlashProgram(uint32_t address, const uint8_t* data, uint32_t len)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+    uint32_t word;
+
+    HAL_FLASH_Unlock();
+    for (uint32_t i = 0; (i < len) && (status == HAL_OK); i += sizeof(uint32_t))
+    {
+        memcpy(&word, &data[i], sizeof(uint32_t));
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address + i, word);
+    }
+    HAL_FLASH_Lock();
+    return status;
+}
+#endif
@@ -0,0 +1,205 @@
+#include "hsm.h"
+
+// HSM: Generic table driven hierarchical state machine engine
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Get the path of a state up to its top level superstate
+ * @param path Filled with the state first, then its superstates
+ * @retval Number of states in the path
+ */
+static uint8_t hsm_Path(const hsm_t* hsm, uint8_t state, uint8_t path[HSM_MAX_DEPTH])
+{
+    uint8_t depth = 0;
+
+    while (state != HSM_NO_STATE && depth < HSM_MAX_DEPTH)
+    {
+        path[depth++] = state;
+        state = hsm->states[state].parent;
+    }
+    return depth;
+}
+
+/**
+ * @brief Leave the current state and enter the target
+ * @param event  Event that triggered the transition, for the history
+ * @param action Transition action, may be NULL
+ * @note  Exits from the current leaf up to the common superstate, then enters down to the
+ *        target. A transition to the current state exits and enters it again.
+ */
+static void hsm_Transition(hsm_t* hsm, uint8_t target, uint8_t event, void (*action)(void))
+{
+    uint8_t fromPath[HSM_MAX_DEPTH];
+    uint8_t toPath[HSM_MAX_DEPTH];
+    uint8_t fromDepth = hsm_Path(hsm, hsm->current, fromPath);
+    uint8_t toDepth = hsm_Path(hsm, target, toPath);
+    uint8_t from = hsm->current;
+    uint8_t exits = fromDepth;
+    uint8_t entries = toDepth;
+
+    /* Strip the common superstates, they are neither left nor entered */
+    while (exits > 0 && entries > 0 && fromPath[exits - 1] == toPath[entries - 1])
+    {
+        exits--;
+        entries--;
+    }
+    if (exits == 0 && entries == 0) // Same state
+    {
+        exits = 1;
+        entries = 1;
+    }
+
+    for (uint8_t i = 0; i < exits; i++)
+    {
+        if (hsm->states[fromPath[i]].exit != NULL) hsm->states[fromPath[i]].exit();
+    }
+    hsm->current = target;
+    if (action != NULL) action();
+    for (uint8_t i = entries; i > 0; i--)
+    {
+        if (hsm->states[toPath[i - 1]].entry != NULL) hsm->states[toPath[i - 1]].entry();
+    }
+
+    hsm_history_t* entry = &hsm->history[hsm->historyHead];
+    entry->timestamp = (hsm->clock != NULL) ? hsm->clock() : 0;
+    entry->from = from;
+    entry->to = target;
+    entry->event = event;
+    hsm->historyHead = (hsm->historyHead + 1U) & (HSM_HISTORY_SIZE - 1U);
+    hsm->transitionCount++;
+    if (hsm->trace != NULL) hsm->trace(from, target);
+}
+
+/**
+ * @brief Initialize a state machine and enter its initial state
+ * @param hsm            The instance
+ * @param states         State table (const), the index is the state id
+ * @param numStates      Number of states
+ * @param transitions    Transition table (const), checked in table order
+ * @param numTransitions Number of transitions
+ * @param initial        Initial leaf state, its entry actions run here
+ * @param clock          Timestamp source for the history (e.g. HAL_GetTick), may be NULL
+ * @note  Set hsm->trace before if the initial entry should be traced too.
+ */
+void hsm_Init(hsm_t* hsm, const hsm_state_t* states, uint8_t numStates,
+              const hsm_transition_t* transitions, uint8_t numTransitions,
+              uint8_t initial, uint32_t (*clock)(void))
+{
+    uint8_t path[HSM_MAX_DEPTH];
+    uint8_t depth;
+
+    hsm->states = states;
+    hsm->numStates = numStates;
+    hsm->transitions = transitions;
+    hsm->numTransitions = numTransitions;
+    hsm->clock = clock;
+    hsm->current = initial;
+    hsm->historyHead = 0;
+    hsm->transitionCount = 0;
+    memset(hsm->history, 0, sizeof(hsm->history));
+
+    depth = hsm_Path(hsm, initial, path);
+    for (uint8_t i = depth; i > 0; i--)
+    {
+        if (states[path[i - 1]].entry != NULL) states[path[i - 1]].entry();
+    }
+}
+
+/**
+ * @brief Take the first enabled transition of an event
+ * @retval 1 if a transition was taken, 0 otherwise
+ * @note  Enabled: the source is active and the guard holds. At most one transition per
+ *        call, so the table order is the priority.
+ */
+static uint8_t hsm_Take(hsm_t* hsm, uint8_t event)
+{
+    for (uint8_t i = 0; i < hsm->numTransitions; i++)
+    {
+        const hsm_transition_t* t = &hsm->transitions[i];
+
+        if (t->event == event && hsm_InState(hsm, t->from) && (t->guard == NULL || t->guard()))
+        {
+            if (t->to == HSM_NO_STATE) // Internal: no exit, no entry, no history
+            {
+                if (t->action != NULL) t->action();
+                return 1;
+            }
+            hsm_Transition(hsm, t->to, event, t->action);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Run one step of the state machine
+ * @note  Runs the do actions from the top level superstate down to the active leaf, then
+ *        takes the first enabled HSM_EV_TICK transition.
+ */
+void hsm_Run(hsm_t* hsm)
+{
+    uint8_t path[HSM_MAX_DEPTH];
+    uint8_t state = hsm->current;
+    uint8_t depth = hsm_Path(hsm, state, path);
+
+    for (uint8_t i = depth; i > 0; i--)
+    {
+        if (hsm->states[path[i - 1]].run != NULL) hsm->states[path[i - 1]].run();
+        if (hsm->current != state) return; // A do action forced a transition
+    }
+    (void)hsm_Take(hsm, HSM_EV_TICK);
+}
+
+/**
+ * @brief Dispatch an event
+ * @param event Event id, not HSM_EV_TICK
+ * @retval 1 if the event caused a transition, 0 if it was ignored in the active state
+ * @note  Takes the first enabled transition of the event, the do actions do not run.
+ */
+uint8_t hsm_Dispatch(hsm_t* hsm, uint8_t event)
+{
+    if (event == HSM_EV_TICK) return 0;
+    return hsm_Take(hsm, event);
+}
+
+/**
+ * @brief Force a transition, bypassing the table
+ * @param target Leaf state
+ * @note  For the error handling. Does nothing if the target is already active.
+ */
+void hsm_Goto(hsm_t* hsm, uint8_t target)
+{
+    if (target == hsm->current || target >= hsm->numStates) return;
+    hsm_Transition(hsm, target, HSM_EV_TICK, NULL);
+}
+
+/**
+ * @brief Check if a state is active
+ * @param state Leaf state or superstate
+ * @retval 1 if the state is the active leaf or one of its superstates, 0 otherwise
+ */
+uint8_t hsm_InState(const hsm_t* hsm, uint8_t state)
+{
+    uint8_t s = hsm->current;
+
+    for (uint8_t depth = 0; s != HSM_NO_STATE && depth < HSM_MAX_DEPTH; depth++)
+    {
+        if (s == state) return 1;
+        s = hsm->states[s].parent;
+    }
+    return 0;
+}
+
+/**
+ * @brief Get an entry of the transition history
+ * @param index 0 for the latest transition, up to HSM_HISTORY_SIZE - 1
+ * @param entry History entry
+ * @retval 1 if the entry exists, 0 otherwise
+ */
+uint8_t hsm_GetHistory(const hsm_t* hsm, uint8_t index, hsm_history_t* entry)
+{
+    if (index >= HSM_HISTORY_SIZE || index >= hsm->transitionCount) return 0;
+    *entry = hsm->history[(uint8_t)(hsm->historyHead - 1U - index) & (HSM_HISTORY_SIZE - 1U)];
+    return 1;
+}
@@ -0,0 +1,155 @@
+#include "logger.h"
+#ifdef HAL_UART_MODULE_ENABLED
+#include "uart.h"
+#endif
+
+// Logger: Binary deferred-format logging, the format strings are resolved on the host
+
+/* =============================== Global Variables =============================== */
+// Free running byte indexes, masked with LOG_BUFFER_SIZE - 1 to address the buffer.
+// Writers reserve [LogHead, LogHead + len) with LDREX/STREX and copy their record there,
+// LogCommit moves up to LogHead once no writer is left between reservation and copy.
+// log_Process reads [LogTail, LogCommit) only.
+static uint8_t LogBuffer[LOG_BUFFER_SIZE];  // Log record storage
+static volatile uint32_t LogHead = 0;       // Reserved up to, advanced by log_Write
+static volatile uint32_t LogCommit = 0;     // Written up to, advanced by the last writer out
+static volatile uint32_t LogTail = 0;       // Sent up to, advanced by log_Process
+static volatile uint32_t LogWriters = 0;    // Writers between reservation and commit
+static volatile uint32_t LogDropped = 0;    // Records dropped because the buffer was full
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Add to a shared counter with LDREX/STREX
+ * @retval The new value
+ */
+static uint32_t log_AtomicAdd(volatile uint32_t* value, uint32_t delta)
+{
+    uint32_t result;
+    do
+    {
+        result = __LDREXW(value) + delta;
+    } while (__STREXW(result, value) != 0U);
+    return result;
+}
+
+/**
+ * @brief Copy a record into the reserved area, wrapping at the end of the buffer
+ */
+static void log_Copy(uint32_t position, const uint8_t* data, uint32_t len)
+{
+    uint32_t offset = position & (LOG_BUFFER_SIZE - 1U);
+    uint32_t first = LOG_BUFFER_SIZE - offset;
+
+    if (first > len) first = len;
+    memcpy(&LogBuffer[offset], data, first);
+    memcpy(LogBuffer, &data[first], len - first);
+}
+
+/**
+ * @brief Leave the writer section, the last writer out publishes everything reserved
+ * @note  Writers nest like the interrupts they run in: when the count drops to 0 every
+ *        reservation up to LogHead has been copied. An interrupt between the read of
+ *        LogHead and the store clears the exclusive monitor (exception entry/return on
+ *        the Cortex-M4), so the store fails and is retried with the newer LogHead and
+ *        LogCommit never moves backwards.
+ */
+static void log_Commit(void)
+{
+    if (log_AtomicAdd(&LogWriters, (uint32_t)-1) != 0U) return;
+
+    uint32_t head;
+    do
+    {
+        (void)__LDREXW(&LogCommit);
+        head = LogHead;
+    } while (__STREXW(head, &LogCommit) != 0U);
+}
+
+/**
+ * @brief Initialize the logger
+ * @note  Must be called before the first LOG, records written before are dropped.
+ */
+void log_Init(void)
+{
+    LogHead = 0;
+    LogCommit = 0;
+    LogTail = 0;
+    LogWriters = 0;
+    LogDropped = 0;
+}
+
+/**
+ * @brief Write one log record to the ring buffer
+ * @param id    Format string id (offset in the .logfmt section)
+ * @param args  Arguments, already widened to 32 bit
+ * @param nargs Number of arguments
+ * @note  Called through the LOG macro, from threads and interrupts. Lock free: the space
+ *        is reserved with LDREX/STREX, the record is copied without masking interrupts
+ *        and published by log_Commit. A higher priority LOG in between simply takes the
+ *        next area. A record that does not fit is dropped and counted.
+ */
+void log_Write(uint16_t id, const uint32_t* args, uint8_t nargs)
+{
+    uint8_t record[sizeof(log_header_t) + LOG_MAX_ARGS * sizeof(uint32_t)];
+    log_header_t header;
+    uint32_t len, position;
+
+    if (nargs > LOG_MAX_ARGS) nargs = LOG_MAX_ARGS;
+    len = sizeof(log_header_t) + nargs * sizeof(uint32_t);
+
+    header.sync = LOG_SYNC;
+    header.nargs = nargs;
+    header.id = id;
+    header.timestamp = HAL_GetTick();
+    memcpy(record, &header, sizeof(log_header_t));
+    memcpy(&record[sizeof(log_header_t)], args, nargs * sizeof(uint32_t));
+
+    // Count the writer before reserving, so a nested writer cannot publish our area
+    log_AtomicAdd(&LogWriters, 1U);
+    do
+    {
+        position = __LDREXW(&LogHead);
+        if (LOG_BUFFER_SIZE - (position - LogTail) < len)
+        {
+            __CLREX();
+            log_AtomicAdd(&LogDropped, 1U);
+            log_Commit();
+            return;
+        }
+    } while (__STREXW(position + len, &LogHead) != 0U);
+
+    log_Copy(position, record, len);
+    log_Commit();
+}
+
+/**
+ * @brief Move the pending log records to the debug UART
+ * @note  Called from the main loop outside the control tick, the only reader. Without the
+ *        UART module the records stay in the buffer (readable with the debugger) and new
+ *        ones are dropped.
+ */
+void log_Process(void)
+{
+    #ifdef HAL_UART_MODULE_ENABLED
+    uint32_t commit = LogCommit;
+    while (LogTail != commit)
+    {
+        uint32_t offset = LogTail & (LOG_BUFFER_SIZE - 1U);
+        uint32_t len = commit - LogTail;
+        if (len > LOG_BUFFER_SIZE - offset) len = LOG_BUFFER_SIZE - offset;
+        if (len > plt_DebugGetFree()) len = plt_DebugGetFree();
+        if (len == 0) break; // UART busy, the rest is sent on the next call
+        plt_DebugSendMSG(&LogBuffer[offset], (uint16_t)len);
+        LogTail += len;
+    }
+    #endif
+}
+
+/**
+ * @brief Get the number of records dropped because the log ring buffer was full
+ */
+uint32_t log_GetDroppedCount(void)
+{
+    return LogDropped;
+}
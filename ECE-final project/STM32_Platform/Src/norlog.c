@@ -0,0 +1,353 @@
+#include "norlog.h"
+#include <string.h>
+
+// NOR log: Log-structured record store on NOR flash. Records are packed into page buffers in
+// RAM and programmed one page per nlog_Process call, segments are erased ahead of the write
+// position so nlog_Write never waits for the flash.
+
+/* =============================== Global Variables =============================== */
+static const nlog_ops_t* pOps = NULL;         // Flash operations, NULL until mounted
+static uint32_t NumSegments = 0;
+static uint32_t PagesPerSegment = 0;
+
+static uint32_t Sequence = 0;                 // Segment of the next page to open
+static uint32_t PageIndex = 0;                // Page of the next page to open within its segment
+static uint32_t EraseCursor = 0;              // Segments with a lower sequence are erased
+
+static uint8_t  Pages[NLOG_PAGE_BUFFERS][NLOG_MAX_PAGE_SIZE];
+static uint32_t PageSequence[NLOG_PAGE_BUFFERS]; // Segment sequence of each page buffer
+static uint32_t PageAddr[NLOG_PAGE_BUFFERS];     // Flash address of each page buffer
+static uint8_t  PageHead = 0;                 // Oldest page waiting to be programmed
+static uint8_t  PagesReady = 0;               // Pages waiting to be programmed
+static uint8_t  PageOpen = 0;                 // 1 while the page after the ready ones is being filled
+static uint16_t FillPos = 0;                  // Write offset in the open page
+
+static nlog_stats_t Stats;
+
+// RAM flash simulator
+static uint8_t* pRamMem = NULL;
+static uint32_t RamSize = 0;
+static uint32_t RamSegmentSize = 0;
+static uint32_t (*pRamNowUs)(void) = NULL;    // Time source of the simulated latency, NULL for none
+static uint32_t RamProgramUs = 0;
+static uint32_t RamEraseUs = 0;
+static uint32_t RamBusyUntil = 0;
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Check a segment header read from flash
+ * @retval 1 if the header is valid for the segment index, 0 otherwise
+ */
+static uint8_t nlog_SegmentValid(const nlog_segment_t* seg, uint32_t index)
+{
+    if (seg->magic != NLOG_MAGIC || seg->version != NLOG_VERSION || seg->pageSize != pOps->pageSize)
+    {
+        return 0;
+    }
+    if (seg->crc != Crc16_Calc((const uint8_t*)seg, offsetof(nlog_segment_t, crc), CRC16_INIT))
+    {
+        return 0;
+    }
+    return (seg->sequence % NumSegments == index) ? 1 : 0;
+}
+
+/**
+ * @brief Open a new page buffer at the write position
+ * @retval 1 if a buffer was free, 0 if all buffers are waiting to be programmed
+ */
+static uint8_t nlog_OpenPage(void)
+{
+    if (PagesReady >= NLOG_PAGE_BUFFERS) return 0;
+
+    uint8_t slot = (uint8_t)((PageHead + PagesReady) % NLOG_PAGE_BUFFERS);
+    memset(Pages[slot], 0xFF, pOps->pageSize);
+    PageSequence[slot] = Sequence;
+    PageAddr[slot] = (Sequence % NumSegments) * pOps->segmentSize + PageIndex * pOps->pageSize;
+    FillPos = 0;
+
+    if (PageIndex == 0)
+    {
+        nlog_segment_t seg = {
+            .magic = NLOG_MAGIC,
+            .sequence = Sequence,
+            .version = NLOG_VERSION,
+            .pageSize = pOps->pageSize,
+            .reserved = 0xFFFF,
+        };
+        seg.crc = Crc16_Calc((const uint8_t*)&seg, offsetof(nlog_segment_t, crc), CRC16_INIT);
+        memcpy(Pages[slot], &seg, sizeof(seg));
+        FillPos = sizeof(seg);
+    }
+
+    if (++PageIndex >= PagesPerSegment)
+    {
+        PageIndex = 0;
+        Sequence++;
+    }
+    PageOpen = 1;
+    return 1;
+}
+
+/**
+ * @brief Hand the open page over to nlog_Process
+ */
+static void nlog_ClosePage(void)
+{
+    PageOpen = 0;
+    PagesReady++;
+    if (PagesReady > Stats.maxReady) Stats.maxReady = PagesReady;
+}
+
+/**
+ * @brief Mount the log and find the write position
+ * @param ops Flash operations, must stay valid while the log is used
+ * @retval 1 on success, 0 if the geometry is not supported
+ * @note  Reads only the segment headers and the first record byte of the pages of the newest
+ *        segment (one short read per segment). Blocking, call at init.
+ */
+uint8_t nlog_Mount(const nlog_ops_t* ops)
+{
+    nlog_segment_t seg;
+    uint8_t found = 0;
+    uint32_t newest = 0;
+
+    pOps = NULL;
+    if (ops->pageSize == 0 || ops->pageSize > NLOG_MAX_PAGE_SIZE || ops->segmentSize % ops->pageSize != 0 ||
+        ops->pageSize <= sizeof(nlog_segment_t) + sizeof(nlog_record_t))
+    {
+        return 0;
+    }
+    NumSegments = ops->size / ops->segmentSize;
+    PagesPerSegment = ops->segmentSize / ops->pageSize;
+    if (NumSegments <= NLOG_ERASE_AHEAD + 1) return 0;
+    pOps = ops;
+
+    memset(&Stats, 0, sizeof(Stats));
+    PageHead = 0;
+    PagesReady = 0;
+    PageOpen = 0;
+
+    // Newest segment
+    for (uint32_t i = 0; i < NumSegments; i++)
+    {
+        if (pOps->read(i * pOps->segmentSize, (uint8_t*)&seg, sizeof(seg)) && nlog_SegmentValid(&seg, i))
+        {
+            if (!found || seg.sequence > newest)
+            {
+                newest = seg.sequence;
+                found = 1;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        // Empty or foreign flash, start from segment 0 once it is erased
+        Sequence = 0;
+        PageIndex = 0;
+        EraseCursor = 0;
+    }
+    else
+    {
+        // First page of the newest segment that holds no record
+        uint32_t base = (newest % NumSegments) * pOps->segmentSize;
+        uint32_t page = 1;
+        uint8_t type;
+
+        for (; page < PagesPerSegment; page++)
+        {
+            if (!pOps->read(base + page * pOps->pageSize, &type, 1) || type == NLOG_TYPE_ERASED) break;
+        }
+        if (page < PagesPerSegment)
+        {
+            Sequence = newest;
+            PageIndex = page;
+            EraseCursor = newest + 1;
+        }
+        else
+        {
+            Sequence = newest + 1;
+            PageIndex = 0;
+            EraseCursor = newest + 1;
+        }
+    }
+    Stats.sequence = Sequence;
+    return 1;
+}
+
+/**
+ * @brief Append a record
+ * @param type      Record type (not NLOG_TYPE_ERASED)
+ * @param timestamp Timestamp in ms
+ * @param payload   Record data
+ * @param len       Payload length, the record must fit in a page
+ * @retval 1 if the record was queued, 0 if it was dropped
+ * @note  Only copies into RAM, never waits for the flash. Not reentrant, call from one context.
+ */
+uint8_t nlog_Write(uint8_t type, uint32_t timestamp, const void* payload, uint8_t len)
+{
+    nlog_record_t rec = {.type = type, .len = len, .timestamp = timestamp};
+    uint16_t size = (uint16_t)(sizeof(rec) + len);
+
+    if (pOps == NULL || type == NLOG_TYPE_ERASED || size > pOps->pageSize - sizeof(nlog_segment_t))
+    {
+        return 0;
+    }
+
+    if (PageOpen && FillPos + size > pOps->pageSize)
+    {
+        nlog_ClosePage();
+    }
+    if (!PageOpen && !nlog_OpenPage())
+    {
+        Stats.dropped++;
+        return 0;
+    }
+
+    rec.crc = Crc16_Calc(&rec.type, 2, CRC16_INIT);
+    rec.crc = Crc16_Calc((const uint8_t*)&rec.timestamp, sizeof(rec.timestamp), rec.crc);
+    rec.crc = Crc16_Calc((const uint8_t*)payload, len, rec.crc);
+
+    uint8_t* page = Pages[(PageHead + PagesReady) % NLOG_PAGE_BUFFERS];
+    memcpy(&page[FillPos], &rec, sizeof(rec));
+    memcpy(&page[FillPos + sizeof(rec)], payload, len);
+    FillPos += size;
+    Stats.records++;
+    return 1;
+}
+
+/**
+ * @brief Close the open page so its records are programmed without waiting for it to fill
+ * @note  The rest of the page stays erased, use sparingly (e.g. on stage changes or errors).
+ */
+void nlog_Flush(void)
+{
+    if (pOps != NULL && PageOpen)
+    {
+        nlog_ClosePage();
+    }
+}
+
+/**
+ * @brief Start the next flash operation
+ * @note  Call from the main loop. Starts at most one program or erase and returns at once
+ *        while the flash is busy. Programs go first, a page whose segment is not erased yet
+ *        waits for the erase.
+ */
+void nlog_Process(void)
+{
+    if (pOps == NULL || pOps->busy()) return;
+
+    if (PagesReady > 0 && PageSequence[PageHead] < EraseCursor)
+    {
+        if (pOps->program(PageAddr[PageHead], Pages[PageHead], pOps->pageSize))
+        {
+            Stats.pages++;
+        }
+        else
+        {
+            Stats.errors++;  // The page is lost, the extractor skips it by CRC
+        }
+        Stats.sequence = PageSequence[PageHead];
+        PageHead = (uint8_t)((PageHead + 1) % NLOG_PAGE_BUFFERS);
+        PagesReady--;
+    }
+    else if (EraseCursor <= Sequence + NLOG_ERASE_AHEAD)
+    {
+        // Keep the current segment and the next NLOG_ERASE_AHEAD erased, this overwrites the oldest data
+        if (pOps->erase((EraseCursor % NumSegments) * pOps->segmentSize))
+        {
+            Stats.erases++;
+        }
+        else
+        {
+            Stats.errors++;
+        }
+        EraseCursor++;
+    }
+}
+
+/**
+ * @brief Get the logger statistics
+ */
+void nlog_GetStats(nlog_stats_t* stats)
+{
+    *stats = Stats;
+}
+
+/* ============================== RAM Flash Simulator ============================== */
+
+static uint8_t nlog_RamRead(uint32_t addr, uint8_t* data, uint32_t len)
+{
+    if (addr + len > RamSize) return 0;
+    memcpy(data, &pRamMem[addr], len);
+    return 1;
+}
+
+static uint8_t nlog_RamProgram(uint32_t addr, const uint8_t* data, uint16_t len)
+{
+    if (addr + len > RamSize) return 0;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        pRamMem[addr + i] &= data[i];  // NOR programming only clears bits
+    }
+    if (pRamNowUs != NULL) RamBusyUntil = pRamNowUs() + RamProgramUs;
+    return 1;
+}
+
+static uint8_t nlog_RamErase(uint32_t addr)
+{
+    if (addr % RamSegmentSize != 0 || addr >= RamSize) return 0;
+    memset(&pRamMem[addr], 0xFF, RamSegmentSize);
+    if (pRamNowUs != NULL) RamBusyUntil = pRamNowUs() + RamEraseUs;
+    return 1;
+}
+
+static uint8_t nlog_RamBusy(void)
+{
+    if (pRamNowUs == NULL) return 0;
+    return ((int32_t)(RamBusyUntil - pRamNowUs()) > 0) ? 1 : 0;
+}
+
+/**
+ * @brief Fill a flash operations struct with a RAM backed NOR flash
+ * @param ops         Operations to fill
+ * @param mem         Flash contents, left as is (memset to 0xFF for a blank flash)
+ * @param size        Size of mem in bytes
+ * @param segmentSize Erase sector size in bytes
+ * @param pageSize    Program page size in bytes
+ * @note  Behaves like NOR flash (programming clears bits only), one instance at a time.
+ *        Used by the host tools and for tests without the external flash. Operations
+ *        complete at once until nlog_RamSetTiming is called.
+ */
+void nlog_RamInit(nlog_ops_t* ops, uint8_t* mem, uint32_t size, uint32_t segmentSize, uint16_t pageSize)
+{
+    pRamMem = mem;
+    RamSize = size;
+    RamSegmentSize = segmentSize;
+
+    ops->size = size;
+    ops->segmentSize = segmentSize;
+    ops->pageSize = pageSize;
+    ops->read = nlog_RamRead;
+    ops->program = nlog_RamProgram;
+    ops->erase = nlog_RamErase;
+    ops->busy = nlog_RamBusy;
+}
+
+/**
+ * @brief Give the RAM flash the program and erase time of a real flash
+ * @param nowUs     Time source [us], NULL to complete every operation at once
+ * @param programUs Page program time [us]
+ * @param eraseUs   Sector erase time [us]
+ * @note  busy returns 1 for that long after each program or erase, so the page buffers
+ *        fill up during an erase like on the target.
+ */
+void nlog_RamSetTiming(uint32_t (*nowUs)(void), uint32_t programUs, uint32_t eraseUs)
+{
+    pRamNowUs = nowUs;
+    RamProgramUs = programUs;
+    RamEraseUs = eraseUs;
+    RamBusyUntil = 0;
+}
@@ -0,0 +1,179 @@
+#include "profiler.h"
+
+// Profiler: Execution time of code blocks, tick jitter and CPU load from the DWT cycle counter
+
+/* =============================== Global Variables =============================== */
+static prf_stats_t Probes[PRF_NUM_PROBES];
+
+static uint32_t LastTick = 0;                 // Cycle counter at the last tick
+static prf_stats_t TickPeriod;                // Cycles between two ticks (sum unused)
+
+static uint32_t LastLoop = 0;                 // Cycle counter at the last main loop pass
+static uint32_t WindowCycles = 0;             // Cycles of the current load window
+static uint32_t IdleCycles = 0;               // Idle cycles of the current load window
+static uint16_t LoadPermille = 0;             // CPU load of the last complete window
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Clear one statistics struct
+ */
+static void prf_Clear(prf_stats_t* stats)
+{
+    stats->count = 0;
+    stats->min = UINT32_MAX;
+    stats->max = 0;
+    stats->sum = 0;
+}
+
+/**
+ * @brief Enable the DWT cycle counter and clear the statistics
+ * @note  The counter is also used by the debugger, enabling it twice is harmless.
+ */
+void prf_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    prf_Reset();
+}
+
+/**
+ * @brief Clear the statistics
+ */
+void prf_Reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();  // Probes in interrupts must not see half cleared stats
+
+    for (uint8_t i = 0; i < PRF_NUM_PROBES; i++)
+    {
+        prf_Clear(&Probes[i]);
+    }
+    prf_Clear(&TickPeriod);
+    LastTick = 0;
+    LastLoop = DWT->CYCCNT;
+    WindowCycles = 0;
+    IdleCycles = 0;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Add a measurement to a probe
+ * @param probe  The probe
+ * @param cycles Cycles between PROF_BEGIN and PROF_END
+ * @note  Called through PROF_END. A probe must be used from one context only (main loop or
+ *        one interrupt).
+ */
+void prf_Record(PrfProbe_t probe, uint32_t cycles)
+{
+    prf_stats_t* stats = &Probes[probe];
+
+    stats->count++;
+    stats->sum += cycles;
+    if (cycles < stats->min) stats->min = cycles;
+    if (cycles > stats->max) stats->max = cycles;
+}
+
+/**
+ * @brief Measure the period since the last tick
+ * @note  Called through PROF_TICK when the scheduler starts the tasks of a tick, so the
+ *        period spread (max - min) is the release jitter seen by the tasks.
+ */
+void prf_Tick(void)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    if (LastTick != 0)
+    {
+        uint32_t period = now - LastTick;
+        TickPeriod.count++;
+        if (period < TickPeriod.min) TickPeriod.min = period;
+        if (period > TickPeriod.max) TickPeriod.max = period;
+    }
+    LastTick = now;
+}
+
+/**
+ * @brief Account a main loop pass for the CPU load
+ * @param busy 0 if the scheduler had nothing to run in this pass
+ * @note  Called through PROF_LOOP at the end of every pass. Passes without tasks are idle,
+ *        the background work they do (log drain, shell) only uses the time left and counts
+ *        as idle too. The load is updated every PRF_LOAD_WINDOW_MS.
+ */
+void prf_Loop(uint8_t busy)
+{
+    uint32_t now = DWT->CYCCNT;
+    uint32_t pass = now - LastLoop;
+
+    LastLoop = now;
+    WindowCycles += pass;
+    if (!busy) IdleCycles += pass;
+
+    if (WindowCycles >= SystemCoreClock / 1000U * PRF_LOAD_WINDOW_MS)
+    {
+        LoadPermille = (uint16_t)(1000U - (uint32_t)((uint64_t)IdleCycles * 1000U / WindowCycles));
+        WindowCycles = 0;
+        IdleCycles = 0;
+    }
+}
+
+/**
+ * @brief Get the statistics of a probe
+ * @retval 1 if the probe ran at least once, 0 otherwise
+ */
+uint8_t prf_GetStats(PrfProbe_t probe, prf_stats_t* stats)
+{
+    if (probe >= PRF_NUM_PROBES) return 0;
+    *stats = Probes[probe];
+    return (stats->count > 0) ? 1 : 0;
+}
+
+/**
+ * @brief Get the CPU load of the last window
+ * @retval Load [0.1 %]
+ */
+uint16_t prf_GetLoad(void)
+{
+    return LoadPermille;
+}
+
+/**
+ * @brief Write the compact binary report
+ * @param buffer Output buffer
+ * @param size   Size of the buffer, at least PRF_REPORT_SIZE
+ * @retval Report length, 0 if the buffer is too small
+ * @note  Decoded by Tools/prf_report.py. The report is sent as hex text by the shell prof
+ *        command and is small enough for a few CAN frames.
+ */
+size_t prf_Serialize(uint8_t* buffer, size_t size)
+{
+    prf_report_header_t header;
+    prf_report_probe_t entry;
+
+    if (size < PRF_REPORT_SIZE) return 0;
+
+    header.sync = PRF_REPORT_SYNC;
+    header.version = PRF_REPORT_VERSION;
+    header.numProbes = PRF_NUM_PROBES;
+    header.coreMHz = (uint8_t)(SystemCoreClock / 1000000U);
+    header.loadPermille = LoadPermille;
+    header.tickCount = TickPeriod.count;
+    header.tickMin = (TickPeriod.count > 0) ? TickPeriod.min : 0;
+    header.tickMax = TickPeriod.max;
+    memcpy(buffer, &header, sizeof(header));
+    buffer += sizeof(header);
+
+    for (uint8_t i = 0; i < PRF_NUM_PROBES; i++)
+    {
+        prf_stats_t stats = Probes[i];  // Copy first, interrupt probes keep running
+        entry.count = stats.count;
+        entry.min = (stats.count > 0) ? stats.min : 0;
+        entry.max = stats.max;
+        entry.mean = (stats.count > 0) ? (uint32_t)(stats.sum / stats.count) : 0;
+        memcpy(buffer, &entry, sizeof(entry));
+        buffer += sizeof(entry);
+    }
+    return PRF_REPORT_SIZE;
+}
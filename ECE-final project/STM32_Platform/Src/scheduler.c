@@ -0,0 +1,185 @@
+#include "scheduler.h"
+
+// Scheduler: Static table driven cooperative scheduler on a timer base tick
+
+#ifdef HAL_TIM_MODULE_ENABLED
+/* =============================== Global Variables =============================== */
+static TIM_HandleTypeDef* pTim = NULL;        // Base tick timer
+static const sch_task_t* pTasks = NULL;       // Task table
+static uint8_t NumTasks = 0;
+
+static volatile uint32_t Ticks = 0;           // Incremented by the timer interrupt
+static uint32_t Processed = 0;                // Last tick whose tasks have run
+static uint32_t LateTicks = 0;                // Ticks skipped because the tasks ran too long
+static uint32_t TaskNext[SCH_MAX_TASKS];      // Next release tick of each task
+static sch_stats_t TaskStats[SCH_MAX_TASKS];
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Get the time since the scheduler start
+ * @retval Time [us], wraps after 71 minutes (differences stay valid)
+ */
+static uint32_t sch_NowUs(void)
+{
+    uint32_t ticks, count;
+
+    do
+    {
+        ticks = Ticks;
+        count = __HAL_TIM_GET_COUNTER(pTim);
+    } while (ticks != Ticks);  // The tick interrupt came in between
+    return ticks * SCH_TICK_US + count * (1000000U / SCH_TIMER_HZ);
+}
+
+/**
+ * @brief Set the task table
+ * @param tasks    Task table (const), at most SCH_MAX_TASKS entries
+ * @param numTasks Number of tasks
+ * @note  The first release of a task is tick period + offset.
+ */
+void sch_Init(const sch_task_t* tasks, uint8_t numTasks)
+{
+    if (numTasks > SCH_MAX_TASKS) numTasks = SCH_MAX_TASKS;
+
+    pTasks = tasks;
+    NumTasks = numTasks;
+    for (uint8_t i = 0; i < NumTasks; i++)
+    {
+        TaskNext[i] = (uint32_t)tasks[i].period + tasks[i].offset;
+        memset(&TaskStats[i], 0, sizeof(sch_stats_t));
+    }
+}
+
+/**
+ * @brief Get the clock of the APB1 timers
+ * @retval Timer kernel clock [Hz]
+ * @note  Read from the RCC registers (RM0390 6.2): with TIMPRE clear the timers run at
+ *        PCLK1 when the APB1 prescaler is 1 and at 2x PCLK1 otherwise, with TIMPRE set at
+ *        HCLK when the prescaler is 1, 2 or 4 and at 4x PCLK1 otherwise.
+ */
+static uint32_t sch_Apb1TimerClock(void)
+{
+    uint32_t ppre1 = RCC->CFGR & RCC_CFGR_PPRE1;
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    if (RCC->DCKCFGR & RCC_DCKCFGR_TIMPRE)
+    {
+        if (ppre1 == RCC_CFGR_PPRE1_DIV1 || ppre1 == RCC_CFGR_PPRE1_DIV2 || ppre1 == RCC_CFGR_PPRE1_DIV4)
+        {
+            return HAL_RCC_GetHCLKFreq();
+        }
+        return 4U * pclk1;
+    }
+    return (ppre1 == RCC_CFGR_PPRE1_DIV1) ? pclk1 : 2U * pclk1;
+}
+
+/**
+ * @brief Configure the base tick timer and start it
+ * @param htim Basic timer (TIM6) initialized by CubeMX, its prescaler and period are replaced
+ * @retval HAL status
+ * @note  The counter runs at SCH_TIMER_HZ and overflows every SCH_TICK_US, so the tick rate
+ *        is changed here and not in the .ioc. The timer must be on APB1 (TIM2..7, 12..14).
+ */
+HAL_StatusTypeDef sch_Start(TIM_HandleTypeDef* htim)
+{
+    uint32_t timerClock = sch_Apb1TimerClock();
+
+    pTim = htim;
+    htim->Init.Prescaler = timerClock / SCH_TIMER_HZ - 1U;
+    htim->Init.Period = (uint32_t)((uint64_t)SCH_TICK_US * SCH_TIMER_HZ / 1000000U) - 1U;
+    if (HAL_TIM_Base_Init(htim) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    Ticks = 0;
+    Processed = 0;
+    return HAL_TIM_Base_Start_IT(htim);
+}
+
+/**
+ * @brief Count a base tick
+ * @note  Call from HAL_TIM_PeriodElapsedCallback, ignores other timers.
+ */
+void sch_Tick(TIM_HandleTypeDef* htim)
+{
+    if (htim == pTim)
+    {
+        Ticks++;
+    }
+}
+
+/**
+ * @brief Run the tasks released since the last call
+ * @retval Number of tasks run
+ * @note  Call from the main loop as often as possible, the rest of the loop is background
+ *        work. When the tasks of a tick take longer than a tick the scheduler does not
+ *        catch up: a task that became due on a skipped tick runs once now, its other
+ *        missed releases are counted as overruns and its next release stays on its own
+ *        period grid. A late tick can delay a task but never starve it.
+ */
+uint8_t sch_Run(void)
+{
+    uint32_t now = Ticks;
+    uint8_t ran = 0;
+
+    if (now == Processed || pTasks == NULL) return 0;
+
+    PROF_TICK();
+    LateTicks += now - Processed - 1U;
+    Processed = now;
+
+    for (uint8_t i = 0; i < NumTasks; i++)
+    {
+        const sch_task_t* task = &pTasks[i];
+        uint32_t late = now - TaskNext[i];
+
+        if ((int32_t)late < 0) continue;  // Not due yet
+
+        uint32_t releases = late / task->period + 1U;  // Releases up to now
+        TaskNext[i] += releases * task->period;   // Past now
+        TaskStats[i].overruns += releases - 1U;
+
+        uint32_t start = sch_NowUs();
+        task->run();
+        uint32_t elapsed = sch_NowUs() - start;
+
+        ran++;
+        TaskStats[i].runs++;
+        TaskStats[i].lastUs = elapsed;
+        if (elapsed > TaskStats[i].maxUs) TaskStats[i].maxUs = elapsed;
+    }
+    return ran;
+}
+
+/**
+ * @brief Get the number of base ticks since the start
+ */
+uint32_t sch_GetTicks(void)
+{
+    return Ticks;
+}
+
+/**
+ * @brief Get the number of ticks skipped because the tasks overran a tick
+ */
+uint32_t sch_GetLateTicks(void)
+{
+    return LateTicks;
+}
+
+/**
+ * @brief Get the statistics of a task
+ * @param task  Index in the task table
+ * @param stats Task statistics
+ * @retval 1 if the task exists, 0 otherwise
+ */
+uint8_t sch_GetStats(uint8_t task, sch_stats_t* stats)
+{
+    if (task >= NumTasks) return 0;
+    *stats = TaskStats[task];
+    return 1;
+}
+
+#endif
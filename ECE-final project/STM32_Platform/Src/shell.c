@@ -0,0 +1,358 @@
+#include "shell.h"
+#include <string.h>
+
+// Shell: Line based command shell for live parameter inspection and tuning (get/set/dump/stats)
+
+/* =============================== Global Variables =============================== */
+static const shell_io_t* pIo = NULL;          // Transport, NULL until sh_Init
+static const shell_param_t* pParams = NULL;   // Parameter table
+static uint8_t NumParams = 0;
+static uint8_t* pBase = NULL;                 // Parameter struct the offsets refer to
+static const shell_stat_t* pStats = NULL;     // Statistics table
+static uint8_t NumStats = 0;
+static const shell_cmd_t* pCmds = NULL;       // Application commands
+static uint8_t NumCmds = 0;
+
+static char Line[SHELL_LINE_SIZE];            // Line being received
+static uint8_t LineLen = 0;
+
+static const char* const TypeNames[] = {"u8", "u16", "i16", "u32", "i32", "f32"};
+
+/* ========================== Function Definitions ============================ */
+
+/**
+ * @brief Write a zero terminated string
+ */
+static void sh_Puts(const char* str)
+{
+    pIo->write(str, strlen(str));
+}
+
+/**
+ * @brief Write a signed integer in decimal
+ */
+static void sh_PutInt(int32_t value)
+{
+    char buf[12];
+    uint8_t i = sizeof(buf);
+    uint32_t u = (value < 0) ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+
+    do
+    {
+        buf[--i] = (char)('0' + (u % 10));
+        u /= 10;
+    } while (u > 0);
+    if (value < 0) buf[--i] = '-';
+    pIo->write(&buf[i], sizeof(buf) - i);
+}
+
+/**
+ * @brief Write a float with 3 decimals (no printf, newlib float formatting uses the heap)
+ */
+static void sh_PutFloat(float value)
+{
+    if (value < 0)
+    {
+        sh_Puts("-");
+        value = -value;
+    }
+    uint32_t scaled = (uint32_t)(value * 1000.0f + 0.5f);
+    char frac[5] = {'.', 0, 0, 0, 0};
+    sh_PutInt((int32_t)(scaled / 1000));
+    frac[1] = (char)('0' + (scaled / 100) % 10);
+    frac[2] = (char)('0' + (scaled / 10) % 10);
+    frac[3] = (char)('0' + scaled % 10);
+    sh_Puts(frac);
+}
+
+/**
+ * @brief Parse a decimal number with an optional sign and fraction
+ * @param str   The token
+ * @param value Parsed value
+ * @retval 1 if the whole token is a number, 0 otherwise
+ */
+static uint8_t sh_ParseNumber(const char* str, float* value)
+{
+    float result = 0.0f;
+    float scale = 0.0f;  // 0 before the decimal point, then 0.1, 0.01...
+    uint8_t digits = 0;
+    uint8_t negative = 0;
+
+    if (*str == '-' || *str == '+')
+    {
+        negative = (*str == '-');
+        str++;
+    }
+    for (; *str != '\0'; str++)
+    {
+        if (*str >= '0' && *str <= '9')
+        {
+            if (scale == 0.0f)
+            {
+                result = result * 10.0f + (float)(*str - '0');
+            }
+            else
+            {
+                result += scale * (float)(*str - '0');
+                scale *= 0.1f;
+            }
+            digits++;
+        }
+        else if (*str == '.' && scale == 0.0f)
+        {
+            scale = 0.1f;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    *value = negative ? -result : result;
+    return (digits > 0) ? 1 : 0;
+}
+
+/**
+ * @brief Split a line in place into space separated tokens
+ * @retval Number of tokens
+ */
+static uint8_t sh_Tokenize(char* line, char* tokens[SHELL_MAX_TOKENS])
+{
+    uint8_t count = 0;
+
+    while (*line != '\0' && count < SHELL_MAX_TOKENS)
+    {
+        while (*line == ' ' || *line == '\t') *line++ = '\0';
+        if (*line == '\0') break;
+        tokens[count++] = line;
+        while (*line != '\0' && *line != ' ' && *line != '\t') line++;
+    }
+    return count;
+}
+
+/**
+ * @brief Find a parameter by name
+ * @retval Pointer to the table entry, NULL if not found
+ */
+static const shell_param_t* sh_FindParam(const char* name)
+{
+    for (uint8_t i = 0; i < NumParams; i++)
+    {
+        if (strcmp(pParams[i].name, name) == 0) return &pParams[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Read a parameter value as float
+ */
+static float sh_GetValue(const shell_param_t* param)
+{
+    void* pValue = pBase + param->offset;
+    switch (param->type)
+    {
+    case SH_U8:  return (float)*(uint8_t*)pValue;
+    case SH_U16: return (float)*(uint16_t*)pValue;
+    case SH_I16: return (float)*(int16_t*)pValue;
+    case SH_U32: return (float)*(uint32_t*)pValue;
+    case SH_I32: return (float)*(int32_t*)pValue;
+    default:     return *(float*)pValue;
+    }
+}
+
+/**
+ * @brief Write a parameter value (already range checked)
+ */
+static void sh_SetValue(const shell_param_t* param, float value)
+{
+    void* pValue = pBase + param->offset;
+    switch (param->type)
+    {
+    case SH_U8:  *(uint8_t*)pValue = (uint8_t)value;   break;
+    case SH_U16: *(uint16_t*)pValue = (uint16_t)value; break;
+    case SH_I16: *(int16_t*)pValue = (int16_t)value;   break;
+    case SH_U32: *(uint32_t*)pValue = (uint32_t)value; break;
+    case SH_I32: *(int32_t*)pValue = (int32_t)value;   break;
+    default:     *(float*)pValue = value;              break;
+    }
+}
+
+/**
+ * @brief Print "name = value"
+ */
+static void sh_PrintParam(const shell_param_t* param)
+{
+    sh_Puts(param->name);
+    sh_Puts(" = ");
+    if (param->type == SH_F32) sh_PutFloat(sh_GetValue(param));
+    else                       sh_PutInt((int32_t)sh_GetValue(param));
+}
+
+/**
+ * @brief Initialize the shell
+ * @param io        Transport
+ * @param params    Parameter table (const)
+ * @param numParams Number of parameters
+ * @param base      Parameter struct the table offsets refer to
+ * @param stats     Statistics table (const), may be NULL
+ * @param numStats  Number of statistics
+ */
+void sh_Init(const shell_io_t* io, const shell_param_t* params, uint8_t numParams, void* base,
+             const shell_stat_t* stats, uint8_t numStats)
+{
+    pParams = params;
+    NumParams = numParams;
+    pBase = (uint8_t*)base;
+    pStats = stats;
+    NumStats = numStats;
+    LineLen = 0;
+    pIo = io;
+}
+
+/**
+ * @brief Register application commands
+ * @param cmds    Command table (const), may be NULL
+ * @param numCmds Number of commands
+ * @note  Application commands take no argument and are looked up after the built in ones.
+ */
+void sh_SetCommands(const shell_cmd_t* cmds, uint8_t numCmds)
+{
+    pCmds = cmds;
+    NumCmds = numCmds;
+}
+
+/**
+ * @brief Execute one command line
+ * @param line The command, modified in place by the tokenizer
+ * @note  Commands: get <name>, set <name> <value>, dump, stats, help and the application
+ *        commands.
+ */
+void sh_Execute(char* line)
+{
+    char* tokens[SHELL_MAX_TOKENS];
+    uint8_t count = sh_Tokenize(line, tokens);
+
+    if (count == 0) return;
+
+    if (strcmp(tokens[0], "get") == 0 && count == 2)
+    {
+        const shell_param_t* param = sh_FindParam(tokens[1]);
+        if (param == NULL)
+        {
+            sh_Puts("unknown parameter\r\n");
+            return;
+        }
+        sh_PrintParam(param);
+        sh_Puts("\r\n");
+    }
+    else if (strcmp(tokens[0], "set") == 0 && count == 3)
+    {
+        const shell_param_t* param = sh_FindParam(tokens[1]);
+        float value;
+        if (param == NULL)
+        {
+            sh_Puts("unknown parameter\r\n");
+            return;
+        }
+        if (!sh_ParseNumber(tokens[2], &value) || (param->type != SH_F32 && value != (float)(int32_t)value))
+        {
+            sh_Puts("invalid value\r\n");
+            return;
+        }
+        if (value < param->min || value > param->max)
+        {
+            sh_Puts("out of range [");
+            if (param->type == SH_F32) { sh_PutFloat(param->min); sh_Puts(", "); sh_PutFloat(param->max); }
+            else                       { sh_PutInt((int32_t)param->min); sh_Puts(", "); sh_PutInt((int32_t)param->max); }
+            sh_Puts("]\r\n");
+            return;
+        }
+        sh_SetValue(param, value);
+        sh_PrintParam(param);
+        sh_Puts("\r\n");
+    }
+    else if (strcmp(tokens[0], "dump") == 0)
+    {
+        for (uint8_t i = 0; i < NumParams; i++)
+        {
+            sh_PrintParam(&pParams[i]);
+            sh_Puts(" (");
+            sh_Puts(TypeNames[pParams[i].type]);
+            sh_Puts(")\r\n");
+        }
+    }
+    else if (strcmp(tokens[0], "stats") == 0)
+    {
+        for (uint8_t i = 0; i < NumStats; i++)
+        {
+            sh_Puts(pStats[i].name);
+            sh_Puts(" = ");
+            sh_PutInt((int32_t)pStats[i].get());
+            sh_Puts("\r\n");
+        }
+    }
+    else
+    {
+        for (uint8_t i = 0; i < NumCmds; i++)
+        {
+            if (count == 1 && strcmp(tokens[0], pCmds[i].name) == 0)
+            {
+                pCmds[i].run(pIo);
+                return;
+            }
+        }
+        sh_Puts("commands: get <name> | set <name> <value> | dump | stats");
+        for (uint8_t i = 0; i < NumCmds; i++)
+        {
+            sh_Puts(" | ");
+            sh_Puts(pCmds[i].name);
+        }
+        sh_Puts("\r\n");
+    }
+}
+
+/**
+ * @brief Read the received bytes and execute the complete lines
+ * @note  Call in idle time only (main loop, outside the control tick). Characters are echoed,
+ *        backspace is handled and a too long line is discarded.
+ */
+void sh_Process(void)
+{
+    int c;
+
+    if (pIo == NULL) return;
+
+    while ((c = pIo->read()) >= 0)
+    {
+        if (c == '\r' || c == '\n')
+        {
+            if (LineLen == 0) continue;
+            sh_Puts("\r\n");
+            if (LineLen < SHELL_LINE_SIZE)
+            {
+                Line[LineLen] = '\0';
+                sh_Execute(Line);
+            }
+            else
+            {
+                sh_Puts("line too long\r\n");
+            }
+            LineLen = 0;
+            sh_Puts(SHELL_PROMPT);
+        }
+        else if (c == '\b' || c == 0x7F)
+        {
+            if (LineLen > 0 && LineLen < SHELL_LINE_SIZE)
+            {
+                LineLen--;
+                sh_Puts("\b \b");
+            }
+        }
+        else if (LineLen < SHELL_LINE_SIZE)
+        {
+            char ch = (char)c;
+            if (LineLen < SHELL_LINE_SIZE - 1) Line[LineLen] = ch;
+            LineLen++;  // Reaching SHELL_LINE_SIZE marks the line as too long
+            pIo->write(&ch, 1);
+        }
+    }
+}
@@ -2,137 +2,376 @@
 #include "spi.h"
 
 
-// SPI Driver: Implementation for SPI communication and processing using DMA
+// SPI Driver: Multi instance SPI transport using DMA (transaction queue, ping-pong streaming)
 
 /* =============================== Global Variables =============================== */
 #ifdef HAL_SPI_MODULE_ENABLED
-SPI_HandleTypeDef* pSpi;        //SPI handle pointer
-spi_message_t dummy ; // Dummy message for SPI transmission
 static handler_set_t* pHandlers = NULL; // Pointer to the handler set form the platform layer
 static plt_callbacks_t* pCallbacks = NULL; // Pointer to the callback function pointers from the platform layer
-
-uint8_t Spi_RxData[sizeof(spi_message_t)] = {0};  // DMA buffer for SPI reception
 void (*Spi_RxCallback)(spi_message_t *msg) = NULL;  // Callback function for SPI reception
 
-static Queue_t spiRxQueue = {0}; // Queue for SPI received messages
-static QueueItem_t spiRxMessage = {
-    .data = NULL,
-    .sizeof_data = sizeof(spi_message_t)
-};
+/**
+ * @brief SPI bus struct
+ * @note  Master: transactions are queued and the DMA complete interrupt starts the next one,
+ *        spi_message_t frames use their own slots so a received frame is never overwritten
+ *        before it is copied to the RX ring.
+ *        Slave: the DMA streams continuously (circular) over two frames, while one half is
+ *        transferred the other is emptied to the RX ring and refilled from the TX ring.
+ */
+typedef struct{
+    SPI_HandleTypeDef* hspi;
+
+    spi_transaction_t* queue[SPI_TXN_QUEUE_SIZE];   // Pending transactions (master)
+    volatile uint8_t head;                          // Next free entry
+    volatile uint8_t tail;                          // Next transaction to start
+    spi_transaction_t* volatile active;             // Transaction owned by the DMA, NULL when idle
+
+    spi_transaction_t msgTxn[SPI_MSG_SLOTS];        // spi_message_t frames in flight (master)
+    spi_message_t msgTx[SPI_MSG_SLOTS];
+    spi_message_t msgRx[SPI_MSG_SLOTS];
+    volatile uint8_t msgBusy[SPI_MSG_SLOTS];
+
+    spi_message_t streamTx[2];                      // Ping-pong frames (slave, circular DMA)
+    spi_message_t streamRx[2];
+
+    RingBuffer_t rxRing;                            // Received frames, read by plt_SpiProcessRxMsgs
+    uint8_t rxRingBuffer[SPI_RX_RING_SIZE];
+    RingBuffer_t txRing;                            // Frames waiting to be streamed (slave)
+    uint8_t txRingBuffer[SPI_TX_RING_SIZE];
+}spi_bus_t;
+
+static spi_bus_t SpiBuses[SPI_NUM_BUSES];  // Indexed by SpiChanel_t - 1
 
 /*========================= Function Definitions =========================*/
 
 /**
-  * @brief  Initializes the SPI module for reception and assigns a processing callback.
-  * @param  huart      Pointer to the SPI handle to initialize
-  * @param  callback   Function pointer to the RX processing callback
+ * @brief Gets the bus of a SPI handle.
+ * @retval Pointer to the bus, NULL if the SPI is not used by the platform
+ */
+static spi_bus_t* plt_SpiGetBus(SPI_HandleTypeDef* hspi)
+{
+    for (uint8_t i = 0; i < SPI_NUM_BUSES; i++)
+    {
+        if (SpiBuses[i].hspi == hspi)
+        {
+            return &SpiBuses[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Starts the next queued transaction of a master bus if the bus is idle.
+ * @note  Called after a submit and from the DMA complete interrupt, the check and start are
+ *        done with interrupts disabled so only one of them can start the transfer.
+ */
+static void plt_SpiStartNext(spi_bus_t* bus)
+{
+    spi_transaction_t* txn = NULL;
+    HAL_StatusTypeDef status = HAL_OK;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (bus->active == NULL && bus->head != bus->tail && bus->hspi->State == HAL_SPI_STATE_READY)
+    {
+        txn = bus->queue[bus->tail & (SPI_TXN_QUEUE_SIZE - 1)];
+        bus->tail++;
+        bus->active = txn;
+
+        if (txn->csPort != NULL) HAL_GPIO_WritePin(txn->csPort, txn->csPin, GPIO_PIN_RESET);
+        if (txn->pRx == NULL)      status = HAL_SPI_Transmit_DMA(bus->hspi, (uint8_t*)txn->pTx, txn->len);
+        else if (txn->pTx == NULL) status = HAL_SPI_Receive_DMA(bus->hspi, txn->pRx, txn->len);
+        else                       status = HAL_SPI_TransmitReceive_DMA(bus->hspi, (uint8_t*)txn->pTx, txn->pRx, txn->len);
+
+        if (status != HAL_OK)
+        {
+            if (txn->csPort != NULL) HAL_GPIO_WritePin(txn->csPort, txn->csPin, GPIO_PIN_SET);
+            bus->active = NULL;
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    if (txn != NULL && status != HAL_OK && txn->done)
+    {
+        txn->done(txn, status);  // Failed to start, report it instead of dropping it silently
+    }
+}
+
+/**
+ * @brief Finishes the active transaction of a master bus and starts the next one.
+ */
+static void plt_SpiComplete(spi_bus_t* bus, HAL_StatusTypeDef status)
+{
+    spi_transaction_t* txn = bus->active;
+    if (txn == NULL) return;
+
+    if (txn->csPort != NULL) HAL_GPIO_WritePin(txn->csPort, txn->csPin, GPIO_PIN_SET);
+    bus->active = NULL;
+    plt_SpiStartNext(bus);  // Keep the bus busy, then notify the owner
+
+    if (txn->done)
+    {
+        txn->done(txn, status);
+    }
+}
+
+/**
+ * @brief Completion of a spi_message_t frame sent by a master bus.
+ * @note  Frames with id 0 are idle fillers of the peer and are not delivered.
+ */
+static void plt_SpiMsgDone(spi_transaction_t* txn, HAL_StatusTypeDef status)
+{
+    spi_bus_t* bus = (spi_bus_t*)txn->ctx;
+    uint8_t slot = (uint8_t)(txn - bus->msgTxn);
+
+    if (status == HAL_OK && bus->msgRx[slot].id != 0)
+    {
+        Ring_Write(&bus->rxRing, (uint8_t*)&bus->msgRx[slot], sizeof(spi_message_t));
+    }
+    bus->msgBusy[slot] = 0;
+}
+
+/**
+ * @brief Exchanges one ping-pong half of a slave bus.
+ * @param half The half the DMA just finished (0 or 1), the DMA is now on the other one
+ */
+static void plt_SpiStreamHalf(spi_bus_t* bus, uint8_t half)
+{
+    if (bus->streamRx[half].id != 0)
+    {
+        Ring_Write(&bus->rxRing, (uint8_t*)&bus->streamRx[half], sizeof(spi_message_t));
+    }
+    if (Ring_Used(&bus->txRing) >= sizeof(spi_message_t))
+    {
+        Ring_Read(&bus->txRing, (uint8_t*)&bus->streamTx[half], sizeof(spi_message_t));
+    }
+    else
+    {
+        memset(&bus->streamTx[half], 0, sizeof(spi_message_t));  // Idle filler
+    }
+}
+
+/**
+ * @brief Starts the continuous ping-pong streaming of a slave bus.
+ */
+static void plt_SpiStartStream(spi_bus_t* bus)
+{
+    memset(bus->streamTx, 0, sizeof(bus->streamTx));
+    HAL_SPI_TransmitReceive_DMA(bus->hspi, (uint8_t*)bus->streamTx, (uint8_t*)bus->streamRx, (uint16_t)sizeof(bus->streamTx));
+}
+
+/**
+  * @brief  Initializes the SPI buses and assigns the RX processing callback.
   * @retval None
   *
-  * @note   This function enables SPI reception in interrupt mode.
+  * @note   Every SPI handle of the handler set gets its own bus. Slave buses start streaming
+  *         immediately, master buses wait for transactions.
+  *  ! BE CareFull the Rx and Tx DMA channels of a slave SPI need to be in Circular mode
+  *  ! BE CareFull the Rx and Tx DMA channels of a master SPI need to be in Normal mode
   */
-void plt_SpiInit(size_t rx_queue_size)
+void plt_SpiInit(void)
 {
+    SPI_HandleTypeDef* handles[SPI_NUM_BUSES];
+
     pHandlers = plt_GetHandlersPointer();
     pCallbacks = plt_GetCallbacksPointer();
-    if (pHandlers->hspi1 != NULL)
+    Spi_RxCallback = pCallbacks->SPI_RxCallback;        // Register the RX processing callback
+
+    handles[Spi1 - 1] = pHandlers->hspi1;
+    handles[Spi2 - 1] = pHandlers->hspi2;
+    handles[Spi3 - 1] = pHandlers->hspi3;
+
+    for (uint8_t i = 0; i < SPI_NUM_BUSES; i++)
     {
-        pSpi = pHandlers->hspi1;
-        pSpi->RxCpltCallback = HAL_SPI_RxCpltCallback;
+        spi_bus_t* bus = &SpiBuses[i];
+        if (handles[i] == NULL) continue;
+
+        bus->hspi = handles[i];
+        bus->head = 0;
+        bus->tail = 0;
+        bus->active = NULL;
+        Ring_Init(&bus->rxRing, bus->rxRingBuffer, SPI_RX_RING_SIZE);
+        Ring_Init(&bus->txRing, bus->txRingBuffer, SPI_TX_RING_SIZE);
+        for (uint8_t s = 0; s < SPI_MSG_SLOTS; s++)
+        {
+            bus->msgBusy[s] = 0;
+            bus->msgTxn[s].pTx = (uint8_t*)&bus->msgTx[s];
+            bus->msgTxn[s].pRx = (uint8_t*)&bus->msgRx[s];
+            bus->msgTxn[s].len = (uint16_t)sizeof(spi_message_t);
+            bus->msgTxn[s].csPort = NULL;
+            bus->msgTxn[s].done = plt_SpiMsgDone;
+            bus->msgTxn[s].ctx = bus;
+        }
+
+        if (bus->hspi->Init.Mode == SPI_MODE_SLAVE)
+        {
+            plt_SpiStartStream(bus);
+        }
     }
-    if (pHandlers->hspi2 != NULL)
+}
+
+/**
+ * @brief Queues a transaction on a master bus.
+ * @param chanel The SPI bus
+ * @param txn    The transaction, owned by the caller until txn->done is called
+ * @retval HAL_OK if queued, HAL_BUSY if the queue is full, HAL_ERROR if the bus is not a master
+ * @note  Never waits, may be called from a done callback to chain transfers.
+ */
+HAL_StatusTypeDef plt_SpiSubmit(SpiChanel_t chanel, spi_transaction_t* txn)
+{
+    spi_bus_t* bus = &SpiBuses[chanel - 1];
+
+    if (bus->hspi == NULL || bus->hspi->Init.Mode != SPI_MODE_MASTER)
     {
-        pSpi = pHandlers->hspi2;
-        pSpi->RxCpltCallback = HAL_SPI_RxCpltCallback;
+        return HAL_ERROR;
     }
-    if (pHandlers->hspi3 != NULL)
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if ((uint8_t)(bus->head - bus->tail) >= SPI_TXN_QUEUE_SIZE)
     {
-        pSpi = pHandlers->hspi3;
-        pSpi->RxCpltCallback = HAL_SPI_RxCpltCallback;
+        __set_PRIMASK(primask);
+        return HAL_BUSY;
     }
+    bus->queue[bus->head & (SPI_TXN_QUEUE_SIZE - 1)] = txn;
+    bus->head++;
+    __set_PRIMASK(primask);
 
-    Spi_RxCallback = pCallbacks->SPI_RxCallback;        // Register the RX processing callback
-    Queue_Init(&spiRxQueue,&spiRxMessage,rx_queue_size);  // Initialize the RX queue
-  
-   if(pSpi->Init.Mode == SPI_MODE_MASTER)
-   {
-    HAL_SPI_TransmitReceive_DMA(pSpi,(uint8_t*)&dummy,Spi_RxData,(uint16_t)sizeof(spi_message_t)); // Start SPI transmission
-   }
-
-   if(pSpi->Init.Mode == SPI_MODE_SLAVE)
-   {
-    HAL_SPI_Receive_DMA(pSpi, Spi_RxData, sizeof(spi_message_t));  // Start SPI reception
+    plt_SpiStartNext(bus);
+    return HAL_OK;
+}
+
+/**
+ * @brief Sends a standard SPI message.
+ * @param chanel The SPI bus
+ * @param pData  Pointer to the message, copied before the function returns
+ * @retval HAL_OK if queued, HAL_BUSY if no frame slot is free, HAL_ERROR if the bus is not used
+ *
+ * @note Master: the frame is exchanged full duplex, the frame received at the same time goes to the
+ *       RX callback. Slave: the frame is streamed in the next free ping-pong half.
+*/
+HAL_StatusTypeDef plt_SpiSendMsg(SpiChanel_t chanel, spi_message_t* pData)
+{
+    spi_bus_t* bus = &SpiBuses[chanel - 1];
+
+    if (bus->hspi == NULL) return HAL_ERROR;
+
+    if (bus->hspi->Init.Mode == SPI_MODE_SLAVE)
+    {
+        return (Ring_Write(&bus->txRing, (uint8_t*)pData, sizeof(spi_message_t)) != 0) ? HAL_OK : HAL_BUSY;
     }
+
+    for (uint8_t s = 0; s < SPI_MSG_SLOTS; s++)
+    {
+        if (!bus->msgBusy[s])
+        {
+            bus->msgBusy[s] = 1;
+            memcpy(&bus->msgTx[s], pData, sizeof(spi_message_t));
+            if (plt_SpiSubmit(chanel, &bus->msgTxn[s]) != HAL_OK)
+            {
+                bus->msgBusy[s] = 0;
+                return HAL_BUSY;
+            }
+            return HAL_OK;
+        }
+    }
+    return HAL_BUSY;
 }
 
+/**
+ * @brief Checks if a master bus has finished all its transactions.
+ * @retval 1 if nothing is queued or running, 0 otherwise
+ */
+uint8_t plt_SpiIdle(SpiChanel_t chanel)
+{
+    spi_bus_t* bus = &SpiBuses[chanel - 1];
+    return (bus->head == bus->tail && bus->active == NULL) ? 1 : 0;
+}
 
 /**
-  * @brief  Processes received SPI messages from the queue.
+  * @brief  Processes received SPI messages.
   * @note   This function should be called periodically in the main loop. It
-  *         dequeues messages and invokes the registered callback for processing.
+  *         reads the frames received by every bus and invokes the registered callback for processing.
   */
 void plt_SpiProcessRxMsgs(void)
 {
     spi_message_t data = {0};
-    while (spiRxQueue.status != QUEUE_EMPTY)
+    for (uint8_t i = 0; i < SPI_NUM_BUSES; i++)
     {
-        Queue_Pop(&spiRxQueue, &data);
-        if (Spi_RxCallback)
+        while (Ring_Read(&SpiBuses[i].rxRing, (uint8_t*)&data, sizeof(spi_message_t)) == sizeof(spi_message_t))
         {
-            Spi_RxCallback(&data);
+            if (Spi_RxCallback)
+            {
+                Spi_RxCallback(&data);
+            }
         }
     }
+}
 
+/**
+ * @brief Gets the number of received frames dropped because the RX ring of a bus was full.
+ */
+uint32_t plt_SpiGetDroppedCount(SpiChanel_t chanel)
+{
+    return SpiBuses[chanel - 1].rxRing.overflow;
 }
+
+
+/* ============================ Interupt Callbacks ============================ */
+
 /**
- * @brief Sends a standard SPI message through the SPI DMA.
- * @param pData Pointer to the data buffer to be sent
- * @retval None
- * 
- * @note This function pushes the data for transmission and starts the DMA transfer.
-*/ 
-void plt_SpiSendMsg(spi_message_t* pData)
-{  
-    if(pSpi->State != HAL_SPI_STATE_READY) return;
+  * @brief  SPI transmit complete callback (master transmit only transactions).
+  */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_t* bus = plt_SpiGetBus(hspi);
+    if (bus != NULL) plt_SpiComplete(bus, HAL_OK);
+}
 
-    if(pSpi->Init.Mode == SPI_MODE_MASTER)
-    {
-        HAL_SPI_TransmitReceive_DMA(pSpi,(uint8_t *)pData,Spi_RxData,(uint16_t)sizeof(spi_message_t));
-    }
- 
-    if(pSpi->Init.Mode == SPI_MODE_SLAVE)
-    {
-        HAL_SPI_Transmit_DMA(pSpi,(uint8_t *)pData, sizeof(spi_message_t));
-     }
-    return;
+/**
+  * @brief  SPI receive complete callback (master receive only transactions).
+  */
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_t* bus = plt_SpiGetBus(hspi);
+    if (bus != NULL) plt_SpiComplete(bus, HAL_OK);
 }
 
+/**
+  * @brief  SPI full duplex complete callback.
+  * @note   Master: end of a transaction. Slave: second ping-pong half done, the circular DMA
+  *         already continues with the first half.
+  */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_t* bus = plt_SpiGetBus(hspi);
+    if (bus == NULL) return;
 
+    if (hspi->Init.Mode == SPI_MODE_SLAVE) plt_SpiStreamHalf(bus, 1);
+    else                                   plt_SpiComplete(bus, HAL_OK);
+}
 
-/* ============================ Interupt Callbacks ============================ */
+/**
+  * @brief  SPI full duplex half complete callback, first ping-pong half of a slave bus done.
+  */
+void HAL_SPI_TxRxHalfCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_t* bus = plt_SpiGetBus(hspi);
+    if (bus != NULL && hspi->Init.Mode == SPI_MODE_SLAVE) plt_SpiStreamHalf(bus, 0);
+}
 
 /**
-  * @brief  SPI receive complete callback triggered in interrupt context.
-  * @param  hspi Pointer to the SPI handle
-  * @retval None
-  *
-  * @note   This function is called when the SPI reception is complete. It pushes the  received data to the queue.
+  * @brief  SPI error callback.
+  * @note   The HAL has stopped the DMA: a master reports the error to the transaction owner,
+  *         a slave restarts the streaming.
   */
- void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
- {   
-     
-     // Push the received data to the queue
-     Queue_Push(&spiRxQueue, Spi_RxData);
-     memset(Spi_RxData, 0, sizeof(Spi_RxData));
-     // Start the next reception in interrupt mode
-     HAL_SPI_Receive_DMA(pSpi, Spi_RxData, sizeof(spi_message_t));
-     hspi->State = HAL_SPI_STATE_READY;
-     
- }
- void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
- {
-     // Push the received data to the queue
-     Queue_Push(&spiRxQueue, Spi_RxData);
-     memset(Spi_RxData, 0, sizeof(Spi_RxData));
-     hspi->State = HAL_SPI_STATE_READY; 
- }
- #endif
\ No newline at end of file
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_t* bus = plt_SpiGetBus(hspi);
+    if (bus == NULL) return;
+
+    if (hspi->Init.Mode == SPI_MODE_SLAVE) plt_SpiStartStream(bus);
+    else                                   plt_SpiComplete(bus, HAL_ERROR);
+}
+#endif
@@ -2,7 +2,7 @@
 #include "uart.h"
 
 #ifdef HAL_UART_MODULE_ENABLED
-// UART Driver: Implementation for UART communication using DMA for transmission only
+// UART Driver: Implementation for UART communication using DMA, framed (COBS + CRC16) MCU links
 
 /* =============================== Global Variables =============================== */
 UART_HandleTypeDef* pUart1;         // UART handle pinters
@@ -11,15 +11,42 @@ UART_HandleTypeDef* pUart3;         // UART handle pinters
 static handler_set_t* pHandlers = NULL;    // Pointer to the handler set from the platform layer
 static plt_callbacks_t* pCallbacks = NULL; // Pointer to the callback function pointers from the platform layer
 uart_message_t Uart_TxData = {0};  // UART message structure for transmission
-debug_message_t Debug_TxData = {0};  // Debug message structure for transmission
-uint8_t Uart_RxData[2][sizeof(uart_message_t)] = {0};  // DMA buffer for SPI reception
 void (*Uart_RxCallback)(uart_message_t *) = NULL;  // Callback function for UART reception
 
-static Queue_t uartRxQueue = {0};
-static QueueItem_t uartRxMessage = {
-    .data = NULL,
-    .sizeof_data = sizeof(uart_message_t)
-};
+/**
+ * @brief UART RX link struct
+ * @note  The circular DMA writes dma[], the idle line / half / full events copy the new bytes
+ *        to the ring and plt_UartProcessRxMsgs parses the frames from the ring in the main loop.
+ */
+typedef struct{
+    UART_HandleTypeDef* huart;
+    uint8_t dma[UART_RX_DMA_SIZE];              // Circular DMA buffer
+    uint16_t dmaPos;                            // DMA position already copied to the ring
+    RingBuffer_t ring;                          // Bytes waiting for the framer
+    uint8_t ringBuffer[UART_RX_RING_SIZE];
+    uint8_t frame[UART_MAX_ENCODED_FRAME];      // Frame being assembled (COBS encoded)
+    uint16_t frameLen;
+    uint8_t frameOverflow;                      // Frame longer than UART_MAX_ENCODED_FRAME, dropped at the delimiter
+    uart_rx_stats_t stats;
+}uart_rx_link_t;
+
+static uart_rx_link_t UartRxLinks[UART_RX_LINKS];    // Indexed by UartChanel_t - 1, USART2 is not framed (shell input)
+
+/**
+ * @brief UART TX link struct
+ * @note  Frames (or debug bytes) are queued in the ring, the TX DMA sends the largest contiguous
+ *        block at once and the TX complete interrupt starts the next block, so consecutive
+ *        messages go out in one burst and nobody waits for the UART.
+ */
+typedef struct{
+    UART_HandleTypeDef* huart;
+    RingBuffer_t ring;
+    volatile uint16_t dmaLen;                   // Bytes of the ring owned by the running DMA, 0 when idle
+}uart_tx_link_t;
+
+static uart_tx_link_t UartTxLinks[3];                          // Indexed by UartChanel_t - 1
+static uint8_t UartTxBuffer[UART_MCU_LINKS][UART_TX_RING_SIZE]; // Frame storage of USART1 and USART3
+void (*Uart_TxCallback)(UartChanel_t) = NULL;                  // Callback function for UART transmission complete
 
 static Queue_t uartTxQueue = {0};
 static QueueItem_t uartTxMessage = {
@@ -27,14 +54,113 @@ static QueueItem_t uartTxMessage = {
     .sizeof_data = sizeof(uart_message_t)
 };
 
-static Queue_t debugTxQueue = {0};
-static QueueItem_t debugTxMessage = {
-    .data = NULL,
-    .sizeof_data = sizeof(debug_message_t)
-};
+static uint8_t DebugTxBuffer[DEBUG_TX_BUFFER_SIZE];  // Debug (printf) byte stream storage, USART2 TX link
 
 /*========================= Function Definitions =========================*/
 
+/**
+ * @brief Gets the RX link of a UART handle.
+ * @retval Pointer to the link, NULL if the UART is not a framed link
+ */
+static uart_rx_link_t* plt_UartGetRxLink(UART_HandleTypeDef* huart)
+{
+    for (uint8_t i = 0; i < UART_RX_LINKS; i++)
+    {
+        if (UartRxLinks[i].huart == huart)
+        {
+            return &UartRxLinks[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Starts the circular idle line DMA reception of a link.
+ * @param link  The link to start
+ * @param huart The UART handle of the link
+ * @note  Armed once, the reception never stops unless a line error aborts it (see HAL_UART_ErrorCallback).
+ */
+static void plt_UartStartRx(uart_rx_link_t* link, UART_HandleTypeDef* huart)
+{
+    if (link->huart == NULL)
+    {
+        Ring_Init(&link->ring,link->ringBuffer,UART_RX_RING_SIZE);
+    }
+    link->huart = huart;
+    link->dmaPos = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(huart,link->dma,UART_RX_DMA_SIZE);
+}
+
+/**
+ * @brief Initializes the TX link of a UART.
+ */
+static void plt_UartInitTx(UartChanel_t chanel, UART_HandleTypeDef* huart, uint8_t* buffer, size_t size)
+{
+    uart_tx_link_t* link = &UartTxLinks[chanel - 1];
+    Ring_Init(&link->ring,buffer,size);
+    link->dmaLen = 0;
+    link->huart = huart;
+}
+
+/**
+ * @brief Starts the TX DMA of a link on the next contiguous block of its ring buffer.
+ * @note Called after queuing data and from the TX complete interrupt, the check and start are
+ *       done with interrupts disabled so only one of them can start the transfer.
+ */
+static void plt_UartStartTx(uart_tx_link_t* link)
+{
+    uint8_t* pData;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if(link->dmaLen == 0 && link->huart->gState == HAL_UART_STATE_READY)
+    {
+        size_t len = Ring_PeekContiguous(&link->ring,&pData);
+        if(len > UINT16_MAX)
+        {
+            len = UINT16_MAX;
+        }
+        if(len > 0)
+        {
+            link->dmaLen = (uint16_t)len;
+            if(HAL_UART_Transmit_DMA(link->huart,pData,(uint16_t)len) != HAL_OK)
+            {
+                link->dmaLen = 0;  // Retried on the next send
+            }
+        }
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Checks and delivers one complete frame of a link.
+ * @note  Frame = COBS(uart_message_t + CRC16 big endian) + COBS_DELIMITER.
+ */
+static void plt_UartHandleFrame(uart_rx_link_t* link)
+{
+    uart_message_t msg;
+    size_t len = Cobs_Decode(link->frame,link->frameLen,link->frame);
+
+    if (len != sizeof(uart_message_t) + sizeof(uint16_t))
+    {
+        link->stats.framingErrors++;
+        return;
+    }
+    uint16_t crc = (uint16_t)((link->frame[len - 2] << 8) | link->frame[len - 1]);
+    if (Crc16_Calc(link->frame,len - 2,CRC16_INIT) != crc)
+    {
+        link->stats.crcErrors++;
+        return;
+    }
+    link->stats.frames++;
+    memcpy(&msg,link->frame,sizeof(uart_message_t));
+    if (Uart_RxCallback)  // Check if the callback function is set
+    {
+        Uart_RxCallback(&msg);  // Call the RX processing callback
+    }
+}
+
 /**
   * @brief  Initializes the UART module for transmission and sets up the queue and buffer.
   * @param  pUart Pointer to the UART handle to initialize       
@@ -50,40 +176,38 @@ void plt_UartInit(size_t tx_queue_size)
     pHandlers = plt_GetHandlersPointer();  // Get the handler set pointer
     pCallbacks = plt_GetCallbacksPointer();  // Get the callback function pointer
     Uart_RxCallback = pCallbacks->UART_RxCallback; // Set the UART RX callback function pointer
-    Queue_Init(&uartRxQueue,&uartRxMessage,tx_queue_size);  // Initialize the RX queue for UART1 reception
+    Uart_TxCallback = pCallbacks->UART_TxCallback; // Set the UART TX callback function pointer
 
     Queue_Init(&uartTxQueue,&uartTxMessage,tx_queue_size);  // Initialize the TX queue for UART1 transmission
 
     if(pHandlers->huart1 != NULL)
     {
         pUart1 = pHandlers->huart1;  // Set the UART handle pointer
-        
-        HAL_UART_Receive_DMA(pUart1,Uart_RxData,(uint16_t)sizeof(uart_message_t));
+        plt_UartInitTx(Uart1,pUart1,UartTxBuffer[0],UART_TX_RING_SIZE);
+        plt_UartStartRx(&UartRxLinks[Uart1 - 1],pUart1);
     }
 
 
     if(pHandlers->huart2 != NULL)
     {
         pUart2 = pHandlers->huart2;  // Set the UART handle pointer
-        Queue_Init(&debugTxQueue,&debugTxMessage,tx_queue_size);  // Initialize the debugging queue for UART2  transmission for 
+        plt_UartInitTx(Uart2,pUart2,DebugTxBuffer,DEBUG_TX_BUFFER_SIZE);  // Initialize the debug stream for UART2 transmission
+        plt_UartStartRx(&UartRxLinks[Uart2 - 1],pUart2);                 // Raw bytes for the shell, read with plt_DebugRead
     }
 
     if(pHandlers->huart3 != NULL)
     {
         pUart3 = pHandlers->huart3;  // Set the UART handle pointer
-        HAL_UART_Receive_DMA(pUart3,Uart_RxData,(uint16_t)sizeof(uart_message_t));
+        plt_UartInitTx(Uart3,pUart3,UartTxBuffer[1],UART_TX_RING_SIZE);
+        plt_UartStartRx(&UartRxLinks[Uart3 - 1],pUart3);
     }
-
-
-
-    
 }
 
 /**
  * @brief Send stdios printf to UART
  * 
  * @note This function is used to redirect the printf output to UART, _write is a weak function that is called by printf to write the output to the desired stream
- * @TODO: Implement the function to write the data with UART via DMA
+ *       The data is only copied to the debug ring buffer, the transmission runs in the background via DMA.
  */
 
  int _write(int file,   //FILE DESCRIPTOR
@@ -101,116 +225,247 @@ void plt_UartInit(size_t tx_queue_size)
 }
 
 /**
- * @brief Processes received UART messages from the queue.
- * @note This function should be called periodically in the main loop. It dequeues messages and invokes the registered callback for processing.
+ * @brief Processes received UART frames.
+ * @note This function should be called periodically in the main loop. It parses the bytes received
+ *       by each link, checks the frames and invokes the registered callback for every valid message.
+ *       A corrupted or lost byte only drops the frame it belongs to.
  */
 void plt_UartProcessRxMsgs(void)
 {
-    uart_message_t data = {0};
-    while (uartRxQueue.status != QUEUE_EMPTY)
+    uint8_t bytes[32];
+    size_t count;
+
+    for (uint8_t l = 0; l < UART_RX_LINKS; l++)
     {
-        Queue_Pop(&uartRxQueue, &data);  // Pop the data from the queue
-        if (Uart_RxCallback)  // Check if the callback function is set
+        uart_rx_link_t* link = &UartRxLinks[l];
+        if (link->huart == NULL || l == Uart2 - 1) continue;  // Not used or not framed
+
+        while ((count = Ring_Read(&link->ring,bytes,sizeof(bytes))) > 0)
         {
-            Uart_RxCallback(&data);  // Call the RX processing callback
+            for (size_t i = 0; i < count; i++)
+            {
+                if (bytes[i] == COBS_DELIMITER)
+                {
+                    if (link->frameOverflow) link->stats.framingErrors++;
+                    else if (link->frameLen > 0) plt_UartHandleFrame(link);
+                    link->frameLen = 0;
+                    link->frameOverflow = 0;
+                }
+                else if (link->frameLen < UART_MAX_ENCODED_FRAME)
+                {
+                    link->frame[link->frameLen++] = bytes[i];
+                }
+                else
+                {
+                    link->frameOverflow = 1;
+                }
+            }
         }
     }
 }
 
+/**
+ * @brief Gets the reception statistics of a framed link.
+ * @param chanel Uart1 or Uart3
+ * @param stats  Filled with the counters, dropped = bytes lost because the RX ring was full
+ */
+void plt_UartGetRxStats(UartChanel_t chanel, uart_rx_stats_t* stats)
+{
+    uart_rx_link_t* link = &UartRxLinks[chanel - 1];
+    *stats = link->stats;
+    stats->dropped = link->ring.overflow;
+}
+
 
+/**
+ * @brief Moves the messages of the UART TX queue to the MCU link.
+ * @note Non blocking: stops when the link TX ring is full, the remaining messages are sent on the next call.
+ */
 void plt_UartSyncMCUs(void)
 {
-    uart_message_t data = {0};
-    HAL_StatusTypeDef status = HAL_OK;
     while (uartTxQueue.status != QUEUE_EMPTY)
     {
-        if (status == HAL_OK)
+        if (plt_UartSendMsg(UART_Between_MCUs, (uart_message_t*)Queue_Peek(&uartTxQueue)) != HAL_OK)
         {
-            Queue_Pop(&uartTxQueue, &data);  // Pop the data from the queue
+            break;
         }
-        status = plt_UartSendMsg(UART_Between_MCUs, &data);  // Send the data via UART1
+        Queue_Pop(&uartTxQueue, NULL);  // Queued in the link, drop it from the queue
     }
 }
 
 /**
  * @brief Sends a standard UART message through the UART DMA.
  * @param pData Pointer to the data buffer to be sent
- * @retval None
+ * @retval HAL_OK if the message was queued, HAL_BUSY if the TX ring is full (nothing queued),
+ *         HAL_ERROR if the UART is not used
  * 
- * @note This function pushes the data for transmission and starts the DMA transfer.
+ * @note This function encodes the message as a frame (COBS + CRC16), queues it in the link TX ring
+ *       and starts the DMA if it is idle. It never waits for the UART, use plt_UartTxSpace to check
+ *       how many messages fit before sending a burst.
 */ 
 HAL_StatusTypeDef plt_UartSendMsg(UartChanel_t chanel, uart_message_t* pData)
 {  
-    
-    #ifdef HAL_UART_MODULE_ENABLED
-    HAL_StatusTypeDef status;
-    UART_HandleTypeDef* pUart = (chanel == Uart1) ? pUart1:pUart3;
-    if(pUart->gState == HAL_UART_STATE_READY )
+    uart_tx_link_t* link = &UartTxLinks[chanel - 1];
+    uint8_t payload[sizeof(uart_message_t) + sizeof(uint16_t)];
+    uint8_t frame[UART_MAX_ENCODED_FRAME + 1];
+
+    if(chanel == Uart2 || link->huart == NULL)
     {
-    status = HAL_UART_Transmit_DMA(pUart,(uint8_t*)pData,(uint16_t)sizeof(uart_message_t));
+        return HAL_ERROR;
     }
-    return status;
-    #endif
 
+    uint16_t crc = Crc16_Calc((uint8_t*)pData,sizeof(uart_message_t),CRC16_INIT);
+    memcpy(payload,pData,sizeof(uart_message_t));
+    payload[sizeof(uart_message_t)] = (uint8_t)(crc >> 8);
+    payload[sizeof(uart_message_t) + 1] = (uint8_t)crc;
+
+    size_t len = Cobs_Encode(payload,sizeof(payload),frame);
+    frame[len++] = COBS_DELIMITER;
+    if(Ring_Write(&link->ring,frame,len) == 0)
+    {
+        return HAL_BUSY;
+    }
+    plt_UartStartTx(link);
+    return HAL_OK;
 }
+
+/**
+ * @brief Gets the number of messages that can be sent on a link without getting HAL_BUSY.
+ */
+uint16_t plt_UartTxSpace(UartChanel_t chanel)
+{
+    uart_tx_link_t* link = &UartTxLinks[chanel - 1];
+    if(link->huart == NULL) return 0;
+    return (uint16_t)(Ring_Free(&link->ring) / (UART_MAX_ENCODED_FRAME + 1));
+}
+
+/**
+ * @brief Checks if everything queued on a link has been sent.
+ * @retval 1 if the link TX ring is empty and the DMA is idle, 0 otherwise
+ */
+uint8_t plt_UartTxIdle(UartChanel_t chanel)
+{
+    uart_tx_link_t* link = &UartTxLinks[chanel - 1];
+    return (Ring_Used(&link->ring) == 0 && link->dmaLen == 0) ? 1 : 0;
+}
+
 /**
  * @brief Sends a debug message through the USART2 DMA.
  * @param pData Pointer to the data buffer to be sent
  * @param len Length of the data to be sent
  * 
+ * @note Non blocking: the data is copied to the debug ring buffer and the DMA is started if idle.
+ *       When the ring buffer is full the message is dropped and counted (plt_DebugGetOverflowCount).
  */
 void plt_DebugSendMSG(uint8_t* pData,uint16_t len)
 {
     if(pUart2)
     {
-        Debug_TxData.len = len;
-        memcpy(Debug_TxData.data,pData,len);
-        Queue_Push(&debugTxQueue,&Debug_TxData);  // Push the data into the queue  
+        Ring_Write(&UartTxLinks[Uart2 - 1].ring,pData,len);  // Push the data into the ring buffer
+        plt_UartStartTx(&UartTxLinks[Uart2 - 1]);
     }
 }
 
 /**
- * @brief Gets the UART transmission queue pointer.
- * @retval Pointer to the UART transmission queue.
+ * @brief Reads the raw bytes received on the debug UART.
+ * @param pData Destination
+ * @param len   Maximum number of bytes
+ * @retval Number of bytes read, 0 if nothing was received
+ */
+size_t plt_DebugRead(uint8_t* pData, size_t len)
+{
+    return (pUart2) ? Ring_Read(&UartRxLinks[Uart2 - 1].ring,pData,len) : 0;
+}
+
+/**
+ * @brief Gets the free space of the debug ring buffer in bytes.
+ */
+size_t plt_DebugGetFree(void)
+{
+    return (pUart2) ? Ring_Free(&UartTxLinks[Uart2 - 1].ring) : 0;
+}
+
+/**
+ * @brief Gets the number of debug messages dropped because the debug ring buffer was full.
+ */
+uint32_t plt_DebugGetOverflowCount(void)
+{
+    return UartTxLinks[Uart2 - 1].ring.overflow;
+}
+
+/**
+ * @brief UART TX complete callback function.
+ * @param huart Pointer to the UART handle
+ * @note Releases the block sent by the DMA and chains the next one until the link ring buffer is empty.
+ *       For the MCU links the TX callback is called once the whole queue is sent.
  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        uart_tx_link_t* link = &UartTxLinks[i];
+        if (link->huart != huart) continue;
+
+        Ring_Consume(&link->ring,link->dmaLen);
+        link->dmaLen = 0;
+        plt_UartStartTx(link);
+
+        UartChanel_t chanel = (UartChanel_t)(i + 1);
+        if (chanel != Uart2 && link->dmaLen == 0 && Uart_TxCallback)
+        {
+            Uart_TxCallback(chanel);  // Queue drained, the caller may send the next burst
+        }
+    }
+}
 
- Queue_t* GetDebugTxQueue(void)
- {
-        return &debugTxQueue;
- }
- 
  /**
-  * @brief UART RX complete callback function.
+  * @brief UART RX event callback function (idle line, half and full DMA buffer).
   * @param huart Pointer to the UART handle
-  * @note This function is called when the UART reception is complete.
+  * @param Size  Position of the DMA in the circular buffer
+  * @note Copies the bytes received since the last event to the link ring, the DMA keeps running.
   */
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
- {
-    if (huart->Instance == USART1)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    uart_rx_link_t* link = plt_UartGetRxLink(huart);
+    if (link == NULL) return;
+
+    if (Size != link->dmaPos)
     {
-        Queue_Push(&uartRxQueue,Uart_RxData[1]) ;
-        memcpy(Uart_RxData[1],0,sizeof(uart_message_t));
-        HAL_UART_Receive_DMA(huart,Uart_RxData[1],(uint16_t)sizeof(uart_message_t));
+        if (Size > link->dmaPos)
+        {
+            Ring_Write(&link->ring,&link->dma[link->dmaPos],Size - link->dmaPos);
+        }
+        else // DMA wrapped around
+        {
+            Ring_Write(&link->ring,&link->dma[link->dmaPos],UART_RX_DMA_SIZE - link->dmaPos);
+            Ring_Write(&link->ring,link->dma,Size);
+        }
     }
-    if (huart->Instance == USART3)
+    link->dmaPos = (Size == UART_RX_DMA_SIZE) ? 0 : Size;
+}
+
+ /**
+  * @brief UART error callback function.
+  * @param huart Pointer to the UART handle
+  * @note A line error (overrun, noise, framing) aborts the DMA reception, it is restarted here.
+  *       The frame in progress fails its CRC and is dropped by the framer.
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    uart_rx_link_t* link = plt_UartGetRxLink(huart);
+    if (link == NULL) return;
+
+    link->stats.lineErrors++;
+    if (huart->RxState == HAL_UART_STATE_READY)
     {
-        Queue_Push(&uartRxQueue,Uart_RxData[2]) ;
-        memcpy(Uart_RxData[2],0,sizeof(uart_message_t));
-        HAL_UART_Receive_DMA(huart,Uart_RxData[2],(uint16_t)sizeof(uart_message_t));
+        plt_UartStartRx(link,huart);
     }
-   
- }
+}
 
 
  /**
- * @brief  Returns a pointer to the CAN RX queue.
- * @retval Pointer to the CAN RX queue
- * @note   This function is used to get the pointer to the CAN RX queue.
+ * @brief  Returns a pointer to the UART TX queue.
 */
-Queue_t* plt_GetUartRxQueue()
-{
-    return &uartRxQueue;
-}
 Queue_t* plt_GetUartTxQueue()
 {
     return &uartTxQueue;
@@ -104,3 +104,166 @@ void Queue_free(Queue_t* Q){
     free(Q->buffer);
     return;
 }
+
+/*================================== Ring buffer implementation ===============================*/
+/**
+  * @brief  Initializes a byte ring buffer on a caller provided buffer.
+  * @param  R      Pointer to the ring buffer structure
+  * @param  buffer Storage, usually a static array
+  * @param  size   Size of the storage, must be a power of 2
+  */
+void Ring_Init(RingBuffer_t* R, uint8_t* buffer, size_t size){
+    R->buffer = buffer;
+    R->size = size;
+    R->head = 0;
+    R->tail = 0;
+    R->overflow = 0;
+    return;
+}
+
+/**
+  * @brief  Returns the number of bytes waiting in the ring buffer.
+  */
+size_t Ring_Used(const RingBuffer_t* R){
+    return R->head - R->tail;
+}
+
+/**
+  * @brief  Returns the number of bytes that can be written to the ring buffer.
+  */
+size_t Ring_Free(const RingBuffer_t* R){
+    return R->size - (R->head - R->tail);
+}
+
+/**
+  * @brief  Writes data into the ring buffer (producer side).
+  * @param  R    Pointer to the ring buffer structure
+  * @param  data Pointer to the data
+  * @param  len  Number of bytes
+  * @retval len if the data was written, 0 if it did not fit
+  *
+  * @note   All or nothing: data that does not fit is dropped as a whole and the
+  *         overflow counter is incremented, the call never blocks.
+  */
+size_t Ring_Write(RingBuffer_t* R, const uint8_t* data, size_t len){
+    if(len > Ring_Free(R)){
+        R->overflow++;
+        return 0;
+    }
+    size_t index = R->head & (R->size - 1);
+    size_t first = R->size - index;
+    if(first > len){
+        first = len;
+    }
+    memcpy(&R->buffer[index], data, first);
+    memcpy(R->buffer, &data[first], len - first);
+    __DMB(); // Data must be visible before the consumer sees the new head
+    R->head += len;
+    return len;
+}
+
+/**
+  * @brief  Reads data from the ring buffer (consumer side).
+  * @param  R    Pointer to the ring buffer structure
+  * @param  data Pointer to the destination
+  * @param  len  Maximum number of bytes to read
+  * @retval Number of bytes read
+  */
+size_t Ring_Read(RingBuffer_t* R, uint8_t* data, size_t len){
+    size_t used = Ring_Used(R);
+    if(len > used){
+        len = used;
+    }
+    size_t index = R->tail & (R->size - 1);
+    size_t first = R->size - index;
+    if(first > len){
+        first = len;
+    }
+    memcpy(data, &R->buffer[index], first);
+    memcpy(&data[first], R->buffer, len - first);
+    Ring_Consume(R, len);
+    return len;
+}
+
+/**
+  * @brief  Gets the largest contiguous block of data at the read index.
+  * @param  R    Pointer to the ring buffer structure
+  * @param  data Set to the start of the block
+  * @retval Length of the block, 0 if the ring buffer is empty
+  *
+  * @note   Used to hand the data to a DMA without copying, call Ring_Consume with
+  *         the same length once the transfer is done.
+  */
+size_t Ring_PeekContiguous(const RingBuffer_t* R, uint8_t** data){
+    size_t used = Ring_Used(R);
+    size_t index = R->tail & (R->size - 1);
+    size_t first = R->size - index;
+    *data = &R->buffer[index];
+    return (used < first) ? used : first;
+}
+
+/**
+  * @brief  Releases len bytes at the read index (consumer side).
+  */
+void Ring_Consume(RingBuffer_t* R, size_t len){
+    __DMB(); // Finish reading the data before the producer may overwrite it
+    R->tail += len;
+    return;
+}
+
+/*================================== COBS implementation ===============================*/
+/**
+  * @brief  Encodes a buffer with Consistent Overhead Byte Stuffing.
+  * @param  in  Pointer to the data
+  * @param  len Number of bytes
+  * @param  out Destination, at least COBS_MAX_ENCODED_SIZE(len) bytes, must not overlap in
+  * @retval Number of encoded bytes (the COBS_DELIMITER is not added)
+  *
+  * @note   The output never contains 0x00, so the delimiter always marks a frame end and
+  *         the receiver resynchronises on the next frame after a lost byte.
+  */
+size_t Cobs_Encode(const uint8_t* in, size_t len, uint8_t* out){
+    size_t codeIndex = 0;
+    size_t outIndex = 1;
+    uint8_t code = 1;
+
+    for(size_t i = 0; i < len; i++){
+        if(in[i] != 0){
+            out[outIndex++] = in[i];
+            code++;
+        }
+        if(in[i] == 0 || code == 0xFF){
+            out[codeIndex] = code;
+            code = 1;
+            codeIndex = outIndex++;
+        }
+    }
+    out[codeIndex] = code;
+    return outIndex;
+}
+
+/**
+  * @brief  Decodes a COBS encoded frame (without the delimiter).
+  * @param  in  Pointer to the encoded frame
+  * @param  len Number of encoded bytes
+  * @param  out Destination, at least len bytes, may be the same buffer as in
+  * @retval Number of decoded bytes, 0 if the frame is malformed
+  */
+size_t Cobs_Decode(const uint8_t* in, size_t len, uint8_t* out){
+    size_t inIndex = 0;
+    size_t outIndex = 0;
+
+    while(inIndex < len){
+        uint8_t code = in[inIndex++];
+        if(code == 0 || inIndex + code - 1 > len){
+            return 0;
+        }
+        for(uint8_t i = 1; i < code; i++){
+            out[outIndex++] = in[inIndex++];
+        }
+        if(code != 0xFF && inIndex < len){
+            out[outIndex++] = 0;
+        }
+    }
+    return outIndex;
+}
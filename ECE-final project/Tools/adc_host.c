@@ -0,0 +1,145 @@
+/*
+ * Host reference test and benchmark of the ADC averaging kernels (STM32_Platform/Inc/adc_kernels.h)
+ * against the modulo accumulation plt_AdcProcessData used before them.
+ *
+ *   gcc -O2 -I STM32_Platform/Inc Tools/adc_host.c -o adc_host
+ *   ./adc_host
+ *
+ * The SIMD kernel runs on a portable __UADD16, so the test checks its lane layout, the
+ * flush of the 16-bit lanes and the odd frame tail. Buffers: random 12-bit samples, all
+ * full scale (worst case for the lanes), all zero, and frame counts around the flush.
+ * The benchmark times the three kernels on the 3 x 50 sample block of adc.h. Host times
+ * only compare the kernels, the target cycle count of a block comes from building with
+ * ADC_BENCHMARK (ADC_LastProcessCycles, DWT).
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define ADC_SIMD 1
+
+/* Two 16-bit lane add, wraps per lane like the Cortex-M4 instruction */
+static inline uint32_t __UADD16(uint32_t a, uint32_t b)
+{
+    uint32_t lo = (a + b) & 0xFFFFU;
+    uint32_t hi = ((a >> 16) + (b >> 16)) & 0xFFFFU;
+    return (hi << 16) | lo;
+}
+
+#include "adc_kernels.h"
+
+#define NUM_SENSORS   3
+#define MAX_FRAMES    200
+#define BLOCK_FRAMES  50        // ADCx_SAMPLES_PER_SENSOR
+#define BENCH_BLOCKS  200000
+
+static uint16_t Buffer[NUM_SENSORS * MAX_FRAMES] __attribute__((aligned(4)));
+static uint32_t Seed = 1;
+
+/* The accumulation of plt_AdcProcessData before the kernels */
+static void ModuloAverage(const uint16_t* buf, uint16_t size, uint16_t numSensors, uint16_t samples, uint16_t* avg)
+{
+    uint32_t sums[numSensors];
+
+    memset(sums, 0, sizeof(sums));
+    for (uint16_t i = 0; i < size; ++i)
+    {
+        sums[i % numSensors] += buf[i];
+    }
+    for (uint16_t i = 0; i < numSensors; ++i)
+    {
+        avg[i] = (uint16_t)(sums[i] / samples);
+    }
+}
+
+static uint16_t Random12(void)
+{
+    Seed = Seed * 1103515245u + 12345u;
+    return (uint16_t)((Seed >> 16) & 0x0FFF);
+}
+
+static void Fill(uint16_t frames, int kind)
+{
+    for (uint16_t i = 0; i < frames * NUM_SENSORS; i++)
+    {
+        Buffer[i] = (kind == 0) ? Random12() : (kind == 1) ? 4095 : 0;
+    }
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(void)
+{
+    const char* kinds[] = {"random", "full scale", "zero"};
+    const uint16_t frames[] = {1, 2, 3, 31, 32, 33, 34, 49, BLOCK_FRAMES, 65, 127, MAX_FRAMES};
+    int failures = 0, cases = 0;
+
+    for (int kind = 0; kind < 3; kind++)
+    {
+        for (unsigned f = 0; f < sizeof(frames) / sizeof(frames[0]); f++)
+        {
+            for (int rep = 0; rep < ((kind == 0) ? 50 : 1); rep++)
+            {
+                uint16_t ref[NUM_SENSORS], stride[NUM_SENSORS], simd[NUM_SENSORS];
+
+                Fill(frames[f], kind);
+                ModuloAverage(Buffer, frames[f] * NUM_SENSORS, NUM_SENSORS, frames[f], ref);
+                adc_AverageStride(Buffer, frames[f], NUM_SENSORS, stride);
+                adc_Average3(Buffer, frames[f], simd);
+                cases++;
+                if (memcmp(ref, stride, sizeof(ref)) != 0 || memcmp(ref, simd, sizeof(ref)) != 0)
+                {
+                    failures++;
+                    printf("FAIL %s, %u frames: ref %u %u %u stride %u %u %u simd %u %u %u\n", kinds[kind],
+                           frames[f], ref[0], ref[1], ref[2], stride[0], stride[1], stride[2],
+                           simd[0], simd[1], simd[2]);
+                }
+            }
+        }
+    }
+    printf("reference test: %d cases, %d failures\n", cases, failures);
+
+    /* Benchmark on the adc.h block */
+    volatile uint16_t sink = 0;
+    uint16_t avg[NUM_SENSORS];
+    double t0, tModulo, tStride, tSimd;
+
+    Fill(BLOCK_FRAMES, 0);
+    t0 = Now();
+    for (int i = 0; i < BENCH_BLOCKS; i++)
+    {
+        Buffer[0] = (uint16_t)(i & 0x0FFF);
+        ModuloAverage(Buffer, BLOCK_FRAMES * NUM_SENSORS, NUM_SENSORS, BLOCK_FRAMES, avg);
+        sink += avg[0];
+    }
+    tModulo = Now() - t0;
+    t0 = Now();
+    for (int i = 0; i < BENCH_BLOCKS; i++)
+    {
+        Buffer[0] = (uint16_t)(i & 0x0FFF);
+        adc_AverageStride(Buffer, BLOCK_FRAMES, NUM_SENSORS, avg);
+        sink += avg[0];
+    }
+    tStride = Now() - t0;
+    t0 = Now();
+    for (int i = 0; i < BENCH_BLOCKS; i++)
+    {
+        Buffer[0] = (uint16_t)(i & 0x0FFF);
+        adc_Average3(Buffer, BLOCK_FRAMES, avg);
+        sink += avg[0];
+    }
+    tSimd = Now() - t0;
+    (void)sink;
+
+    printf("\nbenchmark: %d blocks of %d x %d samples\n", BENCH_BLOCKS, NUM_SENSORS, BLOCK_FRAMES);
+    printf("%-10s %14s %10s\n", "kernel", "ns per block", "speedup");
+    printf("%-10s %14.1f %10.2f\n", "modulo", tModulo / BENCH_BLOCKS * 1e9, 1.0);
+    printf("%-10s %14.1f %10.2f\n", "stride", tStride / BENCH_BLOCKS * 1e9, tModulo / tStride);
+    printf("%-10s %14.1f %10.2f\n", "simd", tSimd / BENCH_BLOCKS * 1e9, tModulo / tSimd);
+    return failures ? 1 : 0;
+}
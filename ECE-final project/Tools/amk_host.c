@@ -0,0 +1,150 @@
+/*
+ * Host test of the AMK startup sequencer (Core/Src/amk.c) against a scripted inverter:
+ *
+ *   gcc -O2 -I Core/Inc Tools/amk_host.c Core/Src/amk.c -o amk_host
+ *   ./amk_host
+ *
+ * One amk_Step per safety tick. Cases: the nominal handshake and its control words, the
+ * wait for the DC bus (no timeout), a missing QuitDcOn and a missing QuitInverterOn (a
+ * retry each, AMK_ST_FAULT after AMK_MAX_RETRIES), an error that clears on ErrorReset,
+ * one that does not, amk_Reset out of AMK_ST_FAULT, the switch off with request 0 and
+ * the fall back out of AMK_ST_READY when an acknowledgement is lost.
+ */
+#include "amk.h"
+#include <stdio.h>
+
+#define CW_ON (bDcOn | bEnable | bInverterOn)
+
+static int Failures = 0;
+
+static void Check(int ok, const char* what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) Failures++;
+}
+
+/* A well behaved inverter: acknowledges the control word of the last tick */
+static void Answer(amk_input_t* in, uint16_t controlWord, uint8_t hv)
+{
+    in->systemReady = 1;
+    in->dcOn = hv;
+    in->quitDcOn = hv && (controlWord & bDcOn);
+    in->inverterOn = (controlWord & bInverterOn) ? 1 : 0;
+    in->quitInverterOn = in->quitDcOn && (controlWord & bEnable) && (controlWord & bInverterOn);
+}
+
+/* Step with a fixed input n times, returns the last control word */
+static uint16_t Hold(amk_t* amk, const amk_input_t* in, int n)
+{
+    uint16_t cw = 0;
+    for (int i = 0; i < n; i++) cw = amk_Step(amk, in, 1);
+    return cw;
+}
+
+/* Run against the well behaved inverter until READY, returns the ticks, -1 if never */
+static int RunToReady(amk_t* amk, int maxTicks)
+{
+    amk_input_t in = {0};
+    uint16_t cw = amk->controlWord;
+
+    for (int t = 1; t <= maxTicks; t++)
+    {
+        Answer(&in, cw, 1);
+        cw = amk_Step(amk, &in, 1);
+        if (amk_IsReady(amk)) return t;
+    }
+    return -1;
+}
+
+int main(void)
+{
+    amk_t amk;
+    amk_input_t in = {0};
+    uint16_t cw;
+    int ticks;
+
+    /* Nominal handshake */
+    amk_Init(&amk);
+    Check(amk_Step(&amk, &in, 1) == 0 && amk.state == AMK_ST_OFF, "no SystemReady: off, control word 0");
+    in.systemReady = 1;
+    cw = amk_Step(&amk, &in, 1);
+    Check(amk.state == AMK_ST_DC_ON && cw == bDcOn, "SystemReady: DcOn requested");
+    in.dcOn = 1;
+    in.quitDcOn = 1;
+    cw = amk_Step(&amk, &in, 1);
+    Check(amk.state == AMK_ST_ENABLE && cw == CW_ON, "QuitDcOn: Enable and InverterOn requested");
+    in.inverterOn = 1;
+    in.quitInverterOn = 1;
+    cw = amk_Step(&amk, &in, 1);
+    Check(amk_IsReady(&amk) && cw == CW_ON && amk.retries == 0, "QuitInverterOn: ready");
+    Check(Hold(&amk, &in, 1000) == CW_ON && amk_IsReady(&amk), "ready: stays on");
+
+    /* DC bus wait, the driver switches the tractive system on */
+    amk_Init(&amk);
+    in = (amk_input_t){1, 0, 0, 0, 0, 0};
+    Hold(&amk, &in, 10 * AMK_QUIT_DC_TIMEOUT);
+    Check(amk.state == AMK_ST_DC_ON && amk.retries == 0, "no DC bus: waits without timeout");
+    in.dcOn = 1;
+    in.quitDcOn = 1;
+    amk_Step(&amk, &in, 1);
+    Check(amk.state == AMK_ST_ENABLE, "DC bus on: goes on");
+
+    /* Missing QuitDcOn */
+    amk_Init(&amk);
+    in = (amk_input_t){1, 0, 1, 0, 0, 0};
+    Hold(&amk, &in, 1 + AMK_QUIT_DC_TIMEOUT);
+    Check(amk.state == AMK_ST_OFF && amk.retries == 1, "no QuitDcOn: retry from off");
+    Hold(&amk, &in, 3 * (1 + AMK_QUIT_DC_TIMEOUT));
+    Check(amk.state == AMK_ST_FAULT && amk.controlWord == 0, "no QuitDcOn: fault after the retries");
+    Check(Hold(&amk, &in, 1000) == 0 && amk.state == AMK_ST_FAULT, "fault: stays off");
+
+    /* Missing QuitInverterOn, then an inverter that answers */
+    amk_Init(&amk);
+    in = (amk_input_t){1, 0, 1, 1, 0, 0};
+    Hold(&amk, &in, 1 + 1 + AMK_ON_TIMEOUT);
+    Check(amk.state == AMK_ST_OFF && amk.retries == 1, "no QuitInverterOn: retry from off");
+    ticks = RunToReady(&amk, 100);
+    Check(ticks > 0 && amk.retries == 0, "retry: ready, retries cleared");
+
+    /* Error that clears on ErrorReset */
+    in.error = 1;
+    cw = amk_Step(&amk, &in, 1);
+    Check(amk.state == AMK_ST_ERROR_RESET && cw == (bDcOn | bErrorReset), "error: enable taken away, ErrorReset");
+    in.error = 0;
+    amk_Step(&amk, &in, 1);
+    Check(amk.state == AMK_ST_OFF && amk.retries == 1, "error cleared: restart from off");
+    Check(RunToReady(&amk, 100) > 0, "error cleared: ready again");
+
+    /* Error that does not clear */
+    amk_Init(&amk);
+    in = (amk_input_t){1, 1, 0, 0, 0, 0};
+    Hold(&amk, &in, 1 + AMK_RESET_TIMEOUT);
+    Check(amk.state == AMK_ST_OFF && amk.controlWord == 0, "reset timeout: ErrorReset dropped");
+    Hold(&amk, &in, 3 * (1 + AMK_RESET_TIMEOUT));
+    Check(amk.state == AMK_ST_FAULT, "error stays: fault after the retries");
+
+    /* amk_Reset leaves the fault */
+    in.error = 0;
+    amk_Reset(&amk);
+    Check(amk.state == AMK_ST_OFF && amk.retries == 0, "amk_Reset: off with new retries");
+    Check(RunToReady(&amk, 100) > 0, "amk_Reset: ready again");
+    amk_Reset(&amk);
+    Check(amk_IsReady(&amk), "amk_Reset: a running inverter keeps its state");
+
+    /* Switch off */
+    in = (amk_input_t){1, 0, 1, 1, 1, 1};
+    Check(amk_Step(&amk, &in, 0) == 0 && amk.state == AMK_ST_OFF, "request 0: off, control word 0");
+
+    /* Lost acknowledgements in READY */
+    Check(RunToReady(&amk, 100) > 0, "lost ack: ready");
+    in = (amk_input_t){1, 0, 1, 1, 1, 0};
+    amk_Step(&amk, &in, 1);
+    Check(amk.state == AMK_ST_ENABLE && amk.controlWord == CW_ON, "QuitInverterOn lost: back to enable");
+    Check(RunToReady(&amk, 100) > 0, "QuitInverterOn lost: ready again");
+    in = (amk_input_t){1, 0, 0, 0, 1, 1};
+    amk_Step(&amk, &in, 1);
+    Check(amk.state == AMK_ST_DC_ON && amk.controlWord == bDcOn, "DC bus lost: back to DcOn");
+
+    printf("%d failures\n", Failures);
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Extract the black box log (STM32_Platform/Inc/norlog.h, blackbox.h) from a flash image.
+
+The image is a raw dump of the external SPI NOR flash (or the output of
+Tools/norlog_host.c). Segments are read in sequence order, every record is CRC
+checked and written as one row of a CSV file per record type:
+
+    snapshot.csv   time_ms, stage, r2d, system_error, gas, brake, steering, biops,
+                   speed1..4, torque1..4, dc_bus_voltage
+    can.csv        time_ms, id, d0..d7
+
+The columns are plain integers so the files load directly with pandas/polars;
+--parquet also writes .parquet files when pandas and pyarrow are installed.
+
+Usage:
+    bbx_extract.py bbx.img out/ [--sector 4096] [--parquet]
+"""
+import argparse
+import csv
+import os
+import struct
+import sys
+
+NLOG_MAGIC = 0x31584242
+NLOG_VERSION = 1
+NLOG_TYPE_ERASED = 0xFF
+SEGMENT = struct.Struct("<IIHHHH")   # magic, sequence, version, page size, reserved, crc
+RECORD = struct.Struct("<BBHI")      # type, len, crc, timestamp
+
+# Record type: (file name, payload layout, columns after time_ms)
+RECORD_TYPES = {
+    1: ("snapshot", struct.Struct("<BBHHHhH4h4hh"),
+        ["stage", "r2d", "system_error", "gas", "brake", "steering", "biops",
+         "speed1", "speed2", "speed3", "speed4",
+         "torque1", "torque2", "torque3", "torque4", "dc_bus_voltage"]),
+    2: ("can", struct.Struct("<I8B"),
+        ["id", "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7"]),
+}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, same as Crc16_Calc (crc.c)."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def read_segments(image, sector):
+    """Return (sequence, offset, page size) of the valid segments, oldest first."""
+    count = len(image) // sector
+    segments = []
+    for index in range(count):
+        offset = index * sector
+        magic, seq, version, page, _, crc = SEGMENT.unpack_from(image, offset)
+        if magic != NLOG_MAGIC or version != NLOG_VERSION or seq % count != index:
+            continue
+        if crc != crc16(image[offset:offset + SEGMENT.size - 2]):
+            continue
+        segments.append((seq, offset, page))
+    return sorted(segments)
+
+
+def read_records(image, sector, stats):
+    """Yield (type, timestamp, payload) of every valid record in log order."""
+    for _, offset, page in read_segments(image, sector):
+        stats["segments"] += 1
+        for page_start in range(offset, offset + sector, page):
+            pos = page_start + (SEGMENT.size if page_start == offset else 0)
+            end = page_start + page
+            while pos + RECORD.size <= end and image[pos] != NLOG_TYPE_ERASED:
+                rtype, length, crc, timestamp = RECORD.unpack_from(image, pos)
+                payload = image[pos + RECORD.size:pos + RECORD.size + length]
+                check = crc16(payload, crc16(image[pos + 4:pos + 8], crc16(image[pos:pos + 2])))
+                if pos + RECORD.size + length > end or check != crc:
+                    stats["corrupt"] += 1
+                    break  # The length cannot be trusted, skip the rest of the page
+                yield rtype, timestamp, payload
+                pos += RECORD.size + length
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", help="raw flash image")
+    parser.add_argument("outdir", help="output directory")
+    parser.add_argument("--sector", type=int, default=4096, help="erase sector size (BBX_SECTOR_SIZE)")
+    parser.add_argument("--parquet", action="store_true", help="also write .parquet files")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    os.makedirs(args.outdir, exist_ok=True)
+
+    stats = {"segments": 0, "corrupt": 0, "unknown": 0}
+    files = {}
+    writers = {}
+    rows = {rtype: 0 for rtype in RECORD_TYPES}
+    for rtype, (name, _, columns) in RECORD_TYPES.items():
+        files[rtype] = open(os.path.join(args.outdir, name + ".csv"), "w", newline="")
+        writers[rtype] = csv.writer(files[rtype])
+        writers[rtype].writerow(["time_ms"] + columns)
+
+    for rtype, timestamp, payload in read_records(image, args.sector, stats):
+        layout = RECORD_TYPES.get(rtype)
+        if layout is None or len(payload) != layout[1].size:
+            stats["unknown"] += 1
+            continue
+        writers[rtype].writerow([timestamp] + list(layout[1].unpack(payload)))
+        rows[rtype] += 1
+
+    for f in files.values():
+        f.close()
+
+    print("%d segments, %d corrupt pages, %d unknown records" %
+          (stats["segments"], stats["corrupt"], stats["unknown"]))
+    for rtype, (name, _, _) in RECORD_TYPES.items():
+        print("%s.csv: %d rows" % (name, rows[rtype]))
+
+    if args.parquet:
+        try:
+            import pandas
+        except ImportError:
+            sys.exit("--parquet needs pandas and pyarrow")
+        for name, _, _ in RECORD_TYPES.values():
+            path = os.path.join(args.outdir, name)
+            pandas.read_csv(path + ".csv").to_parquet(path + ".parquet", index=False)
+
+
+if __name__ == "__main__":
+    main()
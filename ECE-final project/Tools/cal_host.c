@@ -0,0 +1,149 @@
+/*
+ * Host test of the pedal calibration (STM32_Platform/Src/calibration.c) on a RAM flash
+ * region, the capture, the validation and the record log:
+ *
+ *   gcc -O2 -I STM32_Platform/Inc Tools/cal_host.c STM32_Platform/Src/calibration.c \
+ *       STM32_Platform/Src/crc.c -o cal_host
+ *   ./cal_host
+ *
+ * Programming only clears bits like the internal flash. Cases: empty sector, a good
+ * capture and its reload, a too small span, an abort, a failed flash write (the active
+ * calibration must stay as it was in all three), a torn last record, the wrap of a small
+ * sector and the boot load time on a full 128 KB sector.
+ */
+#include "calibration.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SECTOR_SIZE   (128 * 1024)
+#define SMALL_SIZE    (8 * sizeof(cal_record_t))
+#define BLOCK_MS      10      // ADC block period fed to the capture
+
+static uint8_t Flash[SECTOR_SIZE];
+static uint32_t FlashSize = SECTOR_SIZE;
+static uint8_t FailProgram = 0;
+static uint32_t Erases = 0;
+static uint32_t Now = 0;
+static int Failures = 0;
+
+static uint8_t RamErase(void)
+{
+    memset(Flash, 0xFF, FlashSize);
+    Erases++;
+    return 1;
+}
+
+static uint8_t RamProgram(uint32_t offset, const uint8_t* data, uint32_t len)
+{
+    if (FailProgram || offset + len > FlashSize) return 0;
+    for (uint32_t i = 0; i < len; i++) Flash[offset + i] &= data[i];
+    return 1;
+}
+
+static cal_flash_t RamFlash = {Flash, SECTOR_SIZE, RamErase, RamProgram};
+
+static void Check(int ok, const char* what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) Failures++;
+}
+
+/* Run a full capture: rest values, then a ramp to full and back. abortAt: step to abort, -1 never */
+static CalState_t Capture(const uint16_t rest[3], const uint16_t full[3], int abortAt)
+{
+    int step = 0;
+
+    cal_StartCapture(Now);
+    while (cal_GetState() == CAL_CAPTURE_REST || cal_GetState() == CAL_CAPTURE_FULL)
+    {
+        uint16_t raw[3];
+        for (int i = 0; i < 3; i++)
+        {
+            if (cal_GetState() == CAL_CAPTURE_REST)
+            {
+                raw[i] = (uint16_t)(rest[i] + (step % 5) - 2);   // Noise around the rest
+            }
+            else
+            {
+                int phase = step % 100;                            // Press and release, 1 s
+                int tri = (phase < 50) ? phase : 100 - phase;
+                raw[i] = (uint16_t)(rest[i] + ((int)full[i] - rest[i]) * tri / 50);
+            }
+        }
+        if (step == abortAt) cal_AbortCapture();
+        cal_CaptureStep(raw, Now);
+        Now += BLOCK_MS;
+        step++;
+    }
+    return cal_GetState();
+}
+
+int main(void)
+{
+    const uint16_t rest[3] = {500, 3600, 400};
+    const uint16_t full[3] = {3500, 600, 2400};
+    const uint16_t stuck[3] = {3500, 600, 450};
+    cal_record_t before;
+
+    cal_SetFlash(&RamFlash);
+    RamErase();
+    Check(cal_Init() == 0, "empty sector: no calibration");
+
+    Check(Capture(rest, full, -1) == CAL_DONE, "capture: done");
+    Check(cal_IsValid() && cal_GetRecord()->sequence == 1, "capture: active, sequence 1");
+    Check(cal_Apply(CAL_APPS1, rest[0]) == 0 && cal_Apply(CAL_APPS1, full[0]) == 100 &&
+          cal_Apply(CAL_APPS1, 2000) == 50, "apply: rising sensor 0 / 100 / 50 %");
+    Check(cal_Apply(CAL_APPS2, rest[1]) == 0 && cal_Apply(CAL_APPS2, full[1]) == 100 &&
+          cal_Apply(CAL_APPS2, 2100) == 50, "apply: falling sensor 0 / 100 / 50 %");
+    memcpy(&before, cal_GetRecord(), sizeof(before));
+    Check(cal_Init() == 1 && memcmp(&before, cal_GetRecord(), sizeof(before)) == 0, "reload: same record");
+
+    Check(Capture(rest, stuck, -1) == CAL_FAILED && cal_GetError() == CAL_ERR_SPAN, "small span: failed");
+    Check(cal_IsValid() && memcmp(&before, cal_GetRecord(), sizeof(before)) == 0, "small span: previous calibration kept");
+
+    Check(Capture(rest, full, 250) == CAL_FAILED && cal_GetError() == CAL_ERR_ABORTED, "abort: failed");
+    Check(cal_IsValid() && memcmp(&before, cal_GetRecord(), sizeof(before)) == 0, "abort: previous calibration kept");
+
+    FailProgram = 1;
+    Check(Capture(rest, full, -1) == CAL_FAILED && cal_GetError() == CAL_ERR_FLASH, "flash write error: failed");
+    Check(cal_IsValid() && memcmp(&before, cal_GetRecord(), sizeof(before)) == 0, "flash write error: previous calibration kept");
+    FailProgram = 0;
+    Check(cal_Init() == 1 && memcmp(&before, cal_GetRecord(), sizeof(before)) == 0, "flash write error: reload the previous");
+
+    /* Torn record: a new record whose last words were not programmed */
+    Check(Capture(rest, full, -1) == CAL_DONE && cal_GetRecord()->sequence == 2, "second capture: sequence 2");
+    memset(&Flash[2 * sizeof(cal_record_t)], 0xFF, sizeof(cal_record_t));
+    RamProgram(2 * sizeof(cal_record_t), (const uint8_t*)&before, 8);
+    Check(cal_Init() == 1 && cal_GetRecord()->sequence == 2, "torn last record: previous one loaded");
+    Check(Capture(rest, full, -1) == CAL_DONE && cal_Init() == 1 && cal_GetRecord()->sequence == 3,
+          "torn last record: next record after it");
+
+    /* Wrap of a small sector */
+    FlashSize = SMALL_SIZE;
+    RamFlash.size = SMALL_SIZE;
+    RamErase();
+    Erases = 0;
+    cal_Init();
+    for (int i = 0; i < 20; i++) Capture(rest, full, -1);
+    Check(cal_GetState() == CAL_DONE && Erases == 2, "small sector: 20 captures, 2 erases");
+    Check(cal_Init() == 1 && cal_GetRecord()->sequence == 20, "small sector: last record loaded");
+
+    /* Boot load on a full 128 KB sector */
+    FlashSize = SECTOR_SIZE;
+    RamFlash.size = SECTOR_SIZE;
+    RamErase();
+    cal_Init();
+    for (uint32_t i = 0; i < SECTOR_SIZE / sizeof(cal_record_t); i++) Capture(rest, full, -1);
+    struct timespec t0, t1;
+    int loads = 100000, ok = 1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < loads; i++) ok &= cal_Init();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    Check(ok && cal_GetRecord()->sequence == SECTOR_SIZE / sizeof(cal_record_t), "full sector: last record loaded");
+    printf("full sector boot load: %.0f ns on the host\n",
+           ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / loads);
+
+    printf("%d failures\n", Failures);
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""Decode the binary log stream of the VCU (STM32_Platform/Inc/logger.h).
+
+The format strings are not sent by the target, they are read from the .logfmt
+section of the ELF that is running on the board. A record is:
+
+    sync (0xA5) | nargs (u8) | id (u16) | timestamp ms (u32) | nargs x u32
+
+all little endian. Bytes that do not start a valid record are printed as text,
+so plain printf output on the same UART stays readable.
+
+Usage:
+    log_decode.py build/VCU.elf /dev/ttyACM0 [--baud 115200]
+    log_decode.py build/VCU.elf capture.bin
+"""
+import argparse
+import re
+import struct
+import sys
+
+LOG_SYNC = 0xA5
+LOG_MAX_ARGS = 4
+HEADER = struct.Struct("<BBHI")
+
+# printf conversion: flags, width, precision, length modifier, type
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|t|j)?([diouxXc%])")
+
+
+def read_logfmt(elf_path):
+    """Return the raw content of the .logfmt section of a 32 bit little endian ELF."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit("%s: not a 32 bit little endian ELF" % elf_path)
+
+    e_shoff, = struct.unpack_from("<I", elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(i):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from("<IIIIII", elf, e_shoff + i * e_shentsize)
+
+    strtab = section(e_shstrndx)
+    for i in range(e_shnum):
+        name_off, _, _, _, offset, size = section(i)
+        start = strtab[4] + name_off
+        name = elf[start:elf.index(b"\0", start)].decode()
+        if name == ".logfmt":
+            return elf[offset:offset + size]
+    sys.exit("%s: no .logfmt section (is the logger linked in?)" % elf_path)
+
+
+def format_string(table, msg_id):
+    """Return the format string with the given id, None if the id is not a string start."""
+    if msg_id >= len(table) or (msg_id > 0 and table[msg_id - 1] != 0):
+        return None
+    end = table.find(b"\0", msg_id)
+    return table[msg_id:end].decode(errors="replace")
+
+
+def render(fmt, args):
+    """Apply a C format string to the raw 32 bit arguments."""
+    args = list(args)
+
+    def convert(m):
+        flags, width, precision, _, kind = m.groups()
+        if kind == "%":
+            return "%"
+        value = args.pop(0) if args else 0
+        if kind in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            kind = "d"
+        elif kind == "u":
+            kind = "d"
+        spec = "%" + flags + width + ("." + precision if precision else "") + kind
+        return spec % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(table, stream, out):
+    """Decode records from a byte iterator, text bytes are passed through."""
+    buf = bytearray()
+    text = bytearray()
+    for chunk in stream:
+        buf += chunk
+        while buf:
+            if buf[0] != LOG_SYNC:
+                text.append(buf.pop(0))
+                continue
+            if len(buf) < HEADER.size:
+                break
+            _, nargs, msg_id, timestamp = HEADER.unpack_from(buf)
+            fmt = format_string(table, msg_id) if nargs <= LOG_MAX_ARGS else None
+            if fmt is None:
+                text.append(buf.pop(0))  # not a record, resync on the next byte
+                continue
+            size = HEADER.size + 4 * nargs
+            if len(buf) < size:
+                break
+            args = struct.unpack_from("<%dI" % nargs, buf, HEADER.size)
+            del buf[:size]
+            if text:
+                out.write(text.decode(errors="replace"))
+                text.clear()
+            out.write("[%10.3f] %s\n" % (timestamp / 1000.0, render(fmt, args)))
+        if text:
+            out.write(text.decode(errors="replace"))
+            text.clear()
+        out.flush()
+
+
+def open_stream(source, baud):
+    """Yield byte chunks from a file or a serial port."""
+    if source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial  # pyserial, only needed for a live port
+        port = serial.Serial(source, baud, timeout=0.1)
+        while True:
+            data = port.read(256)
+            if data:
+                yield data
+    else:
+        with open(source, "rb") as f:
+            while True:
+                data = f.read(4096)
+                if not data:
+                    return
+                yield data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="ELF file running on the target")
+    parser.add_argument("source", help="serial port or binary capture file")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    table = read_logfmt(args.elf)
+    try:
+        decode(table, open_stream(args.source, args.baud), sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,170 @@
+/*
+ * Host run of the black box log store (STM32_Platform/Src/norlog.c) on the RAM flash
+ * simulator. Writes synthetic snapshot and CAN records, remounts the log several times
+ * like power cycles do and dumps the flash image for Tools/bbx_extract.py:
+ *
+ *   gcc -I STM32_Platform/Inc Tools/norlog_host.c STM32_Platform/Src/norlog.c \
+ *       STM32_Platform/Src/crc.c -o norlog_host
+ *   ./norlog_host bbx.img && python3 Tools/bbx_extract.py bbx.img out/
+ *
+ * The flash is kept small (16 sectors) so the run wraps around the ring. The record
+ * structs mirror bbx_snapshot_t and bbx_can_t (blackbox.h), which pull the HAL.
+ *
+ * A second part runs the log at the target record rate on a flash with the program and
+ * erase times of the W25Q128JV (typical and maximum from the datasheet), nlog_Process
+ * called every main loop pass. It prints the dropped records and the most page buffers
+ * waiting at once, NLOG_PAGE_BUFFERS is sized from it (build with -DNLOG_PAGE_BUFFERS=n
+ * to try other sizes).
+ */
+#include "norlog.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FLASH_SIZE   (16 * 4096)
+#define SECTOR_SIZE  4096
+#define PAGE_SIZE    256
+#define RUNS         3
+#define TICKS        2000   // Control ticks per run
+
+#define SNAPSHOT_MS       10     // bbx_LogSnapshot, FSM_SAFETY_PERIOD_MS
+#define CAN_FRAMES_PER_MS 2      // bbx_LogCan, received frames (inverter actual values and nodes)
+#define MAIN_LOOP_US      100    // nlog_Process period (main loop pass)
+#define RATE_SECONDS      20     // Simulated time per timing profile
+
+typedef struct __attribute__((packed)){
+    uint8_t  stage;
+    uint8_t  r2d;
+    uint16_t system_error;
+    uint16_t gas;
+    uint16_t brake;
+    int16_t  steering;
+    uint16_t biops;
+    int16_t  speed[4];
+    int16_t  torque[4];
+    int16_t  dc_bus_voltage;
+}host_snapshot_t;
+
+typedef struct __attribute__((packed)){
+    uint32_t id;
+    uint8_t  data[8];
+}host_can_t;
+
+typedef struct{
+    const char* name;
+    uint32_t programUs;
+    uint32_t eraseUs;
+}host_timing_t;
+
+static const host_timing_t Timings[] = {
+    {"typical", 700, 45000},     // W25Q128JV tPP / tSE typical
+    {"maximum", 3000, 400000},   // W25Q128JV tPP / tSE maximum
+};
+
+static uint8_t Flash[FLASH_SIZE];
+static uint32_t SimUs = 0;
+
+static uint32_t SimNowUs(void)
+{
+    return SimUs;
+}
+
+/**
+ * @brief Write at the target record rate for RATE_SECONDS with the flash timing applied
+ */
+static void RateRun(nlog_ops_t* ops, const host_timing_t* timing)
+{
+    nlog_stats_t stats;
+    uint32_t ms = 0;
+    host_snapshot_t snap = {.stage = 3, .r2d = 1, .dc_bus_voltage = 560};
+    host_can_t can = {.id = 0x283};
+
+    memset(Flash, 0xFF, sizeof(Flash));
+    SimUs = 0;
+    nlog_RamSetTiming(SimNowUs, timing->programUs, timing->eraseUs);
+    nlog_Mount(ops);
+
+    for (; SimUs < RATE_SECONDS * 1000000U; SimUs += MAIN_LOOP_US)
+    {
+        if (SimUs / 1000U != ms)
+        {
+            ms = SimUs / 1000U;
+            if (ms % SNAPSHOT_MS == 0) nlog_Write(1, ms, &snap, sizeof(snap));
+            for (int i = 0; i < CAN_FRAMES_PER_MS; i++) nlog_Write(2, ms, &can, sizeof(can));
+        }
+        nlog_Process();
+    }
+
+    nlog_GetStats(&stats);
+    printf("%-8s tPP %4u us tSE %6u us: %u records, %u dropped (%.1f %%), %u of %d page buffers used\n",
+           timing->name, (unsigned)timing->programUs, (unsigned)timing->eraseUs, (unsigned)stats.records,
+           (unsigned)stats.dropped, 100.0 * stats.dropped / (stats.records + stats.dropped),
+           (unsigned)stats.maxReady, NLOG_PAGE_BUFFERS);
+    nlog_RamSetTiming(NULL, 0, 0);
+}
+
+int main(int argc, char** argv)
+{
+    nlog_ops_t ops;
+    nlog_stats_t stats;
+    uint32_t time = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <image>\n", argv[0]);
+        return 1;
+    }
+
+    memset(Flash, 0xA5, sizeof(Flash));  // Not erased, like a new flash with old contents
+    nlog_RamInit(&ops, Flash, FLASH_SIZE, SECTOR_SIZE, PAGE_SIZE);
+
+    for (int run = 0; run < RUNS; run++)
+    {
+        if (!nlog_Mount(&ops))
+        {
+            fprintf(stderr, "mount failed\n");
+            return 1;
+        }
+        nlog_GetStats(&stats);
+        printf("run %d: mounted at sequence %u\n", run, (unsigned)stats.sequence);
+
+        for (uint32_t tick = 0; tick < TICKS; tick++, time++)
+        {
+            host_snapshot_t snap = {
+                .stage = 3, .r2d = 1, .gas = (uint16_t)(tick % 1000), .brake = 0,
+                .steering = (int16_t)(tick % 200) - 100, .biops = 50,
+                .speed = {(int16_t)tick, (int16_t)tick, (int16_t)tick, (int16_t)tick},
+                .dc_bus_voltage = 560,
+            };
+            host_can_t can = {.id = 0x283 + (tick % 4), .data = {(uint8_t)tick, (uint8_t)run}};
+
+            nlog_Write(1, time, &snap, sizeof(snap));
+            nlog_Write(2, time, &can, sizeof(can));
+            nlog_Process();
+            nlog_Process();
+        }
+        nlog_Flush();
+        for (int i = 0; i < NLOG_PAGE_BUFFERS + NLOG_ERASE_AHEAD + 1; i++) nlog_Process();
+
+        nlog_GetStats(&stats);
+        printf("run %d: %u records, %u dropped, %u pages, %u erases, %u errors\n", run,
+               (unsigned)stats.records, (unsigned)stats.dropped, (unsigned)stats.pages,
+               (unsigned)stats.erases, (unsigned)stats.errors);
+    }
+
+    FILE* f = fopen(argv[1], "wb");
+    if (f == NULL || fwrite(Flash, 1, sizeof(Flash), f) != sizeof(Flash))
+    {
+        fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    printf("\nrecord rate: %d snapshots/s, %d CAN frames/s, %u bytes/s\n", 1000 / SNAPSHOT_MS,
+           CAN_FRAMES_PER_MS * 1000, (unsigned)((1000 / SNAPSHOT_MS) * (sizeof(host_snapshot_t) + 8) +
+           CAN_FRAMES_PER_MS * 1000 * (sizeof(host_can_t) + 8)));
+    for (unsigned i = 0; i < sizeof(Timings) / sizeof(Timings[0]); i++)
+    {
+        RateRun(&ops, &Timings[i]);
+    }
+    return 0;
+}
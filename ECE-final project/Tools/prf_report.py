@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Pretty-print the profiler report of the VCU (STM32_Platform/Inc/profiler.h).
+
+The shell prof command prints the report as one line "PRF:<hex>". This tool
+reads such lines from a capture file, a serial port or stdin (e.g. the output of
+log_decode.py) and prints one table per report:
+
+    header  sync 0x5A | version | probes | core MHz | load 0.1 % (u16)
+            | tick count | tick min | tick max (u32, cycles)
+    probe   count | min | max | mean (u32, cycles)
+
+all little endian.
+
+Usage:
+    prf_report.py capture.txt
+    prf_report.py /dev/ttyACM0 [--baud 115200]
+    log_decode.py build/VCU.elf capture.bin | prf_report.py -
+"""
+import argparse
+import struct
+import sys
+
+PRF_REPORT_SYNC = 0x5A
+PRF_REPORT_VERSION = 1
+HEADER = struct.Struct("<BBBBHIII")
+PROBE = struct.Struct("<IIII")
+
+# Same order as PrfProbe_t
+PROBE_NAMES = [
+    "task_control",
+    "task_safety",
+    "task_fsm",
+    "task_hmi",
+    "can_process",
+    "can_rx_isr",
+    "torque_vectoring",
+    "traction_control",
+    "regen",
+    "power_limit",
+    "estimator",
+]
+
+
+def decode(hex_text):
+    """Return the printable table of one report, None if the report is invalid."""
+    try:
+        data = bytes.fromhex(hex_text)
+    except ValueError:
+        return None
+    if len(data) < HEADER.size:
+        return None
+    sync, version, probes, mhz, load, ticks, tick_min, tick_max = HEADER.unpack_from(data)
+    if sync != PRF_REPORT_SYNC or version != PRF_REPORT_VERSION or mhz == 0:
+        return None
+    if len(data) != HEADER.size + probes * PROBE.size:
+        return None
+
+    def us(cycles):
+        return "%10.2f" % (cycles / mhz)
+
+    lines = ["CPU load %.1f %%   core %d MHz" % (load / 10.0, mhz)]
+    if ticks > 0:
+        lines.append("tick period min %s us  max %s us  jitter %s us  (%d ticks)" %
+                     (us(tick_min).strip(), us(tick_max).strip(), us(tick_max - tick_min).strip(), ticks))
+    lines.append("%-16s %10s %10s %10s %10s" % ("probe [us]", "count", "min", "mean", "max"))
+    for i in range(probes):
+        count, cmin, cmax, cmean = PROBE.unpack_from(data, HEADER.size + i * PROBE.size)
+        name = PROBE_NAMES[i] if i < len(PROBE_NAMES) else "probe%d" % i
+        if count == 0:
+            lines.append("%-16s %10d %10s %10s %10s" % (name, 0, "-", "-", "-"))
+        else:
+            lines.append("%-16s %10d %s %s %s" % (name, count, us(cmin), us(cmean), us(cmax)))
+    return "\n".join(lines)
+
+
+def lines_from(source, baud):
+    """Yield the text lines of a file, stdin or serial port."""
+    if source == "-":
+        yield from sys.stdin
+    elif source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial  # pyserial, only needed for live capture
+        with serial.Serial(source, baud) as port:
+            while True:
+                yield port.readline().decode(errors="replace")
+    else:
+        with open(source, errors="replace") as f:
+            yield from f
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="capture file, serial port or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    for line in lines_from(args.source, args.baud):
+        pos = line.find("PRF:")
+        if pos < 0:
+            continue
+        table = decode(line[pos + 4:].strip())
+        print(table if table is not None else "invalid report: " + line.strip())
+        print()
+
+
+if __name__ == "__main__":
+    main()
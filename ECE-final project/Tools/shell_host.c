@@ -0,0 +1,66 @@
+/*
+ * Host build of the debug shell (STM32_Platform/Src/shell.c) on stdin/stdout, to try
+ * commands and check the parser without a board:
+ *
+ *   gcc -I STM32_Platform/Inc Tools/shell_host.c STM32_Platform/Src/shell.c -o shell_host
+ *   printf 'dump\nset max_velocity 1500\nget max_velocity\n' | ./shell_host
+ *
+ * The parameter struct mirrors params_t (database.h), which cannot be included here
+ * because it pulls the HAL.
+ */
+#include "shell.h"
+#include <stdio.h>
+
+typedef struct{
+    uint16_t hb_gas_high;
+    uint16_t hb_gas_low;
+    uint16_t hb_brake_high;
+    uint16_t max_velocity;
+    uint8_t  r2d_timeout;
+    int16_t  pos_torque_limit;
+    int16_t  neg_torque_limit;
+}host_params_t;
+
+static host_params_t Params = {250, 50, 300, 1000, 10, 1000, -1000};
+static uint32_t Ticks = 0;
+
+static const shell_param_t ShellParams[] = {
+    {"hb_gas_high",      SH_U16, offsetof(host_params_t, hb_gas_high),      0,     1000},
+    {"hb_gas_low",       SH_U16, offsetof(host_params_t, hb_gas_low),       0,     1000},
+    {"hb_brake_high",    SH_U16, offsetof(host_params_t, hb_brake_high),    0,     1000},
+    {"max_velocity",     SH_U16, offsetof(host_params_t, max_velocity),     0,     20000},
+    {"r2d_timeout",      SH_U8,  offsetof(host_params_t, r2d_timeout),      1,     250},
+    {"pos_torque_limit", SH_I16, offsetof(host_params_t, pos_torque_limit), 0,     1000},
+    {"neg_torque_limit", SH_I16, offsetof(host_params_t, neg_torque_limit), -1000, 0},
+};
+
+static uint32_t StatTicks(void) { return Ticks; }
+
+static const shell_stat_t ShellStats[] = {
+    {"ticks", StatTicks},
+};
+
+static int HostRead(void)
+{
+    int c = getchar();
+    Ticks++;
+    return (c == EOF) ? -1 : c;
+}
+
+static void HostWrite(const char* data, size_t len)
+{
+    fwrite(data, 1, len, stdout);
+}
+
+static const shell_io_t HostIo = {
+    .read = HostRead,
+    .write = HostWrite
+};
+
+int main(void)
+{
+    sh_Init(&HostIo, ShellParams, sizeof(ShellParams) / sizeof(ShellParams[0]), &Params,
+            ShellStats, sizeof(ShellStats) / sizeof(ShellStats[0]));
+    sh_Process();  // Returns at the end of the input
+    return 0;
+}
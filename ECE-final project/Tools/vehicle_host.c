@@ -0,0 +1,811 @@
+/*
+ * Host vehicle model for the driving controllers (Core/Src/torque_vectoring.c,
+ * Core/Src/traction_control.c, Core/Src/launch_control.c, Core/Src/regen.c,
+ * Core/Src/power_limit.c, Core/Src/thermal.c, Core/Src/estimator.c).
+ * A planar two track model (longitudinal, lateral and yaw motion, four wheel spin
+ * dimensions, simplified Pacejka tyres on static loads, understeering) integrated at 10 kHz, the
+ * controllers run at the 1 kHz control rate on the simulated motor speeds like on the car.
+ *
+ *   gcc -O2 -I Core/Inc -I Drivers/CMSIS/DSP/Include -I Drivers/CMSIS/Include \
+ *       Tools/vehicle_host.c Core/Src/torque_vectoring.c Core/Src/traction_control.c \
+ *       Core/Src/launch_control.c Core/Src/regen.c Core/Src/power_limit.c Core/Src/thermal.c \
+ *       Core/Src/estimator.c \
+ *       Drivers/CMSIS/DSP/Source/MatrixFunctions/arm_mat_init_f32.c \
+ *       Drivers/CMSIS/DSP/Source/MatrixFunctions/arm_mat_mult_f32.c \
+ *       Drivers/CMSIS/DSP/Source/MatrixFunctions/arm_mat_add_f32.c \
+ *       Drivers/CMSIS/DSP/Source/MatrixFunctions/arm_mat_sub_f32.c \
+ *       Drivers/CMSIS/DSP/Source/MatrixFunctions/arm_mat_trans_f32.c \
+ *       Drivers/CMSIS/DSP/Source/MatrixFunctions/arm_mat_inverse_f32.c \
+ *       Drivers/CMSIS/DSP/Source/ControllerFunctions/arm_pid_init_f32.c \
+ *       Drivers/CMSIS/DSP/Source/ControllerFunctions/arm_pid_reset_f32.c \
+ *       Drivers/CMSIS/DSP/Source/InterpolationFunctions/arm_linear_interp_f32.c -lm -o vehicle_host
+ *   ./vehicle_host [trace.csv]
+ *
+ * The optional trace of the "tv" run must be a .csv path (git-ignored), any other argument
+ * is refused so a mistyped scenario name does not become a trace file.
+ *
+ * Scenario "tv": straight acceleration to 15 m/s, then a steering step held for 4 s,
+ * once without and once with the yaw moment. Reports the steady state yaw rate against
+ * the neutral steer reference and the allocation error (sum of the wheel torques against
+ * the driver request).
+ *
+ * Scenario "tc": full torque standing start for 3 s on a dry and a wet surface, once
+ * without and once with traction control (accelLimit set for the surface). Reports the
+ * speed reached, the peak slip and the mean slip of the driven wheels.
+ *
+ * Scenario "lc": full gas standing start on the dry surface up to the launch exit speed,
+ * with traction control only and with the launch control in front of it, as the control task
+ * runs them in FSM_ST_LC_LAUNCH. Reports the time to the exit speed and the peak slip.
+ *
+ * Scenario "rg": brake pedal step from 25 m/s held to RG_MIN_SPEED, hydraulic brake
+ * only, with regen, with regen on a full pack and with no pack voltage measured (no
+ * regen). Reports the stopping distance, the energy recovered and the largest change of
+ * the total braking torque between two control steps.
+ *
+ * Scenario "pl": full gas with traction control for 6 s, the model draws its power with a
+ * lower efficiency than the limiter assumes, the margin has to cover it. Without limit and
+ * with the feed-forward limiter. Reports the peak drawn power, the time above the limit
+ * and the mean drawn power while limiting.
+ *
+ * Scenario "th": the tv steering step with the front left motor derated to 30 %, the lost
+ * torque moves to the rear left motor. Then a motor heating at full torque with the winding
+ * sensor lagging the hot spot, with and without the temperature prediction of the thermal
+ * manager. Reports the peak winding temperature, the start of the derating and the factor.
+ * Last a power-up: zero temperatures until the first AV2 frame (30 degC), later a stale
+ * frame of zeros and a lost one. Reports the lowest factor and the warnings.
+ *
+ * Scenario "est": speed references against the model speed for a dry start with traction
+ * control, a wet start without it (all four wheels spin) and a brake from 25 m/s with the
+ * hydraulic brake and regen. Mean wheel speed, traction control reference and the state
+ * estimator without and with a noisy IMU. Then the wet tc start on the wheel reference and
+ * on the estimator speed.
+ */
+#include "torque_vectoring.h"
+#include "traction_control.h"
+#include "launch_control.h"
+#include "regen.h"
+#include "power_limit.h"
+#include "thermal.h"
+#include "estimator.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DT            1e-4f   // Model step [s]
+#define CTRL_DIV      10      // Model steps per control step (1 kHz)
+#define G             9.81f
+
+/* Vehicle (FS car with four hub motors) */
+#define MASS          280.0f  // [kg] with driver
+#define YAW_INERTIA   150.0f  // [kg m^2]
+#define CG_TO_FRONT   0.84f   // [m]
+#define WHEEL_INERTIA 0.35f   // Wheel plus reflected motor inertia [kg m^2]
+#define DRAG          0.8f    // 0.5 rho Cd A [kg/m]
+#define MU            1.5f
+#define MU_LOW        0.6f    // Wet surface for the traction control scenario
+#define B_LAT_FRONT   6.0f    // Softer front tyres: the car understeers without yaw moment
+#define B_LAT_REAR    8.0f
+
+#define HYD_TORQUE    1200.0f // Hydraulic brake torque of the four wheels at full pedal [Nm]
+#define HYD_FRONT     0.6f    // Hydraulic brake balance
+
+#define EFFICIENCY    0.88f   // Drivetrain efficiency of the model, the limiter assumes PL_EFFICIENCY
+
+#define TH_AMBIENT    40.0f   // Coolant [degC]
+#define TH_HEATING    3.0f    // Winding heating at full torque [degC/s]
+#define TH_COOLING    60.0f   // Winding to coolant time constant [s]
+#define TH_SENSOR_LAG 8.0f    // Winding sensor behind the hot spot [s]
+#define TH_FRAME      10      // Thermal steps per AV2 temperature update
+
+#define IMU_NOISE     0.3f    // Uniform IMU noise amplitude [m/s^2]
+#define EST_GAINS     {30.0f, 0.05f, 3.0f, 0.2f, 15.0f}  // params_t defaults (database.h)
+
+/* Scenario */
+#define TARGET_SPEED  15.0f   // [m/s]
+#define STEER_STEP    0.06f   // Steering input, ~4 m/s^2 lateral at the target speed
+
+typedef struct{
+    float vx, vy, r;            // Body velocities [m/s], yaw rate [rad/s]
+    float omega[4];             // Wheel speeds [rad/s]
+}model_t;
+
+static const float PosX[4] = {CG_TO_FRONT, CG_TO_FRONT, CG_TO_FRONT - TV_WHEELBASE, CG_TO_FRONT - TV_WHEELBASE};
+static const float PosY[4] = {TV_TRACK_WIDTH / 2, -TV_TRACK_WIDTH / 2, TV_TRACK_WIDTH / 2, -TV_TRACK_WIDTH / 2};
+static float Fz[4];
+static float Mu = MU;
+
+/* Simplified Pacejka, combined slip by the friction circle. bLat: lateral stiffness factor */
+static void Tyre(float fz, float slip, float alpha, float bLat, float* fx, float* fy)
+{
+    float x = Mu * fz * sinf(1.9f * atanf(10.0f * slip));
+    float y = -Mu * fz * sinf(1.3f * atanf(bLat * alpha));
+    float f = sqrtf(x * x + y * y);
+
+    if (f > Mu * fz)
+    {
+        x *= Mu * fz / f;
+        y *= Mu * fz / f;
+    }
+    *fx = x;
+    *fy = y;
+}
+
+/* One model step, torque: motor torques [Nm], delta: road wheel angle [rad] */
+static void Step(model_t* m, const float torque[4], float delta)
+{
+    float sumX = -DRAG * m->vx * fabsf(m->vx), sumY = 0, sumM = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        float d = (i < 2) ? delta : 0.0f;
+        float vxi = m->vx - m->r * PosY[i];
+        float vyi = m->vy + m->r * PosX[i];
+        float vxw = vxi * cosf(d) + vyi * sinf(d);
+        float vyw = -vxi * sinf(d) + vyi * cosf(d);
+        float slip = (m->omega[i] * TV_WHEEL_RADIUS - vxw) / fmaxf(fabsf(vxw), 0.5f);
+        float alpha = atan2f(vyw, fmaxf(fabsf(vxw), 0.5f));
+        float fxw, fyw;
+
+        Tyre(Fz[i], slip, alpha, (i < 2) ? B_LAT_FRONT : B_LAT_REAR, &fxw, &fyw);
+        float fx = fxw * cosf(d) - fyw * sinf(d);
+        float fy = fxw * sinf(d) + fyw * cosf(d);
+        sumX += fx;
+        sumY += fy;
+        sumM += PosX[i] * fy - PosY[i] * fx;
+        m->omega[i] += DT * (torque[i] * TV_GEAR_RATIO - fxw * TV_WHEEL_RADIUS) / WHEEL_INERTIA;
+    }
+    float dvx = sumX / MASS + m->vy * m->r;
+    float dvy = sumY / MASS - m->vx * m->r;
+    m->vx += DT * dvx;
+    m->vy += DT * dvy;
+    m->r += DT * sumM / YAW_INERTIA;
+}
+
+static float MotorRpm(const model_t* m, int i)
+{
+    return m->omega[i] * TV_GEAR_RATIO * 60.0f / (2.0f * (float)PI);
+}
+
+typedef struct{
+    float yawRate;          // Steady state yaw rate [rad/s]
+    float yawRateRef;       // Neutral steer reference at the steady state speed [rad/s]
+    float speed;
+    float allocError;       // Max |sum torque - driver torque| without clamping [Nm]
+}tv_result_t;
+
+/* Scenario tv: accelerate, then hold a steering step. limit: torque limit of each motor [Nm] */
+static tv_result_t RunTv(const tv_gains_t* gains, const float limit[4], FILE* trace)
+{
+    model_t m;
+    tv_input_t in = {0};
+    tv_output_t out;
+    tv_result_t res = {0};
+    float torque[4] = {0};
+    int steps = (int)(10.0f / DT);
+
+    memset(&m, 0, sizeof(m));
+    for (int k = 0; k < steps; k++)
+    {
+        float t = k * DT;
+        float steering = (t > 6.0f) ? STEER_STEP : 0.0f;
+
+        if (k % CTRL_DIV == 0)
+        {
+            /* Driver: full request up to the target speed, then a P speed hold */
+            in.driverTorque = 10.0f + 30.0f * (TARGET_SPEED - m.vx);
+            if (in.driverTorque > 40.0f) in.driverTorque = 40.0f;
+            if (in.driverTorque < 0.0f) in.driverTorque = 0.0f;
+            in.steering = steering;
+            for (int i = 0; i < 4; i++)
+            {
+                in.motorSpeed[i] = MotorRpm(&m, i);
+                in.torqueLimit[i] = limit[i];
+            }
+            tv_Process(&in, gains, &out);
+
+            float sum = out.torque[0] + out.torque[1] + out.torque[2] + out.torque[3];
+            int clamped = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                if (out.torque[i] <= 0.0f || out.torque[i] >= limit[i]) clamped = 1;
+            }
+            if (!clamped && fabsf(sum - in.driverTorque) > res.allocError)
+            {
+                res.allocError = fabsf(sum - in.driverTorque);
+            }
+            memcpy(torque, out.torque, sizeof(torque));
+            if (trace != NULL)
+            {
+                fprintf(trace, "%.3f,%.3f,%.4f,%.4f,%.4f,%.1f,%.2f,%.2f,%.2f,%.2f\n", t, m.vx, m.r,
+                        out.yawRateRef, out.yawRate, out.yawMoment,
+                        torque[0], torque[1], torque[2], torque[3]);
+            }
+        }
+        Step(&m, torque, steering * TV_MAX_STEER_ANGLE);
+
+        if (t > 9.0f) // Steady state, integral over the last second = average
+        {
+            res.yawRate += m.r * DT;
+            res.speed += m.vx * DT;
+        }
+    }
+    res.yawRateRef = res.speed * STEER_STEP * TV_MAX_STEER_ANGLE / TV_WHEELBASE;
+    return res;
+}
+
+typedef struct{
+    float speed;            // Speed after the run [m/s]
+    float peakSlip;         // After the first 0.2 s
+    float meanSlip;
+}tc_result_t;
+
+/* Scenario tc: full torque standing start on low grip. est: speed reference of the estimator */
+static tc_result_t RunTc(const tc_gains_t* gains, uint8_t enable, float mu, uint8_t est)
+{
+    const tv_gains_t straight = {0.5f, 0.0f, 0.0f};
+    model_t m;
+    tv_input_t tvIn = {0};
+    tv_output_t tvOut;
+    tc_input_t tcIn = {0};
+    tc_output_t tcOut;
+    tc_result_t res = {0};
+    float torque[4] = {0};
+    int steps = (int)(3.0f / DT);
+    int samples = 0;
+
+    memset(&m, 0, sizeof(m));
+    Mu = mu;
+    tc_Reset();
+    est_Init();
+    for (int k = 0; k < steps; k++)
+    {
+        if (k % CTRL_DIV == 0)
+        {
+            if (est)
+            {
+                est_input_t estIn = {0};
+                est_output_t estOut;
+                est_gains_t estGains = EST_GAINS;
+
+                estGains.maxAccel = gains->accelLimit;
+                for (int i = 0; i < 4; i++)
+                {
+                    estIn.motorSpeed[i] = MotorRpm(&m, i);
+                    estIn.torque[i] = torque[i];
+                }
+                est_Process(&estIn, &estGains, &estOut);
+                tcIn.speed = estOut.speed;
+                tcIn.speedValid = 1;
+            }
+            tvIn.driverTorque = 4.0f * TV_MAX_MOTOR_TORQUE;
+            for (int i = 0; i < 4; i++)
+            {
+                tvIn.motorSpeed[i] = MotorRpm(&m, i);
+                tvIn.torqueLimit[i] = TV_MAX_MOTOR_TORQUE;
+            }
+            tv_Process(&tvIn, &straight, &tvOut);
+            memcpy(tcIn.torque, tvOut.torque, sizeof(tcIn.torque));
+            memcpy(tcIn.motorSpeed, tvIn.motorSpeed, sizeof(tcIn.motorSpeed));
+            tc_Process(&tcIn, gains, &tcOut);
+            memcpy(torque, enable ? tcOut.torque : tvOut.torque, sizeof(torque));
+
+            if (k * DT > 0.2f)
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    float slip = (m.omega[i] * TV_WHEEL_RADIUS - m.vx) / fmaxf(m.vx, TC_MIN_SPEED);
+                    if (slip > res.peakSlip) res.peakSlip = slip;
+                    res.meanSlip += slip;
+                    samples++;
+                }
+            }
+        }
+        Step(&m, torque, 0.0f);
+    }
+    Mu = MU;
+    res.speed = m.vx;
+    res.meanSlip /= (float)samples;
+    return res;
+}
+
+typedef struct{
+    float time;             // To the exit speed [s]
+    float peakSlip;
+}lc_result_t;
+
+/* Scenario lc: standing start to the exit speed, the launch hands over when lc_IsDone */
+static lc_result_t RunLc(const tc_gains_t* tcGains, const lc_gains_t* lcGains, uint8_t launch)
+{
+    const tv_gains_t straight = {0.5f, 0.0f, 0.0f};
+    model_t m;
+    tv_input_t tvIn = {0};
+    tv_output_t tvOut;
+    tc_input_t tcIn = {0};
+    tc_output_t tcOut;
+    lc_input_t lcIn;
+    lc_output_t lcOut;
+    lc_result_t res = {0};
+    tc_gains_t gains;
+    float torque[4] = {0};
+    int steps = (int)(5.0f / DT);
+
+    memset(&m, 0, sizeof(m));
+    tc_Reset();
+    if (launch) lc_Start();
+    for (int k = 0; k < steps && m.vx < lcGains->exitSpeed; k++)
+    {
+        if (k % CTRL_DIV == 0)
+        {
+            gains = *tcGains;
+            tvIn.driverTorque = 4.0f * TV_MAX_MOTOR_TORQUE;
+            for (int i = 0; i < 4; i++)
+            {
+                tvIn.motorSpeed[i] = MotorRpm(&m, i);
+                tvIn.torqueLimit[i] = TV_MAX_MOTOR_TORQUE;
+            }
+            if (lc_IsActive())
+            {
+                memcpy(lcIn.motorSpeed, tvIn.motorSpeed, sizeof(lcIn.motorSpeed));
+                lc_Process(&lcIn, lcGains, &lcOut);
+                if (tvIn.driverTorque > lcOut.torqueScale * 4.0f * TV_MAX_MOTOR_TORQUE)
+                {
+                    tvIn.driverTorque = lcOut.torqueScale * 4.0f * TV_MAX_MOTOR_TORQUE;
+                }
+                gains.slipTarget = lcOut.slipTarget;
+                if (lc_IsDone()) lc_Stop();
+            }
+            tv_Process(&tvIn, &straight, &tvOut);
+            memcpy(tcIn.torque, tvOut.torque, sizeof(tcIn.torque));
+            memcpy(tcIn.motorSpeed, tvIn.motorSpeed, sizeof(tcIn.motorSpeed));
+            tc_Process(&tcIn, &gains, &tcOut);
+            memcpy(torque, tcOut.torque, sizeof(torque));
+
+            for (int i = 0; i < 4; i++)
+            {
+                float slip = (m.omega[i] * TV_WHEEL_RADIUS - m.vx) / fmaxf(m.vx, TC_MIN_SPEED);
+                if (slip > res.peakSlip) res.peakSlip = slip;
+            }
+        }
+        Step(&m, torque, 0.0f);
+        res.time += DT;
+    }
+    lc_Stop();
+    return res;
+}
+
+typedef struct{
+    float distance;         // To RG_MIN_SPEED [m]
+    float energy;           // Recovered at the motors [kJ]
+    float torqueStep;       // Max change of the total wheel torque per control step [Nm]
+}rg_result_t;
+
+/* Scenario rg: brake pedal step from speed, hydraulic brake in parallel with the regen */
+static rg_result_t RunRg(const rg_gains_t* gains, uint8_t enable, float packVoltage)
+{
+    const float pedal = 30.0f;
+    model_t m;
+    rg_input_t in = {0};
+    rg_output_t out;
+    rg_result_t res = {0};
+    float torque[4] = {0};
+    float regen[4] = {0};
+    float total = 0.0f;
+    int steps = (int)(10.0f / DT);
+
+    memset(&m, 0, sizeof(m));
+    m.vx = 25.0f;
+    for (int i = 0; i < 4; i++) m.omega[i] = m.vx / TV_WHEEL_RADIUS;
+    rg_Reset();
+    for (int k = 0; k < steps && m.vx > RG_MIN_SPEED; k++)
+    {
+        if (k % CTRL_DIV == 0)
+        {
+            float sum = 0.0f;
+
+            in.brake = pedal;
+            in.packVoltage = packVoltage;
+            for (int i = 0; i < 4; i++)
+            {
+                in.temperature[i] = 40.0f;
+                in.motorSpeed[i] = MotorRpm(&m, i);
+            }
+            rg_Process(&in, gains, &out);
+            for (int i = 0; i < 4; i++)
+            {
+                float share = (i < 2) ? HYD_FRONT : 1.0f - HYD_FRONT;
+                float hyd = 0.5f * share * HYD_TORQUE * pedal / 100.0f / TV_GEAR_RATIO;
+
+                regen[i] = enable ? out.torque[i] : 0.0f;
+                torque[i] = regen[i] - hyd;
+                sum += torque[i] * TV_GEAR_RATIO;
+            }
+            if (k > 0 && fabsf(sum - total) > res.torqueStep) res.torqueStep = fabsf(sum - total);
+            total = sum;
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            res.energy -= regen[i] * MotorRpm(&m, i) * 2.0f * (float)PI / 60.0f * DT / 1000.0f;
+        }
+        res.distance += m.vx * DT;
+        Step(&m, torque, 0.0f);
+    }
+    return res;
+}
+
+typedef struct{
+    float peak;             // Peak electrical power [W]
+    float over;             // Time above the limit [s]
+    float mean;             // Mean power while limiting, 3 s to the end [W]
+}pl_result_t;
+
+/* Scenario pl: full gas acceleration into the power limit */
+static pl_result_t RunPl(const tc_gains_t* tcGains, const pl_gains_t* gains, uint8_t enable)
+{
+    const tv_gains_t straight = {0.5f, 0.0f, 0.0f};
+    model_t m;
+    tv_input_t tvIn = {0};
+    tv_output_t tvOut;
+    tc_input_t tcIn = {0};
+    tc_output_t tcOut;
+    pl_input_t plIn;
+    pl_output_t plOut;
+    pl_result_t res = {0};
+    float torque[4] = {0};
+    int steps = (int)(6.0f / DT);
+    int samples = 0;
+
+    memset(&m, 0, sizeof(m));
+    tc_Reset();
+    for (int k = 0; k < steps; k++)
+    {
+        float power = 0.0f, shaft = 0.0f;
+
+        if (k % CTRL_DIV == 0)
+        {
+            tvIn.driverTorque = 4.0f * TV_MAX_MOTOR_TORQUE;
+            for (int i = 0; i < 4; i++)
+            {
+                tvIn.motorSpeed[i] = MotorRpm(&m, i);
+                tvIn.torqueLimit[i] = TV_MAX_MOTOR_TORQUE;
+            }
+            tv_Process(&tvIn, &straight, &tvOut);
+            memcpy(tcIn.torque, tvOut.torque, sizeof(tcIn.torque));
+            memcpy(tcIn.motorSpeed, tvIn.motorSpeed, sizeof(tcIn.motorSpeed));
+            tc_Process(&tcIn, tcGains, &tcOut);
+            memcpy(torque, tcOut.torque, sizeof(torque));
+            if (enable)
+            {
+                memcpy(plIn.torque, tcOut.torque, sizeof(plIn.torque));
+                memcpy(plIn.motorSpeed, tvIn.motorSpeed, sizeof(plIn.motorSpeed));
+                pl_Process(&plIn, gains, &plOut);
+                memcpy(torque, plOut.torque, sizeof(torque));
+            }
+        }
+        Step(&m, torque, 0.0f);
+
+        for (int i = 0; i < 4; i++) shaft += torque[i] * m.omega[i] * TV_GEAR_RATIO;
+        power = shaft / EFFICIENCY;
+        if (power > res.peak) res.peak = power;
+        if (power > gains->limit) res.over += DT;
+        if (k * DT >= 3.0f)
+        {
+            res.mean += power;
+            samples++;
+        }
+    }
+    res.mean /= (float)samples;
+    return res;
+}
+
+typedef struct{
+    float peakWinding;      // Peak winding temperature [degC]
+    float derateTime;       // First factor below 1 [s]
+    float factor;           // At the end of the run
+}th_result_t;
+
+typedef struct{
+    float minFactor;        // Lowest factor of all wheels
+    int warnings;           // Calls with the warning set
+}th_powerup_t;
+
+/* Scenario th power-up: no frame for 0.5 s, then 30 degC, a stale frame of zeros at 20 s and
+ * a frame with one source off by 60 degC at 40 s */
+static th_powerup_t RunThPowerUp(const th_gains_t* gains)
+{
+    th_input_t in;
+    th_output_t out;
+    th_powerup_t res = {1.0f, 0};
+    int steps = (int)(60.0f / TH_DT);
+
+    th_Init();
+    for (int k = 0; k < steps; k++)
+    {
+        for (int w = 0; w < 4; w++)
+        {
+            float t = (k < 50) ? 0.0f : 30.0f;
+            in.temperature[w][TH_MOTOR] = t;
+            in.temperature[w][TH_PLATE] = t;
+            in.temperature[w][TH_IGBT] = t;
+            in.valid[w] = (k >= 50) ? 1 : 0;
+            if (k >= 2000 && k < 2000 + TH_FRAME) memset(in.temperature[w], 0, sizeof(in.temperature[w]));
+            if (k >= 4000 && k < 4000 + TH_FRAME) in.temperature[w][TH_IGBT] = 90.0f;
+        }
+        th_Process(&in, gains, &out);
+        for (int w = 0; w < 4; w++)
+        {
+            if (out.factor[w] < res.minFactor) res.minFactor = out.factor[w];
+        }
+        res.warnings += out.warning;
+    }
+    return res;
+}
+
+/* Scenario th: motor heating at full torque, the sensor lags the winding */
+static th_result_t RunTh(const th_gains_t* gains)
+{
+    th_input_t in;
+    th_output_t out = {0};
+    th_result_t res = {0.0f, -1.0f, 1.0f};
+    float winding = TH_AMBIENT, sensor = TH_AMBIENT;
+    int steps = (int)(300.0f / TH_DT);
+
+    th_Init();
+    for (int k = 0; k < steps; k++)
+    {
+        float f = (k == 0) ? 1.0f : out.factor[0];
+
+        winding += TH_DT * (TH_HEATING * f * f - (winding - TH_AMBIENT) / TH_COOLING);
+        sensor += TH_DT / TH_SENSOR_LAG * (winding - sensor);
+        for (int w = 0; w < 4; w++)
+        {
+            in.temperature[w][TH_MOTOR] = ((k % TH_FRAME) == 0) ? sensor : in.temperature[w][TH_MOTOR];
+            in.temperature[w][TH_PLATE] = 40.0f;
+            in.temperature[w][TH_IGBT] = 60.0f;
+            in.valid[w] = 1;
+        }
+        th_Process(&in, gains, &out);
+
+        if (winding > res.peakWinding) res.peakWinding = winding;
+        if (res.derateTime < 0.0f && out.factor[0] < 1.0f) res.derateTime = k * TH_DT;
+    }
+    res.factor = out.factor[0];
+    return res;
+}
+
+typedef struct{
+    float rmsWheel;         // Mean wheel speed against the model speed [m/s]
+    float rmsTc;            // Traction control reference
+    float rmsEst;           // State estimator
+    float maxEst;
+}est_result_t;
+
+/* Scenario est: speed references against the model. kind 0: dry start with traction control,
+ * 1: wet start without (four spinning wheels), 2: hydraulic and regen braking from 25 m/s */
+static est_result_t RunEst(const tc_gains_t* tcGains, int kind, uint8_t imu)
+{
+    const tv_gains_t straight = {0.5f, 0.0f, 0.0f};
+    const rg_gains_t rgGains = {8.0f, 0.6f, 5.0f, 50.0f, 570.0f, 590.0f, 55.0f, 70.0f, 200.0f};
+    est_gains_t estGains = EST_GAINS;
+    model_t m;
+    tv_input_t tvIn = {0};
+    tv_output_t tvOut;
+    tc_input_t tcIn = {0};
+    tc_output_t tcOut;
+    rg_input_t rgIn = {0};
+    rg_output_t rgOut;
+    est_input_t estIn = {0};
+    est_output_t estOut;
+    est_result_t res = {0};
+    float torque[4] = {0};
+    float lastVx = 0.0f;
+    unsigned seed = 1;
+    int steps = (int)(3.0f / DT);
+    int samples = 0;
+
+    memset(&m, 0, sizeof(m));
+    Mu = (kind == 1) ? MU_LOW : MU;
+    if (kind == 2)
+    {
+        m.vx = 25.0f;
+        for (int i = 0; i < 4; i++) m.omega[i] = m.vx / TV_WHEEL_RADIUS;
+        steps = (int)(10.0f / DT);
+    }
+    estGains.maxAccel = tcGains->accelLimit;
+    lastVx = m.vx;
+    tc_Reset();
+    rg_Reset();
+    est_Init();
+    for (int k = 0; k < steps && (kind != 2 || m.vx > 2.0f); k++)
+    {
+        if (k % CTRL_DIV == 0)
+        {
+            float wheel = 0.0f;
+
+            for (int i = 0; i < 4; i++)
+            {
+                tvIn.motorSpeed[i] = MotorRpm(&m, i);
+                tvIn.torqueLimit[i] = TV_MAX_MOTOR_TORQUE;
+                wheel += 0.25f * m.omega[i] * TV_WHEEL_RADIUS;
+            }
+            memcpy(tcIn.motorSpeed, tvIn.motorSpeed, sizeof(tcIn.motorSpeed));
+
+            /* Estimator on the torques of the last step, like on the car */
+            memcpy(estIn.motorSpeed, tvIn.motorSpeed, sizeof(estIn.motorSpeed));
+            memcpy(estIn.torque, torque, sizeof(estIn.torque));
+            seed = seed * 1103515245u + 12345u;
+            estIn.accel = (m.vx - lastVx) / (CTRL_DIV * DT) + IMU_NOISE * (2.0f * (float)((seed >> 16) & 0x7FFF) / 32767.0f - 1.0f);
+            estIn.accelValid = imu;
+            estIn.braking = (kind == 2);
+            est_Process(&estIn, &estGains, &estOut);
+            lastVx = m.vx;
+
+            if (kind == 2)
+            {
+                rgIn.brake = 30.0f;
+                rgIn.packVoltage = 500.0f;
+                memcpy(rgIn.motorSpeed, tvIn.motorSpeed, sizeof(rgIn.motorSpeed));
+                rg_Process(&rgIn, &rgGains, &rgOut);
+                for (int i = 0; i < 4; i++)
+                {
+                    float share = (i < 2) ? HYD_FRONT : 1.0f - HYD_FRONT;
+                    torque[i] = rgOut.torque[i] - 0.5f * share * HYD_TORQUE * 0.3f / TV_GEAR_RATIO;
+                }
+                memset(tcIn.torque, 0, sizeof(tcIn.torque));
+                tc_Process(&tcIn, tcGains, &tcOut);
+            }
+            else
+            {
+                tvIn.driverTorque = 4.0f * TV_MAX_MOTOR_TORQUE;
+                tv_Process(&tvIn, &straight, &tvOut);
+                memcpy(tcIn.torque, tvOut.torque, sizeof(tcIn.torque));
+                tc_Process(&tcIn, tcGains, &tcOut);
+                memcpy(torque, (kind == 0) ? tcOut.torque : tvOut.torque, sizeof(torque));
+            }
+
+            if (k * DT > 0.1f)
+            {
+                float e = estOut.speed - m.vx;
+                res.rmsWheel += (wheel - m.vx) * (wheel - m.vx);
+                res.rmsTc += (tcOut.speed - m.vx) * (tcOut.speed - m.vx);
+                res.rmsEst += e * e;
+                if (fabsf(e) > res.maxEst) res.maxEst = fabsf(e);
+                samples++;
+            }
+        }
+        Step(&m, torque, 0.0f);
+    }
+    Mu = MU;
+    res.rmsWheel = sqrtf(res.rmsWheel / samples);
+    res.rmsTc = sqrtf(res.rmsTc / samples);
+    res.rmsEst = sqrtf(res.rmsEst / samples);
+    return res;
+}
+
+int main(int argc, char** argv)
+{
+    FILE* trace = NULL;
+    const tv_gains_t off = {0.4f, 0.0f, 0.0f};
+    const tv_gains_t on = {0.4f, 250.0f, 400.0f};   // params_t defaults (database.h)
+
+    for (int i = 0; i < 4; i++)
+    {
+        float axle = (i < 2) ? (TV_WHEELBASE - CG_TO_FRONT) : CG_TO_FRONT;
+        Fz[i] = MASS * G * axle / TV_WHEELBASE / 2.0f;
+    }
+    if (argc > 1)
+    {
+        size_t len = strlen(argv[1]);
+        if (len < 5 || strcmp(&argv[1][len - 4], ".csv") != 0)
+        {
+            fprintf(stderr, "usage: %s [trace.csv]\n", argv[0]);
+            return 1;
+        }
+        trace = fopen(argv[1], "w");
+        if (trace == NULL) { perror(argv[1]); return 1; }
+        fprintf(trace, "t,vx,r,r_ref,r_wheels,mz,t_fl,t_fr,t_rl,t_rr\n");
+    }
+
+    tv_Init(NULL);
+    tc_Init();
+    lc_Init();
+    rg_Init();
+    const float peak[4] = {TV_MAX_MOTOR_TORQUE, TV_MAX_MOTOR_TORQUE, TV_MAX_MOTOR_TORQUE, TV_MAX_MOTOR_TORQUE};
+    tv_result_t a = RunTv(&off, peak, NULL);
+    tv_result_t b = RunTv(&on, peak, trace);
+
+    printf("scenario tv: steering step %.2f at %.1f m/s\n", STEER_STEP, b.speed);
+    printf("%-6s %12s %12s %10s %16s\n", "tv", "yaw [rad/s]", "ref [rad/s]", "error", "alloc err [Nm]");
+    printf("%-6s %12.4f %12.4f %9.1f%% %16.4f\n", "off", a.yawRate, a.yawRateRef,
+           100.0f * (a.yawRate - a.yawRateRef) / a.yawRateRef, a.allocError);
+    printf("%-6s %12.4f %12.4f %9.1f%% %16.4f\n", "on", b.yawRate, b.yawRateRef,
+           100.0f * (b.yawRate - b.yawRateRef) / b.yawRateRef, b.allocError);
+
+    const tc_gains_t dry = {0.10f, 150.0f, 3000.0f, 0.0f, 15.0f};  // params_t defaults (database.h)
+    tc_gains_t wet = dry;
+    wet.accelLimit = 0.8f * MU_LOW * G;
+    const struct { const char* name; const tc_gains_t* gains; float mu; } runs[] = {
+        {"dry", &dry, MU}, {"wet", &wet, MU_LOW}
+    };
+
+    printf("\nscenario tc: full torque start, slip target %.2f\n", dry.slipTarget);
+    printf("%-12s %16s %10s %10s\n", "tc", "speed 3 s [m/s]", "peak slip", "mean slip");
+    for (int i = 0; i < 2; i++)
+    {
+        tc_result_t c = RunTc(runs[i].gains, 0, runs[i].mu, 0);
+        tc_result_t d = RunTc(runs[i].gains, 1, runs[i].mu, 0);
+        printf("%-4s %-7s %16.2f %10.3f %10.3f\n", runs[i].name, "off", c.speed, c.peakSlip, c.meanSlip);
+        printf("%-4s %-7s %16.2f %10.3f %10.3f\n", runs[i].name, "on", d.speed, d.peakSlip, d.meanSlip);
+    }
+
+    const lc_gains_t lcGains = {1.0f, 0.06f, 15.0f};  // params_t defaults (database.h)
+    lc_result_t e = RunLc(&dry, &lcGains, 0);
+    lc_result_t f = RunLc(&dry, &lcGains, 1);
+
+    printf("\nscenario lc: full gas start to %.1f m/s, slip target %.2f\n", lcGains.exitSpeed, lcGains.slipTarget);
+    printf("%-12s %16s %10s\n", "launch", "time [s]", "peak slip");
+    printf("%-12s %16.3f %10.3f\n", "tc only", e.time, e.peakSlip);
+    printf("%-12s %16.3f %10.3f\n", "lc + tc", f.time, f.peakSlip);
+
+    const rg_gains_t rgGains = {8.0f, 0.6f, 5.0f, 50.0f, 570.0f, 590.0f, 55.0f, 70.0f, 200.0f};  // params_t defaults
+    rg_result_t g = RunRg(&rgGains, 0, 500.0f);
+    rg_result_t h = RunRg(&rgGains, 1, 500.0f);
+    rg_result_t j = RunRg(&rgGains, 1, 585.0f);
+    rg_result_t k = RunRg(&rgGains, 1, 0.0f);
+
+    printf("\nscenario rg: 30%% brake pedal from 25 m/s\n");
+    printf("%-16s %14s %12s %16s\n", "regen", "distance [m]", "energy [kJ]", "torque step [Nm]");
+    printf("%-16s %14.1f %12.1f %16.1f\n", "off", g.distance, g.energy, g.torqueStep);
+    printf("%-16s %14.1f %12.1f %16.1f\n", "on 500 V", h.distance, h.energy, h.torqueStep);
+    printf("%-16s %14.1f %12.1f %16.1f\n", "on 585 V", j.distance, j.energy, j.torqueStep);
+    printf("%-16s %14.1f %12.1f %16.1f\n", "on, no voltage", k.distance, k.energy, k.torqueStep);
+
+    const pl_gains_t plGains = {80000.0f, 4000.0f};  // params_t defaults
+    pl_result_t n = RunPl(&dry, &plGains, 0);
+    pl_result_t o = RunPl(&dry, &plGains, 1);
+
+    printf("\nscenario pl: full gas, limit %.0f kW, model efficiency %.2f, limiter %.2f\n",
+           plGains.limit / 1000.0f, EFFICIENCY, PL_EFFICIENCY);
+    printf("%-16s %12s %12s %14s\n", "limiter", "peak [kW]", "over [s]", "mean 3-6 s [kW]");
+    printf("%-16s %12.1f %12.3f %14.1f\n", "off", n.peak / 1000.0f, n.over, n.mean / 1000.0f);
+    printf("%-16s %12.1f %12.3f %14.1f\n", "feed-forward", o.peak / 1000.0f, o.over, o.mean / 1000.0f);
+
+    const float derated[4] = {0.3f * TV_MAX_MOTOR_TORQUE, TV_MAX_MOTOR_TORQUE, TV_MAX_MOTOR_TORQUE, TV_MAX_MOTOR_TORQUE};
+    tv_result_t r = RunTv(&on, derated, NULL);
+    const th_gains_t thGains = {10.0f, 0.05f, 0.9f};  // params_t defaults
+    th_gains_t now = thGains;
+    now.horizon = 0.0f;
+    th_result_t u = RunTh(&now);
+    th_result_t v = RunTh(&thGains);
+
+    printf("\nscenario th: front left motor derated to 30%%, steering step at %.1f m/s\n", r.speed);
+    printf("%-16s %12s %12s %10s\n", "wheels", "yaw [rad/s]", "ref [rad/s]", "error");
+    printf("%-16s %12.4f %12.4f %9.1f%%\n", "healthy", b.yawRate, b.yawRateRef,
+           100.0f * (b.yawRate - b.yawRateRef) / b.yawRateRef);
+    printf("%-16s %12.4f %12.4f %9.1f%%\n", "fl derated", r.yawRate, r.yawRateRef,
+           100.0f * (r.yawRate - r.yawRateRef) / r.yawRateRef);
+    printf("scenario th: full torque heating, sensor lag %.0f s\n", TH_SENSOR_LAG);
+    printf("%-16s %16s %14s %10s\n", "prediction", "peak wind [degC]", "derating [s]", "factor");
+    printf("%-16s %16.1f %14.1f %10.2f\n", "off", u.peakWinding, u.derateTime, u.factor);
+    printf("%-16s %16.1f %14.1f %10.2f\n", "10 s", v.peakWinding, v.derateTime, v.factor);
+    th_powerup_t pu = RunThPowerUp(&thGains);
+    printf("power-up, stale and lost frames: lowest factor %.2f, %d calls with the warning\n",
+           pu.minFactor, pu.warnings);
+
+    const char* estNames[] = {"dry tc", "wet spin", "braking"};
+    printf("\nscenario est: speed reference error against the model [m/s]\n");
+    printf("%-16s %10s %10s %10s %10s %10s\n", "run", "mean wheel", "tc ref", "est", "est+imu", "max est");
+    for (int kind = 0; kind < 3; kind++)
+    {
+        est_result_t x = RunEst((kind == 1) ? &wet : &dry, kind, 0);
+        est_result_t y = RunEst((kind == 1) ? &wet : &dry, kind, 1);
+        printf("%-16s %10.3f %10.3f %10.3f %10.3f %10.3f\n", estNames[kind], x.rmsWheel, x.rmsTc, x.rmsEst,
+               y.rmsEst, x.maxEst);
+    }
+    tc_result_t z = RunTc(&wet, 1, MU_LOW, 0);
+    tc_result_t zz = RunTc(&wet, 1, MU_LOW, 1);
+    printf("%-16s %16s %10s %10s\n", "wet tc", "speed 3 s [m/s]", "peak slip", "mean slip");
+    printf("%-16s %16.2f %10.3f %10.3f\n", "wheel ref", z.speed, z.peakSlip, z.meanSlip);
+    printf("%-16s %16.2f %10.3f %10.3f\n", "est ref", zz.speed, zz.peakSlip, zz.meanSlip);
+    if (trace != NULL) fclose(trace);
+    return 0;
+}